@@ -1,4 +1,4 @@
-QT       += core gui multimedia multimediawidgets
+QT       += core gui multimedia multimediawidgets concurrent network
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
@@ -7,6 +7,19 @@ TARGET = miniMedia
 RC_ICONS = miniMedia.ico
 
 CONFIG += c++17
+
+# Optional streaming PNG/TIFF decode, for deep zoom and crops of images larger than memory.
+packagesExist(libpng) {
+    CONFIG += link_pkgconfig
+    PKGCONFIG += libpng
+    DEFINES += MINIMEDIA_HAVE_LIBPNG
+}
+packagesExist(libtiff-4) {
+    CONFIG += link_pkgconfig
+    PKGCONFIG += libtiff-4
+    DEFINES += MINIMEDIA_HAVE_LIBTIFF
+}
+
 # You can make your code fail to compile if it uses deprecated APIs.
 # In order to do so, uncomment the following line.
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
@@ -22,16 +35,93 @@ FORMS += \
     src/gui/mainwindow.ui
 
 HEADERS += \
+    src/common/fileheader.h \
     src/common/imagecropper.h \
+    src/common/simd.h \
+    src/common/singleinstance.h \
+    src/common/startuptimeline.h \
+    src/gui/fullscreensurface.h \
+    src/gui/imageinfooverlay.h \
+    src/gui/loadlatencyprobe.h \
+    src/gui/loopcontroller.h \
+    src/gui/loopmarkeroverlay.h \
     src/gui/mainwindow.h \
     src/gui/mediaplayer.h \
+    src/gui/seekscheduler.h \
+    src/gui/spectrumwidget.h \
+    src/gui/statsoverlay.h \
+    src/gui/statusrefresher.h \
+    src/gui/waveformwidget.h \
+    src/media/audiotap.h \
+    src/media/bandreader.h \
+    src/media/batchprocessor.h \
+    src/media/cropexporter.h \
+    src/media/exifreader.h \
+    src/media/imagedecoder.h \
+    src/media/imageprefetcher.h \
+    src/media/imageresampler.h \
+    src/media/keyframeindex.h \
+    src/media/keyframeindexer.h \
+    src/media/medialibrary.h \
+    src/media/mediainfo.h \
+    src/media/mediaprober.h \
+    src/media/mediasniffer.h \
+    src/media/playbackstats.h \
+    src/media/playlist.h \
+    src/media/spectrumanalyzer.h \
+    src/media/speedcontroller.h \
+    src/media/stretchrenderer.h \
+    src/media/thumbnailcache.h \
+    src/media/thumbnailgenerator.h \
+    src/media/tilepyramid.h \
+    src/media/timestretcher.h \
+    src/media/waveformbuilder.h \
+    src/media/waveformdata.h \
     src/theme/themehandler.h
 
 SOURCES += \
+    src/common/fileheader.cpp \
     src/common/imagecropper.cpp \
+    src/common/singleinstance.cpp \
+    src/common/startuptimeline.cpp \
+    src/gui/fullscreensurface.cpp \
+    src/gui/imageinfooverlay.cpp \
+    src/gui/loadlatencyprobe.cpp \
+    src/gui/loopcontroller.cpp \
+    src/gui/loopmarkeroverlay.cpp \
     src/gui/mainwindow.cpp \
     src/gui/mediaplayer.cpp \
+    src/gui/seekscheduler.cpp \
+    src/gui/spectrumwidget.cpp \
+    src/gui/statsoverlay.cpp \
+    src/gui/statusrefresher.cpp \
+    src/gui/waveformwidget.cpp \
     src/main.cpp \
+    src/media/audiotap.cpp \
+    src/media/bandreader.cpp \
+    src/media/batchprocessor.cpp \
+    src/media/cropexporter.cpp \
+    src/media/exifreader.cpp \
+    src/media/imagedecoder.cpp \
+    src/media/imageprefetcher.cpp \
+    src/media/imageresampler.cpp \
+    src/media/keyframeindex.cpp \
+    src/media/keyframeindexer.cpp \
+    src/media/medialibrary.cpp \
+    src/media/mediainfo.cpp \
+    src/media/mediaprober.cpp \
+    src/media/mediasniffer.cpp \
+    src/media/playbackstats.cpp \
+    src/media/playlist.cpp \
+    src/media/spectrumanalyzer.cpp \
+    src/media/speedcontroller.cpp \
+    src/media/stretchrenderer.cpp \
+    src/media/thumbnailcache.cpp \
+    src/media/thumbnailgenerator.cpp \
+    src/media/tilepyramid.cpp \
+    src/media/timestretcher.cpp \
+    src/media/waveformbuilder.cpp \
+    src/media/waveformdata.cpp \
     src/theme/themehandler.cpp
 
 RESOURCES += \
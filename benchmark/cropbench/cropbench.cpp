@@ -0,0 +1,213 @@
+#include "cropbench.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QImage>
+#include <QImageReader>
+#include <QImageWriter>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QProcess>
+#include <QRandomGenerator>
+#include <QTextStream>
+#include <QVector>
+
+#include <algorithm>
+#include <cmath>
+
+#include "src/media/cropexporter.h"
+
+#ifdef Q_OS_UNIX
+#include <sys/resource.h>
+#endif
+
+namespace {
+const char* const TEST_IMAGE_SUFFIXES[] = {"jpg", "png"};
+const quint32 CROP_SEED = 0x43524f50; // the same rectangles on every run
+}
+
+CropBench::CropBench(const CropBenchOptions &options)
+    : m_options(options)
+{
+}
+
+const char* CropBench::modeName(Mode mode)
+{
+    return mode == Mode_Export ? "export" : "full";
+}
+
+QStringList CropBench::imagePaths() const
+{
+    QStringList paths;
+    for (const char* suffix : TEST_IMAGE_SUFFIXES)
+        paths << QDir(m_options.imageDir).filePath(QStringLiteral("crop-%1mp.%2").arg(m_options.megapixels).arg(suffix));
+    return paths;
+}
+
+bool CropBench::generateImages() const
+{
+    if (!QDir().mkpath(m_options.imageDir)) {
+        qWarning() << Q_FUNC_INFO << "Cannot create" << m_options.imageDir;
+        return false;
+    }
+
+    // 4:3, like a camera sensor.
+    const qint64 pixels = qint64(m_options.megapixels) * 1000000;
+    const int width = int(std::sqrt(pixels * 4.0 / 3.0));
+    const int height = int(pixels / width);
+
+    QImage image(width, height, QImage::Format_RGB888);
+    if (image.isNull()) {
+        qWarning() << Q_FUNC_INFO << "Cannot allocate" << width << "x" << height;
+        return false;
+    }
+
+    // Gradients with seeded noise, so neither codec gets an unrealistically easy image.
+    QRandomGenerator random(CROP_SEED);
+    for (int y = 0; y < height; ++y) {
+        uchar* line = image.scanLine(y);
+        for (int x = 0; x < width; ++x) {
+            const int noise = int(random.bounded(32));
+            line[x * 3] = uchar((x * 255 / width + noise) & 0xff);
+            line[x * 3 + 1] = uchar((y * 255 / height + noise) & 0xff);
+            line[x * 3 + 2] = uchar(((x ^ y) + noise) & 0xff);
+        }
+    }
+
+    for (const QString& path : imagePaths()) {
+        if (QFileInfo::exists(path))
+            continue;
+        qInfo().noquote() << "Writing" << path << width << "x" << height;
+        QImageWriter writer(path);
+        if (!writer.write(image)) {
+            qWarning() << Q_FUNC_INFO << "Cannot write" << path << writer.errorString();
+            return false;
+        }
+    }
+    return true;
+}
+
+int CropBench::run() const
+{
+    QJsonArray results;
+    for (const QString& path : imagePaths()) {
+        for (Mode mode : {Mode_Export, Mode_FullDecode}) {
+            QJsonObject result = spawnChild(path, mode);
+            result["file"] = QFileInfo(path).fileName();
+            result["mode"] = modeName(mode);
+            qInfo().noquote() << result["file"].toString() << modeName(mode)
+                              << result["method"].toString() << "median" << result["medianMs"].toDouble()
+                              << "ms, peak" << result["peakRssKb"].toInteger() << "KB" << result["error"].toString();
+            results.append(result);
+        }
+    }
+
+    QJsonObject report;
+    report["qtVersion"] = QString(qVersion());
+    report["megapixels"] = m_options.megapixels;
+    report["crops"] = m_options.crops;
+    report["cropSize"] = m_options.cropSize;
+    report["results"] = results;
+
+    const QByteArray json = QJsonDocument(report).toJson(QJsonDocument::Indented);
+
+    if (m_options.outputPath.isEmpty()) {
+        QTextStream(stdout) << json;
+        return 0;
+    }
+
+    QFile file(m_options.outputPath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << Q_FUNC_INFO << "Cannot write" << m_options.outputPath;
+        return 1;
+    }
+    file.write(json);
+    return 0;
+}
+
+QJsonObject CropBench::spawnChild(const QString &imagePath, Mode mode) const
+{
+    QProcess child;
+    child.setProcessChannelMode(QProcess::ForwardedErrorChannel);
+    child.start(QCoreApplication::applicationFilePath(),
+                {"--child", "--image", imagePath, "--mode", modeName(mode),
+                 "--crops", QString::number(m_options.crops), "--crop-size", QString::number(m_options.cropSize)});
+
+    QJsonObject result;
+    if (!child.waitForFinished(mApp::CROPBENCH_CHILD_TIMEOUT_MS)) {
+        child.kill();
+        result["error"] = QStringLiteral("timeout");
+        return result;
+    }
+    const QJsonDocument document = QJsonDocument::fromJson(child.readAllStandardOutput());
+    if (child.exitCode() != 0 || !document.isObject()) {
+        result["error"] = QStringLiteral("child exited with %1").arg(child.exitCode());
+        return result;
+    }
+    return document.object();
+}
+
+int CropBench::runChild(const QString &imagePath, Mode mode) const
+{
+    const QSize size = QImageReader(imagePath).size();
+    if (!size.isValid() || size.width() <= m_options.cropSize || size.height() <= m_options.cropSize) {
+        qWarning() << Q_FUNC_INFO << "Unusable test image" << imagePath << size;
+        return 1;
+    }
+
+    QRandomGenerator random(CROP_SEED);
+    QVector<qint64> timesUs;
+    QString method;
+    for (int i = 0; i < m_options.crops; ++i) {
+        const QRect rect(int(random.bounded(size.width() - m_options.cropSize)),
+                         int(random.bounded(size.height() - m_options.cropSize)),
+                         m_options.cropSize, m_options.cropSize);
+
+        QElapsedTimer clock;
+        clock.start();
+        QImage crop;
+        if (mode == Mode_Export) {
+            const CropExporter::Result result = CropExporter::readRegion(imagePath, rect);
+            crop = result.image;
+            method = CropExporter::methodName(result.method);
+        } else {
+            QImageReader reader(imagePath);
+            reader.setAllocationLimit(0);
+            crop = reader.read().copy(rect);
+            method = QStringLiteral("full-decode");
+        }
+        timesUs.append(clock.nsecsElapsed() / 1000);
+
+        if (crop.size() != rect.size()) {
+            qWarning() << Q_FUNC_INFO << "Crop" << rect << "came back as" << crop.size();
+            return 1;
+        }
+    }
+
+    std::sort(timesUs.begin(), timesUs.end());
+    QJsonObject result;
+    result["method"] = method;
+    result["medianMs"] = timesUs.at(timesUs.size() / 2) / 1000.0;
+    result["maxMs"] = timesUs.last() / 1000.0;
+    result["peakRssKb"] = peakRssKb();
+    QTextStream(stdout) << QJsonDocument(result).toJson(QJsonDocument::Compact);
+    return 0;
+}
+
+qint64 CropBench::peakRssKb()
+{
+#ifdef Q_OS_UNIX
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#ifdef Q_OS_MACOS
+        return usage.ru_maxrss / 1024; // bytes on macOS
+#else
+        return usage.ru_maxrss;        // kilobytes on Linux
+#endif
+    }
+#endif
+    return -1;
+}
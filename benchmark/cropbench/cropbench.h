@@ -0,0 +1,59 @@
+#ifndef CROPBENCH_H
+#define CROPBENCH_H
+
+#include <QJsonObject>
+#include <QString>
+#include <QStringList>
+
+namespace mApp {
+const int CROPBENCH_DEFAULT_MEGAPIXELS = 100;
+const int CROPBENCH_DEFAULT_CROPS = 10;
+const int CROPBENCH_DEFAULT_CROP_SIZE = 2000;
+const int CROPBENCH_CHILD_TIMEOUT_MS = 600000;
+}
+
+struct CropBenchOptions
+{
+    QString imageDir;
+    QString outputPath;         // empty: print to stdout
+    int megapixels = mApp::CROPBENCH_DEFAULT_MEGAPIXELS;
+    int crops = mApp::CROPBENCH_DEFAULT_CROPS;
+    int cropSize = mApp::CROPBENCH_DEFAULT_CROP_SIZE;
+};
+
+/*
+ * Crops fixed-seed rectangles out of a very large JPEG and PNG, once through
+ * CropExporter and once by decoding the whole image and copying (what the
+ * cropper did before). Every image/mode pair runs in its own child process
+ * so the peak RSS reported for it is not inherited from the previous one.
+ */
+class CropBench
+{
+public:
+    enum Mode {
+        Mode_Export = 0,    // CropExporter::readRegion
+        Mode_FullDecode     // QImageReader::read() + QImage::copy()
+    };
+
+    explicit CropBench(const CropBenchOptions& options);
+
+    // Writes test images of the configured size; false on failure.
+    bool generateImages() const;
+
+    // Parent: spawns one child per image and mode and writes the JSON report.
+    int run() const;
+    // Child: measures a single image in a single mode, prints one JSON object.
+    int runChild(const QString& imagePath, Mode mode) const;
+
+    static const char* modeName(Mode mode);
+
+private:
+    QStringList imagePaths() const;
+    QJsonObject spawnChild(const QString& imagePath, Mode mode) const;
+
+    static qint64 peakRssKb();
+
+    CropBenchOptions m_options;
+};
+
+#endif // CROPBENCH_H
@@ -0,0 +1,45 @@
+# Region-decoded crop export versus decode-then-copy on very large images.
+# Build and run with:
+#   qmake cropbench.pro && make
+#   ./cropbench --generate --dir /tmp/mm-crop --output result.json
+
+QT       += core gui concurrent
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+# Optional streaming PNG/TIFF decode, for deep zoom and crops of images larger than memory.
+packagesExist(libpng) {
+    CONFIG += link_pkgconfig
+    PKGCONFIG += libpng
+    DEFINES += MINIMEDIA_HAVE_LIBPNG
+}
+packagesExist(libtiff-4) {
+    CONFIG += link_pkgconfig
+    PKGCONFIG += libtiff-4
+    DEFINES += MINIMEDIA_HAVE_LIBTIFF
+}
+
+TARGET = cropbench
+
+# Sources are shared with the application and included as "src/...".
+INCLUDEPATH += ../..
+
+HEADERS += \
+    ../../src/common/fileheader.h \
+    ../../src/media/bandreader.h \
+    ../../src/media/cropexporter.h \
+    ../../src/media/exifreader.h \
+    ../../src/media/imageresampler.h \
+    ../../src/media/tilepyramid.h \
+    cropbench.h
+
+SOURCES += \
+    ../../src/common/fileheader.cpp \
+    ../../src/media/bandreader.cpp \
+    ../../src/media/cropexporter.cpp \
+    ../../src/media/exifreader.cpp \
+    ../../src/media/imageresampler.cpp \
+    ../../src/media/tilepyramid.cpp \
+    cropbench.cpp \
+    main.cpp
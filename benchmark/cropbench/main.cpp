@@ -0,0 +1,50 @@
+#include <QCommandLineParser>
+#include <QCoreApplication>
+
+#include "cropbench.h"
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("cropbench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Crop export benchmark: region decode versus full decode on very large images.");
+    parser.addHelpOption();
+
+    const QCommandLineOption dirOption("dir", "Directory holding the test images.", "dir", "mm-crop-images");
+    const QCommandLineOption generateOption("generate", "Generate the test images first.");
+    const QCommandLineOption outputOption("output", "Write the JSON report to this file instead of stdout.", "file");
+    const QCommandLineOption megapixelsOption("megapixels", "Size of the generated images.", "mp", QString::number(mApp::CROPBENCH_DEFAULT_MEGAPIXELS));
+    const QCommandLineOption cropsOption("crops", "Crops per image and mode.", "count", QString::number(mApp::CROPBENCH_DEFAULT_CROPS));
+    const QCommandLineOption cropSizeOption("crop-size", "Edge of the square crops in source pixels.", "px", QString::number(mApp::CROPBENCH_DEFAULT_CROP_SIZE));
+    // Internal: one measurement per process.
+    QCommandLineOption childOption("child");
+    childOption.setFlags(QCommandLineOption::HiddenFromHelp);
+    QCommandLineOption imageOption("image", "", "file");
+    imageOption.setFlags(QCommandLineOption::HiddenFromHelp);
+    QCommandLineOption modeOption("mode", "", "mode");
+    modeOption.setFlags(QCommandLineOption::HiddenFromHelp);
+    parser.addOptions({dirOption, generateOption, outputOption, megapixelsOption, cropsOption, cropSizeOption,
+                       childOption, imageOption, modeOption});
+    parser.process(app);
+
+    CropBenchOptions options;
+    options.imageDir = parser.value(dirOption);
+    options.outputPath = parser.value(outputOption);
+    options.megapixels = parser.value(megapixelsOption).toInt();
+    options.crops = qMax(1, parser.value(cropsOption).toInt());
+    options.cropSize = parser.value(cropSizeOption).toInt();
+
+    CropBench bench(options);
+    if (parser.isSet(childOption)) {
+        const CropBench::Mode mode = parser.value(modeOption) == CropBench::modeName(CropBench::Mode_Export)
+                                         ? CropBench::Mode_Export : CropBench::Mode_FullDecode;
+        return bench.runChild(parser.value(imageOption), mode);
+    }
+
+    if (parser.isSet(generateOption) && !bench.generateImages())
+        return 1;
+
+    return bench.run();
+}
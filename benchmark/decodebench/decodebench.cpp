@@ -0,0 +1,305 @@
+#include "decodebench.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QGuiApplication>
+#include <QJsonDocument>
+#include <QMediaFormat>
+#include <QMediaMetaData>
+#include <QMediaPlayer>
+#include <QProcess>
+#include <QTextStream>
+#include <QTimer>
+#include <QUrl>
+#include <QVideoSink>
+
+#include <algorithm>
+
+#include "src/gui/seekscheduler.h"
+
+#ifdef Q_OS_UNIX
+#include <sys/resource.h>
+#endif
+
+namespace {
+struct CorpusClip {
+    const char* codec;      // ffmpeg encoder
+    const char* container;  // file suffix
+    int width;
+    int height;
+};
+
+const CorpusClip CORPUS_CLIPS[] = {
+    {"libx264", "mp4", 640, 360},
+    {"libx264", "mp4", 1280, 720},
+    {"libx264", "mp4", 1920, 1080},
+    {"libx264", "mkv", 1280, 720},
+    {"libvpx-vp9", "webm", 1280, 720},
+    {"mpeg4", "avi", 1280, 720},
+    {"mjpeg", "mkv", 640, 360},
+};
+
+const int CORPUS_CLIP_SECONDS = 10;
+const int CORPUS_FPS = 30;
+const int CORPUS_GOP = 60; // a keyframe every two seconds
+}
+
+DecodeBench::DecodeBench(const DecodeBenchOptions &options, QObject *parent)
+    : QObject(parent)
+    , m_options(options)
+    , m_player(new QMediaPlayer(this))
+    , m_sink(new QVideoSink(this))
+    , m_phaseTimer(new QTimer(this))
+    , m_clipTimeout(new QTimer(this))
+    , m_random(0x4d4d) // fixed seed: the same seek targets on every run
+{
+    m_player->setVideoSink(m_sink);
+    m_seekScheduler = new SeekScheduler(m_player, this);
+    m_seekScheduler->setVideoSink(m_sink);
+
+    m_phaseTimer->setSingleShot(true);
+    m_clipTimeout->setSingleShot(true);
+    m_clipTimeout->setInterval(mApp::BENCH_CLIP_TIMEOUT_MS);
+
+    connect(m_sink, &QVideoSink::videoFrameChanged, this, &DecodeBench::handleFrame);
+    connect(m_phaseTimer, &QTimer::timeout, this, &DecodeBench::finishPlayback);
+    connect(m_clipTimeout, &QTimer::timeout, this, [this]() {
+        finishClip(QStringLiteral("timeout"));
+    });
+
+    connect(m_player, &QMediaPlayer::mediaStatusChanged, this, [this](QMediaPlayer::MediaStatus status) {
+        if (status == QMediaPlayer::EndOfMedia && m_phase == Phase_Playing)
+            finishPlayback();
+        else if (status == QMediaPlayer::InvalidMedia)
+            finishClip(QStringLiteral("invalid media"));
+    });
+    connect(m_player, &QMediaPlayer::errorOccurred, this, [this](QMediaPlayer::Error, const QString& errorString) {
+        finishClip(errorString);
+    });
+
+    connect(m_seekScheduler, &SeekScheduler::seekCompleted, this, [this](qint64, qint64 latencyMs) {
+        if (m_phase != Phase_Seeking)
+            return;
+        m_seekLatencies << latencyMs;
+        issueNextSeek();
+    });
+}
+
+bool DecodeBench::generateCorpus(const QString &corpusDir)
+{
+    if (!QDir().mkpath(corpusDir)) {
+        qWarning() << Q_FUNC_INFO << "Cannot create corpus directory" << corpusDir;
+        return false;
+    }
+
+    for (const CorpusClip& clip : CORPUS_CLIPS) {
+        const QString name = QString("%1_%2x%3.%4").arg(clip.codec).arg(clip.width).arg(clip.height).arg(clip.container);
+        const QString path = QDir(corpusDir).filePath(name);
+        if (QFile::exists(path))
+            continue;
+
+        const QStringList arguments {
+            "-hide_banner", "-loglevel", "error", "-y",
+            "-f", "lavfi", "-i", QString("testsrc2=size=%1x%2:rate=%3").arg(clip.width).arg(clip.height).arg(CORPUS_FPS),
+            "-f", "lavfi", "-i", "sine=frequency=440:sample_rate=48000",
+            "-t", QString::number(CORPUS_CLIP_SECONDS),
+            "-c:v", clip.codec, "-g", QString::number(CORPUS_GOP), "-pix_fmt", "yuv420p",
+            "-c:a", QString(clip.container) == "webm" ? "libopus" : "aac",
+            path
+        };
+
+        QProcess ffmpeg;
+        ffmpeg.start("ffmpeg", arguments);
+        if (!ffmpeg.waitForStarted()) {
+            qWarning() << Q_FUNC_INFO << "ffmpeg not found, cannot generate the corpus";
+            return false;
+        }
+        ffmpeg.waitForFinished(-1);
+        if (ffmpeg.exitCode() != 0) {
+            // An encoder missing from this ffmpeg build only loses that clip.
+            qWarning() << Q_FUNC_INFO << "Skipping" << name << ffmpeg.readAllStandardError().trimmed();
+            QFile::remove(path);
+            continue;
+        }
+        qInfo() << Q_FUNC_INFO << "Generated" << name;
+    }
+    return true;
+}
+
+void DecodeBench::start()
+{
+    const QDir corpus(m_options.corpusDir);
+    const QFileInfoList files = corpus.entryInfoList(QDir::Files, QDir::Name);
+    for (const QFileInfo& file : files)
+        m_clips << file.absoluteFilePath();
+
+    if (m_clips.isEmpty()) {
+        qWarning() << Q_FUNC_INFO << "No clips in" << m_options.corpusDir;
+        emit finished(1);
+        return;
+    }
+
+    startNextClip();
+}
+
+void DecodeBench::startNextClip()
+{
+    if (++m_clipIndex >= m_clips.size()) {
+        writeReport();
+        emit finished(0);
+        return;
+    }
+
+    const QString clipPath = m_clips.at(m_clipIndex);
+    m_current = QJsonObject();
+    m_current["file"] = QFileInfo(clipPath).fileName();
+    m_ttffUs = -1;
+    m_frames = 0;
+    m_seekLatencies.clear();
+    m_seeksIssued = 0;
+
+    m_seekScheduler->reset();
+    m_phase = Phase_Playing;
+    m_clipTimeout->start();
+    m_clipClock.start();
+
+    m_player->setSource(QUrl::fromLocalFile(clipPath));
+    m_player->setPlaybackRate(m_options.rate);
+    m_player->play();
+}
+
+void DecodeBench::handleFrame()
+{
+    if (m_phase != Phase_Playing)
+        return;
+
+    if (m_ttffUs < 0) {
+        m_ttffUs = m_clipClock.nsecsElapsed() / 1000;
+        m_playClock.start();
+        m_phaseTimer->start(m_options.playMs);
+        return;
+    }
+    ++m_frames;
+}
+
+void DecodeBench::finishPlayback()
+{
+    if (m_phase != Phase_Playing)
+        return;
+
+    m_phaseTimer->stop();
+    const double seconds = m_playClock.isValid() ? m_playClock.nsecsElapsed() / 1e9 : 0.0;
+
+    m_current["ttffMs"] = m_ttffUs >= 0 ? m_ttffUs / 1000.0 : -1.0;
+    m_current["frames"] = m_frames;
+    m_current["decodeFps"] = seconds > 0.0 ? m_frames / seconds : 0.0;
+    m_current["durationMs"] = m_player->duration();
+
+    const QMediaMetaData metaData = m_player->metaData();
+    m_current["videoCodec"] = QMediaFormat::videoCodecName(metaData.value(QMediaMetaData::VideoCodec).value<QMediaFormat::VideoCodec>());
+    const QSize resolution = metaData.value(QMediaMetaData::Resolution).toSize();
+    m_current["width"] = resolution.width();
+    m_current["height"] = resolution.height();
+
+    // Seeks are measured paused, so every one of them has to produce a new frame.
+    m_player->pause();
+    m_phase = Phase_Seeking;
+    issueNextSeek();
+}
+
+void DecodeBench::issueNextSeek()
+{
+    const qint64 duration = m_player->duration();
+    if (m_seeksIssued >= m_options.seekCount || duration <= 0) {
+        finishClip();
+        return;
+    }
+
+    ++m_seeksIssued;
+    m_seekScheduler->requestSeek(m_random.bounded(duration));
+}
+
+void DecodeBench::finishClip(const QString &error)
+{
+    if (m_phase == Phase_Idle)
+        return;
+
+    m_phase = Phase_Idle;
+    m_phaseTimer->stop();
+    m_clipTimeout->stop();
+    m_player->stop();
+
+    // Seeks past the watchdog report -1; they count as timeouts, not as latency samples.
+    const int timeouts = int(m_seekLatencies.removeAll(-1));
+
+    m_current["seekCount"] = m_seekLatencies.size() + timeouts;
+    m_current["seekTimeouts"] = timeouts;
+    m_current["seekP50Ms"] = percentile(m_seekLatencies, 0.50);
+    m_current["seekP90Ms"] = percentile(m_seekLatencies, 0.90);
+    m_current["seekP99Ms"] = percentile(m_seekLatencies, 0.99);
+    if (!error.isEmpty())
+        m_current["error"] = error;
+
+    qInfo().noquote() << m_current["file"].toString()
+                      << "ttff" << m_current["ttffMs"].toDouble() << "ms,"
+                      << m_current["decodeFps"].toDouble() << "fps, seek p50"
+                      << m_current["seekP50Ms"].toDouble() << "ms" << error;
+
+    m_results.append(m_current);
+
+    // Leave the event loop first so the backend can tear the old source down.
+    QTimer::singleShot(0, this, &DecodeBench::startNextClip);
+}
+
+void DecodeBench::writeReport()
+{
+    QJsonObject report;
+    report["qtVersion"] = QString(qVersion());
+    report["platform"] = QGuiApplication::platformName();
+    report["playbackRate"] = m_options.rate;
+    report["playMs"] = m_options.playMs;
+    report["seeksPerClip"] = m_options.seekCount;
+    // getrusage keeps the high-water mark of the whole process, so it is only meaningful per run.
+    report["peakRssKb"] = peakRssKb();
+    report["clips"] = m_results;
+
+    const QByteArray json = QJsonDocument(report).toJson(QJsonDocument::Indented);
+
+    if (m_options.outputPath.isEmpty()) {
+        QTextStream(stdout) << json;
+        return;
+    }
+
+    QFile file(m_options.outputPath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << Q_FUNC_INFO << "Cannot write" << m_options.outputPath;
+        return;
+    }
+    file.write(json);
+}
+
+qint64 DecodeBench::peakRssKb()
+{
+#ifdef Q_OS_UNIX
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#ifdef Q_OS_MACOS
+        return usage.ru_maxrss / 1024; // bytes on macOS
+#else
+        return usage.ru_maxrss;        // kilobytes on Linux
+#endif
+    }
+#endif
+    return -1;
+}
+
+double DecodeBench::percentile(QVector<qint64> values, double fraction)
+{
+    if (values.isEmpty())
+        return -1.0;
+
+    std::sort(values.begin(), values.end());
+    const int index = qBound(0, int(fraction * (values.size() - 1) + 0.5), int(values.size()) - 1);
+    return double(values.at(index));
+}
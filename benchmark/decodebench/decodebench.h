@@ -0,0 +1,93 @@
+#ifndef DECODEBENCH_H
+#define DECODEBENCH_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QRandomGenerator>
+#include <QStringList>
+#include <QVector>
+
+class QMediaPlayer;
+class QTimer;
+class QVideoSink;
+class SeekScheduler;
+
+namespace mApp {
+const int BENCH_CLIP_TIMEOUT_MS = 60000;
+const int BENCH_DEFAULT_SEEKS = 30;
+const int BENCH_DEFAULT_PLAY_MS = 5000;
+const double BENCH_DEFAULT_RATE = 4.0;
+}
+
+struct DecodeBenchOptions
+{
+    QString corpusDir;
+    QString outputPath;         // empty: print to stdout
+    int seekCount = mApp::BENCH_DEFAULT_SEEKS;
+    int playMs = mApp::BENCH_DEFAULT_PLAY_MS;
+    double rate = mApp::BENCH_DEFAULT_RATE;
+};
+
+/*
+ * Drives a headless QMediaPlayer -> QVideoSink pipeline over every clip in
+ * the corpus. Per clip it measures time to first frame, presented frame
+ * rate while playing at an elevated rate, and exact-seek latency through
+ * the application's SeekScheduler. The report is written as JSON.
+ */
+class DecodeBench : public QObject
+{
+    Q_OBJECT
+public:
+    explicit DecodeBench(const DecodeBenchOptions& options, QObject* parent = nullptr);
+
+    // Renders the test corpus with the ffmpeg command line tool; false if it is missing.
+    static bool generateCorpus(const QString& corpusDir);
+
+    void start();
+
+signals:
+    void finished(int exitCode);
+
+private:
+    enum Phase {
+        Phase_Idle = 0,
+        Phase_Playing,
+        Phase_Seeking
+    };
+
+    void startNextClip();
+    void handleFrame();
+    void finishPlayback();
+    void issueNextSeek();
+    void finishClip(const QString& error = QString());
+    void writeReport();
+
+    static qint64 peakRssKb();
+    static double percentile(QVector<qint64> values, double fraction);
+
+    DecodeBenchOptions m_options;
+    QStringList m_clips;
+    int m_clipIndex = -1;
+
+    QMediaPlayer* m_player = nullptr;
+    QVideoSink* m_sink = nullptr;
+    SeekScheduler* m_seekScheduler = nullptr;
+    QTimer* m_phaseTimer = nullptr;
+    QTimer* m_clipTimeout = nullptr;
+    QRandomGenerator m_random;
+
+    Phase m_phase = Phase_Idle;
+    QElapsedTimer m_clipClock;
+    QElapsedTimer m_playClock;
+    qint64 m_ttffUs = -1;
+    int m_frames = 0;
+    QVector<qint64> m_seekLatencies;
+    int m_seeksIssued = 0;
+
+    QJsonObject m_current;
+    QJsonArray m_results;
+};
+
+#endif // DECODEBENCH_H
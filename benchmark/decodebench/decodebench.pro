@@ -0,0 +1,25 @@
+# Headless playback benchmark: QMediaPlayer -> QVideoSink over a clip corpus.
+# Build and run on a CPU-only box with:
+#   qmake decodebench.pro && make
+#   QT_QPA_PLATFORM=offscreen ./decodebench --generate --corpus /tmp/mm-corpus --output result.json
+
+QT       += core gui multimedia
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = decodebench
+
+# Sources are shared with the application and included as "src/...".
+INCLUDEPATH += ../..
+
+HEADERS += \
+    ../../src/gui/seekscheduler.h \
+    ../../src/media/keyframeindex.h \
+    decodebench.h
+
+SOURCES += \
+    ../../src/gui/seekscheduler.cpp \
+    ../../src/media/keyframeindex.cpp \
+    decodebench.cpp \
+    main.cpp
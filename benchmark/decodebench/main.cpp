@@ -0,0 +1,44 @@
+#include <QCommandLineParser>
+#include <QGuiApplication>
+#include <QTimer>
+
+#include "decodebench.h"
+
+int main(int argc, char *argv[])
+{
+    // No display on the benchmark machines.
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QGuiApplication app(argc, argv);
+    QGuiApplication::setApplicationName("decodebench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Headless decode/seek benchmark for the Mini-Media playback pipeline.");
+    parser.addHelpOption();
+
+    const QCommandLineOption corpusOption("corpus", "Directory holding the test clips.", "dir", "mm-bench-corpus");
+    const QCommandLineOption generateOption("generate", "Generate the clip corpus with ffmpeg first.");
+    const QCommandLineOption outputOption("output", "Write the JSON report to this file instead of stdout.", "file");
+    const QCommandLineOption seeksOption("seeks", "Exact seeks per clip.", "count", QString::number(mApp::BENCH_DEFAULT_SEEKS));
+    const QCommandLineOption playOption("play-ms", "Playback time measured per clip.", "ms", QString::number(mApp::BENCH_DEFAULT_PLAY_MS));
+    const QCommandLineOption rateOption("rate", "Playback rate while measuring frame rate.", "rate", QString::number(mApp::BENCH_DEFAULT_RATE));
+    parser.addOptions({corpusOption, generateOption, outputOption, seeksOption, playOption, rateOption});
+    parser.process(app);
+
+    DecodeBenchOptions options;
+    options.corpusDir = parser.value(corpusOption);
+    options.outputPath = parser.value(outputOption);
+    options.seekCount = parser.value(seeksOption).toInt();
+    options.playMs = parser.value(playOption).toInt();
+    options.rate = parser.value(rateOption).toDouble();
+
+    if (parser.isSet(generateOption) && !DecodeBench::generateCorpus(options.corpusDir))
+        return 1;
+
+    DecodeBench bench(options);
+    QObject::connect(&bench, &DecodeBench::finished, &app, &QCoreApplication::exit);
+    QTimer::singleShot(0, &bench, &DecodeBench::start);
+
+    return app.exec();
+}
@@ -0,0 +1,25 @@
+#include <QCommandLineParser>
+#include <QCoreApplication>
+
+#include "resamplebench.h"
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("resamplebench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Image resampling microbenchmark: ImageResampler versus QImage::scaled.");
+    parser.addHelpOption();
+
+    const QCommandLineOption outputOption("output", "Write the JSON report to this file instead of stdout.", "file");
+    const QCommandLineOption runsOption("runs", "Timed runs per measurement; the median is reported.", "count", QString::number(mApp::RESAMPLEBENCH_DEFAULT_RUNS));
+    parser.addOptions({outputOption, runsOption});
+    parser.process(app);
+
+    ResampleBenchOptions options;
+    options.outputPath = parser.value(outputOption);
+    options.runs = qMax(1, parser.value(runsOption).toInt());
+
+    return ResampleBench(options).run();
+}
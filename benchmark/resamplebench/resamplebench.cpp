@@ -0,0 +1,162 @@
+#include "resamplebench.h"
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QRandomGenerator>
+#include <QTextStream>
+#include <QThreadPool>
+#include <QVector>
+
+#include <algorithm>
+#include <cmath>
+
+#include "src/media/imageresampler.h"
+
+namespace {
+struct BenchCase {
+    const char* name;
+    QSize from;
+    QSize to;
+    bool alpha;
+};
+
+const BenchCase BENCH_CASES[] = {
+    {"photo-to-4k", {6000, 4000}, {3240, 2160}, false},
+    {"photo-to-1080p", {6000, 4000}, {1620, 1080}, false},
+    {"pyramid-halving", {8192, 256}, {4096, 128}, true},
+    {"capture-to-hidpi", {1920, 1080}, {2560, 1440}, false},
+    {"crop-preview", {400, 300}, {1200, 900}, true},
+};
+
+const ImageResampler::Filter BENCH_FILTERS[] = {
+    ImageResampler::Filter_Area,
+    ImageResampler::Filter_Bilinear,
+    ImageResampler::Filter_Lanczos3,
+};
+}
+
+ResampleBench::ResampleBench(const ResampleBenchOptions &options)
+    : m_options(options)
+{
+}
+
+template <typename Scale>
+double ResampleBench::medianMs(Scale scale) const
+{
+    scale(); // warm-up: page faults and pool threads
+    QVector<qint64> times;
+    for (int i = 0; i < m_options.runs; ++i) {
+        QElapsedTimer clock;
+        clock.start();
+        const QImage result = scale();
+        times.append(clock.nsecsElapsed());
+        Q_UNUSED(result);
+    }
+    std::sort(times.begin(), times.end());
+    return times.at(times.size() / 2) / 1e6;
+}
+
+QImage ResampleBench::testImage(const QSize &size, bool alpha)
+{
+    // Gradients with fixed-seed noise: smooth areas and edges both matter to the filters.
+    QImage image(size, alpha ? QImage::Format_ARGB32_Premultiplied : QImage::Format_RGB32);
+    QRandomGenerator random(0x5253);
+    for (int y = 0; y < size.height(); ++y) {
+        QRgb* line = reinterpret_cast<QRgb*>(image.scanLine(y));
+        for (int x = 0; x < size.width(); ++x) {
+            const int noise = int(random.bounded(48));
+            const int a = alpha ? (x * 255 / size.width()) : 255;
+            line[x] = qPremultiply(qRgba((x * 255 / size.width() + noise) & 0xff,
+                                         (y * 255 / size.height() + noise) & 0xff,
+                                         ((x / 16 + y / 16) % 2) * 200 + noise / 2, a));
+        }
+    }
+    return image;
+}
+
+double ResampleBench::psnr(const QImage &a, const QImage &b)
+{
+    const QImage left = a.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    const QImage right = b.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    if (left.size() != right.size())
+        return 0.0;
+
+    double squares = 0.0;
+    for (int y = 0; y < left.height(); ++y) {
+        const uchar* p = left.constScanLine(y);
+        const uchar* q = right.constScanLine(y);
+        for (int i = 0; i < left.width() * 4; ++i)
+            squares += double(p[i] - q[i]) * (p[i] - q[i]);
+    }
+    const double mse = squares / (double(left.width()) * left.height() * 4);
+    return mse > 0.0 ? 10.0 * std::log10(255.0 * 255.0 / mse) : 99.0;
+}
+
+int ResampleBench::run() const
+{
+    QJsonArray results;
+    for (const BenchCase& benchCase : BENCH_CASES) {
+        const QImage source = testImage(benchCase.from, benchCase.alpha);
+        const double megapixels = double(benchCase.to.width()) * benchCase.to.height() / 1e6;
+
+        const QImage reference = source.scaled(benchCase.to, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+        const double qtMs = medianMs([&]() {
+            return source.scaled(benchCase.to, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+        });
+
+        for (ImageResampler::Filter filter : BENCH_FILTERS) {
+            const double singleMs = medianMs([&]() {
+                return ImageResampler::scaled(source, benchCase.to, filter, false);
+            });
+            const double pooledMs = medianMs([&]() {
+                return ImageResampler::scaled(source, benchCase.to, filter, true);
+            });
+
+            QJsonObject result;
+            result["case"] = benchCase.name;
+            result["from"] = QStringLiteral("%1x%2").arg(benchCase.from.width()).arg(benchCase.from.height());
+            result["to"] = QStringLiteral("%1x%2").arg(benchCase.to.width()).arg(benchCase.to.height());
+            result["filter"] = ImageResampler::filterName(filter);
+            result["qtSmoothMs"] = qtMs;
+            result["singleThreadMs"] = singleMs;
+            result["pooledMs"] = pooledMs;
+            result["pooledMpixPerSec"] = megapixels / (pooledMs / 1000.0);
+            result["speedupVsQt"] = qtMs / pooledMs;
+            result["psnrVsQtDb"] = psnr(ImageResampler::scaled(source, benchCase.to, filter), reference);
+
+            qInfo().noquote() << benchCase.name << ImageResampler::filterName(filter)
+                              << "qt" << qtMs << "ms, single" << singleMs << "ms, pooled" << pooledMs << "ms";
+            results.append(result);
+        }
+    }
+
+    QJsonObject report;
+    report["qtVersion"] = QString(qVersion());
+    report["threads"] = QThreadPool::globalInstance()->maxThreadCount();
+#if defined(__AVX2__)
+    report["simd"] = QStringLiteral("avx2");
+#elif defined(__SSE2__) || defined(_M_X64)
+    report["simd"] = QStringLiteral("sse2");
+#else
+    report["simd"] = QStringLiteral("scalar");
+#endif
+    report["runs"] = m_options.runs;
+    report["results"] = results;
+
+    const QByteArray json = QJsonDocument(report).toJson(QJsonDocument::Indented);
+
+    if (m_options.outputPath.isEmpty()) {
+        QTextStream(stdout) << json;
+        return 0;
+    }
+
+    QFile file(m_options.outputPath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << Q_FUNC_INFO << "Cannot write" << m_options.outputPath;
+        return 1;
+    }
+    file.write(json);
+    return 0;
+}
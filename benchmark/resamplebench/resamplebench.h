@@ -0,0 +1,42 @@
+#ifndef RESAMPLEBENCH_H
+#define RESAMPLEBENCH_H
+
+#include <QImage>
+#include <QJsonObject>
+#include <QString>
+
+namespace mApp {
+const int RESAMPLEBENCH_DEFAULT_RUNS = 9;
+}
+
+struct ResampleBenchOptions
+{
+    QString outputPath;         // empty: print to stdout
+    int runs = mApp::RESAMPLEBENCH_DEFAULT_RUNS;
+};
+
+/*
+ * Times every ImageResampler filter, on one thread and on the pool,
+ * against QImage::scaled(SmoothTransformation) for the scalings the
+ * application does: photo to screen, pyramid halving, capture preview to
+ * a HiDPI widget and a crop blown up into its preview. Reports the median
+ * time, output megapixels per second and the PSNR against Qt's result.
+ */
+class ResampleBench
+{
+public:
+    explicit ResampleBench(const ResampleBenchOptions& options);
+
+    int run() const;
+
+private:
+    template <typename Scale>
+    double medianMs(Scale scale) const;
+
+    static QImage testImage(const QSize& size, bool alpha);
+    static double psnr(const QImage& a, const QImage& b);
+
+    ResampleBenchOptions m_options;
+};
+
+#endif // RESAMPLEBENCH_H
@@ -0,0 +1,23 @@
+# Microbenchmark: ImageResampler against QImage::scaled(SmoothTransformation).
+# Build and run with:
+#   qmake resamplebench.pro && make
+#   ./resamplebench --output result.json
+
+QT       += core gui concurrent
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = resamplebench
+
+# Sources are shared with the application and included as "src/...".
+INCLUDEPATH += ../..
+
+HEADERS += \
+    ../../src/media/imageresampler.h \
+    resamplebench.h
+
+SOURCES += \
+    ../../src/media/imageresampler.cpp \
+    resamplebench.cpp \
+    main.cpp
@@ -0,0 +1,29 @@
+#include "fileheader.h"
+
+FileHeader::FileHeader(const QString &filePath, qint64 maxBytes)
+    : m_file(filePath)
+{
+    if (!m_file.open(QIODevice::ReadOnly))
+        return;
+
+    const qint64 length = qMin(m_file.size(), maxBytes);
+    if (length <= 0)
+        return;
+
+    m_mapped = m_file.map(0, length);
+    if (m_mapped) {
+        m_data = m_mapped;
+        m_size = length;
+        return;
+    }
+
+    m_buffer = m_file.read(length);
+    m_data = reinterpret_cast<const uchar*>(m_buffer.constData());
+    m_size = m_buffer.size();
+}
+
+FileHeader::~FileHeader()
+{
+    if (m_mapped)
+        m_file.unmap(m_mapped);
+}
@@ -0,0 +1,34 @@
+#ifndef FILEHEADER_H
+#define FILEHEADER_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+
+/*
+ * The first bytes of a file, for parsers that only look at headers.
+ * The window is memory-mapped; files that cannot be mapped (e.g. pipes or
+ * some network file systems) are read into a buffer instead. Empty when
+ * the file cannot be opened or is empty.
+ */
+class FileHeader
+{
+public:
+    FileHeader(const QString& filePath, qint64 maxBytes);
+    ~FileHeader();
+
+    bool isEmpty() const { return m_size <= 0; }
+    const uchar* data() const { return m_data; }
+    qint64 size() const { return m_size; }
+
+private:
+    Q_DISABLE_COPY(FileHeader)
+
+    QFile m_file;
+    uchar* m_mapped = nullptr;
+    QByteArray m_buffer;
+    const uchar* m_data = nullptr;
+    qint64 m_size = 0;
+};
+
+#endif // FILEHEADER_H
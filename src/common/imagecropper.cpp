@@ -1,19 +1,211 @@
 #include "imagecropper.h"
+#include "src/media/cropexporter.h"
+#include "src/media/exifreader.h"
+#include "src/media/imageresampler.h"
+#include "src/media/tilepyramid.h"
 
 #include <QDebug>
 #include <QPainter>
+#include <QFutureWatcher>
+#include <QScreen>
+#include <QStyle>
+#include <QTimer>
+#include <QWheelEvent>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <cmath>
 #include <QVBoxLayout>
 #include <QPushButton>
 #include <QFile>
 #include <QFileDialog>
 #include <QMessageBox>
 
+namespace {
+// Part of a pixmap in logical coordinates; the device pixel ratio carries over.
+QPixmap copyLogical(const QPixmap& pixmap, const QRect& logical)
+{
+    const qreal dpr = pixmap.devicePixelRatio();
+    QPixmap part = pixmap.copy(QRectF(QPointF(logical.topLeft()) * dpr, QSizeF(logical.size()) * dpr).toAlignedRect());
+    part.setDevicePixelRatio(dpr);
+    return part;
+}
+}
 
 ImageCropper::ImageCropper(QWidget *parent)
     : QLabel(parent)
 {
     setMouseTracking(true);
     setBackgroundRole(QPalette::Highlight);
+
+    m_pyramid = new TilePyramid(this);
+    connect(m_pyramid, &TilePyramid::tilesAdded, this, [this]() {
+        if (isZoomed())
+            update();
+    });
+
+    m_previewTimer = new QTimer(this);
+    m_previewTimer->setSingleShot(true);
+    connect(m_previewTimer, &QTimer::timeout, this, [this]() {
+        if (isPressed)
+            showCroppedPreview(true);
+    });
+}
+
+void ImageCropper::setImageSource(const QString &filePath, const QSize &sourceSize, int orientation)
+{
+    resetZoom();
+    m_sourcePath = filePath;
+    m_sourceSize = filePath.isEmpty() ? QSize() : sourceSize;
+    m_orientation = orientation;
+    if (m_pyramid)
+        m_pyramid->open(filePath, ExifReader::isTransposed(orientation) ? m_sourceSize.transposed() : m_sourceSize);
+}
+
+void ImageCropper::resetZoom()
+{
+    m_zoom = 0;
+    m_panning = false;
+    unsetCursor();
+    update();
+}
+
+void ImageCropper::setCropSource(const QString &filePath, const QRect &sourceRect, const QString &tileDirectory,
+                                 int orientation)
+{
+    m_cropSourcePath = filePath;
+    m_cropSourceRect = sourceRect;
+    m_cropTileDirectory = tileDirectory;
+    m_cropOrientation = orientation;
+}
+
+QRect ImageCropper::pixmapRect() const
+{
+    // Where QLabel draws the pixmap.
+    return QStyle::alignedRect(layoutDirection(), alignment(), pixmap().deviceIndependentSize().toSize(), contentsRect());
+}
+
+QRect ImageCropper::sourceRectFor(const QRect &widgetRect) const
+{
+    const QRect shown = pixmapRect();
+    const QRect onPixmap = widgetRect.normalized().intersected(shown).translated(-shown.topLeft());
+    if (onPixmap.isEmpty() || !m_sourceSize.isValid())
+        return QRect();
+
+    const qreal scaleX = qreal(m_sourceSize.width()) / shown.width();
+    const qreal scaleY = qreal(m_sourceSize.height()) / shown.height();
+    const QRectF source(onPixmap.x() * scaleX, onPixmap.y() * scaleY,
+                        onPixmap.width() * scaleX, onPixmap.height() * scaleY);
+    return source.toAlignedRect().intersected(QRect(QPoint(0, 0), m_sourceSize));
+}
+
+double ImageCropper::fitZoom() const
+{
+    const QPixmap shown = pixmap();
+    if (shown.isNull() || !m_sourceSize.isValid())
+        return 1.0;
+    return shown.deviceIndependentSize().width() / m_sourceSize.width();
+}
+
+void ImageCropper::clampCenter()
+{
+    // Centered while the zoomed image is smaller than the widget, otherwise no empty border.
+    const QSizeF half = QSizeF(size()) / (2 * m_zoom);
+    const qreal maxX = m_sourceSize.width() - half.width();
+    const qreal maxY = m_sourceSize.height() - half.height();
+    m_center.setX(half.width() < maxX ? qBound(half.width(), m_center.x(), maxX) : m_sourceSize.width() / 2.0);
+    m_center.setY(half.height() < maxY ? qBound(half.height(), m_center.y(), maxY) : m_sourceSize.height() / 2.0);
+}
+
+void ImageCropper::paintZoomed(QPainter &painter)
+{
+    const int tileSize = mApp::PYRAMID_TILE_SIZE;
+    const QPointF origin = QPointF(rect().center()) - m_center * m_zoom;   // widget position of source (0, 0)
+    const QRectF imageRect(origin, QSizeF(m_sourceSize) * m_zoom);
+    const QRectF visible = imageRect.intersected(QRectF(rect()));
+    if (visible.isEmpty())
+        return;
+
+    // Base layer: the fitted image stretched, so loading tiles never leave holes.
+    const QPixmap shown = pixmap();
+    if (!shown.isNull()) {
+        const qreal toShown = shown.width() / imageRect.width();
+        const QRectF shownSource((visible.topLeft() - origin) * toShown, visible.size() * toShown);
+        painter.drawPixmap(visible, shown, shownSource);
+    }
+
+    if (!m_pyramid || !m_pyramid->isOpen())
+        return;
+
+    // Coarsest level that still has at least one source pixel per device pixel.
+    const qreal devicePixelsPerSource = m_zoom * devicePixelRatioF();
+    const int level = qBound(0, int(std::floor(std::log2(1.0 / devicePixelsPerSource))), m_pyramid->levelCount() - 1);
+    const int levelScale = 1 << level;   // stored pixels per level pixel
+
+    // Tiles are laid out in stored pixels and turned upright by the painter.
+    const QTransform storedToWidget = ExifReader::transform(m_orientation, m_pyramid->sourceSize())
+                                      * QTransform::fromScale(m_zoom, m_zoom)
+                                      * QTransform::fromTranslate(origin.x(), origin.y());
+    const QRectF storedVisible = storedToWidget.inverted().mapRect(visible);
+    const QRectF levelVisible(storedVisible.topLeft() / levelScale, storedVisible.size() / levelScale);
+    const int firstColumn = qMax(0, int(levelVisible.left()) / tileSize);
+    const int lastColumn = qMin(m_pyramid->tileColumns(level) - 1, int(levelVisible.right()) / tileSize);
+    const int firstRow = qMax(0, int(levelVisible.top()) / tileSize);
+    const int lastRow = qMin(m_pyramid->tileRows(level) - 1, int(levelVisible.bottom()) / tileSize);
+    const QSize levelSize = m_pyramid->levelSize(level);
+
+    painter.save();
+    painter.setTransform(storedToWidget, true);
+    painter.setRenderHint(QPainter::SmoothPixmapTransform, true);
+
+    int loads = 0;
+    bool deferred = false;
+    for (int row = firstRow; row <= lastRow; ++row) {
+        for (int column = firstColumn; column <= lastColumn; ++column) {
+            const QSizeF tileExtent(qMin(tileSize, levelSize.width() - column * tileSize),
+                                    qMin(tileSize, levelSize.height() - row * tileSize));
+            const QRectF target(QPointF(column * tileSize, row * tileSize) * levelScale, tileExtent * levelScale);
+
+            // Disk loads are capped per frame; the rest come with the next frames.
+            const bool cached = m_pyramid->isTileCached(level, column, row);
+            if (m_pyramid->isTileReady(level, column, row) && (cached || loads < mApp::IMAGE_TILE_LOADS_PER_FRAME)) {
+                loads += cached ? 0 : 1;
+                const QPixmap tile = m_pyramid->tile(level, column, row);
+                if (!tile.isNull()) {
+                    painter.drawPixmap(target, tile, QRectF(tile.rect()));
+                    continue;
+                }
+            } else if (m_pyramid->isTileReady(level, column, row)) {
+                deferred = true;
+            }
+            drawCoarserTile(painter, level, column, row, target);
+        }
+    }
+    painter.restore();
+
+    if (deferred)
+        QTimer::singleShot(0, this, qOverload<>(&QWidget::update));
+}
+
+bool ImageCropper::drawCoarserTile(QPainter &painter, int level, int column, int row, const QRectF &target)
+{
+    // Part of an already loaded coarser tile that covers this one.
+    const int tileSize = mApp::PYRAMID_TILE_SIZE;
+    for (int coarser = level + 1; coarser < m_pyramid->levelCount(); ++coarser) {
+        const int shift = coarser - level;
+        const int coarseColumn = column >> shift;
+        const int coarseRow = row >> shift;
+        if (!m_pyramid->isTileCached(coarser, coarseColumn, coarseRow))
+            continue;
+
+        const QPixmap tile = m_pyramid->tile(coarser, coarseColumn, coarseRow);
+        const qreal scale = 1.0 / (1 << shift);
+        const QRectF source(QPointF(column * tileSize * scale - coarseColumn * tileSize,
+                                    row * tileSize * scale - coarseRow * tileSize),
+                            target.size() / (1 << coarser));
+        painter.drawPixmap(target, tile, source.intersected(QRectF(tile.rect())));
+        return true;
+    }
+    return false;
 }
 
 
@@ -32,14 +224,14 @@ ImageCropper::ImageCropper(ImageCropper *parentLabelParam, QRect showRectParam)
     }
 
     // Validate and crop the rectangle
-    QRect validRect = showRectParam.intersected(parentPixmap.rect());
+    QRect validRect = showRectParam.intersected(QRect(QPoint(0, 0), parentPixmap.deviceIndependentSize().toSize()));
     if (!validRect.isValid()) {
         qDebug() << "Invalid crop rectangle. No pixmap set.";
         return;
     }
 
     // Crop and set the pixmap
-    QPixmap croppedPixmap = parentPixmap.copy(validRect);  // Crop the pixmap
+    QPixmap croppedPixmap = copyLogical(parentPixmap, validRect);  // Crop the pixmap
     setPixmap(croppedPixmap);  // Set the cropped pixmap
 
     // Create the layout for preview image and buttons
@@ -81,7 +273,25 @@ void ImageCropper::onCloseButtonClicked() {
 // Slot for Save Button
 void ImageCropper::onSaveButtonClicked() {
     QString savePath = QFileDialog::getSaveFileName(this, "Save Cropped Image", "", "Images (*.png *.jpg *.bmp)");
-    if (!savePath.isEmpty()) {
+    if (!savePath.isEmpty() && !m_cropSourcePath.isEmpty() && m_cropSourceRect.isValid()) {
+        // Full resolution, read from the original file off the GUI thread.
+        auto* watcher = new QFutureWatcher<CropExporter::Result>(this);
+        connect(watcher, &QFutureWatcher<CropExporter::Result>::finished, this, [this, watcher]() {
+            const CropExporter::Result result = watcher->result();
+            watcher->deleteLater();
+            if (!result.error.isEmpty()) {
+                qWarning() << Q_FUNC_INFO << "Crop export failed:" << result.error;
+                QMessageBox::warning(this, "Save", "Failed to save the cropped image.");
+                return;
+            }
+            qInfo() << Q_FUNC_INFO << "Cropped" << m_cropSourceRect << "of" << m_cropSourcePath
+                    << "by" << CropExporter::methodName(result.method) << "- read" << result.decodeUs / 1000
+                    << "ms, encode" << result.encodeUs / 1000 << "ms, peak" << result.peakBytes / 1024 << "KB";
+            QMessageBox::information(this, "Save", "Cropped image saved successfully!");
+        });
+        watcher->setFuture(QtConcurrent::run(&CropExporter::exportRegion, m_cropSourcePath, m_cropSourceRect,
+                                             m_cropTileDirectory, savePath, m_cropOrientation));
+    } else if (!savePath.isEmpty()) {
         if (pixmap().save(savePath)) {
             QMessageBox::information(this, "Save", "Cropped image saved successfully!");
         } else {
@@ -90,9 +300,8 @@ void ImageCropper::onSaveButtonClicked() {
     }
 }
 
-void ImageCropper::paintRectangle()
+void ImageCropper::paintRectangle(QPainter &painter)
 {
-    QPainter painter(this);
     painter.setRenderHint(QPainter::Antialiasing);  // Optional: enables antialiasing for smooth lines
 
     // Set a very light fill color with some transparency (alpha = 0.1)
@@ -102,30 +311,73 @@ void ImageCropper::paintRectangle()
     QPen pen;
     pen.setColor(QColor(0, 0, 177, 100));  // Slightly darker blue with more opacity
     pen.setStyle(Qt::DashDotLine);  // Use dotted (dash-dot) line style
-    pen.setWidth(2);  // Set a thicker border
+    pen.setWidth(mApp::IMAGE_SELECTION_PEN_WIDTH);  // Set a thicker border
     painter.setPen(pen);
 
     painter.drawRect(m_RectSelected);
 }
-void ImageCropper::showCroppedPreview()
+QRect ImageCropper::selectionBounds(const QRect &selection)
 {
+    // Everything paintRectangle touches, including the antialiased border.
+    const int margin = mApp::IMAGE_SELECTION_PEN_WIDTH;
+    return selection.isValid() ? selection.adjusted(-margin, -margin, margin, margin) : QRect();
+}
+void ImageCropper::updateBacking()
+{
+    const QPixmap shown = pixmap();
+    const qreal dpr = devicePixelRatioF();
+    if (shown.cacheKey() == m_backingKey && m_backing.deviceIndependentSize() == QSizeF(size())
+        && qFuzzyCompare(m_backing.devicePixelRatio(), dpr))
+        return;
+
+    // Same output as QLabel, rendered once per pixmap, size and screen.
+    m_backing = QPixmap((QSizeF(size()) * dpr).toSize());
+    m_backing.setDevicePixelRatio(dpr);
+    m_backing.fill(Qt::transparent);
+    QPainter painter(&m_backing);
+    style()->drawItemPixmap(&painter, contentsRect(), alignment(), shown);
+    m_backingKey = shown.cacheKey();
+}
+void ImageCropper::showCroppedPreview(bool live)
+{
+    // Selection in pixmap coordinates; the pixmap is centered in the label.
+    const QRect shown = pixmapRect();
+    const QRect onPixmap = m_RectSelected.intersected(shown).translated(-shown.topLeft());
+    if (onPixmap.isEmpty())
+        return;
+
     if (!m_previewLabel) {
-        m_previewLabel = new ImageCropper(this, m_RectSelected);
+        m_previewLabel = new ImageCropper(this, onPixmap);
         m_previewLabel->setWindowFlags(Qt::ToolTip);  // Makes it appear as a floating widget
         m_previewLabel->setAttribute(Qt::WA_DeleteOnClose, false);  // Keep it persistent
     }
 
-    auto parentPixmap = pixmap();
-    if (!parentPixmap.isNull()) {
-        QRect validRect = m_RectSelected.intersected(parentPixmap.rect());
-        if (validRect.isValid()) {
-            QPixmap croppedPixmap = parentPixmap.copy(validRect);
-            m_previewLabel->setPixmap(croppedPixmap.scaled(m_previewLabel->size(), Qt::KeepAspectRatio, Qt::SmoothTransformation));
-        }
+    if (!live) {
+        const QRect sourceRect = sourceRectFor(m_RectSelected);
+        const bool tilesReady = m_pyramid && m_pyramid->isOpen()
+                                && m_pyramid->isRegionReady(ExifReader::storedRect(sourceRect, m_orientation,
+                                                                                   m_pyramid->sourceSize()));
+        m_previewLabel->setCropSource(m_sourcePath, sourceRect, tilesReady ? m_pyramid->directory() : QString(),
+                                      m_orientation);
+    }
+
+    // Geometry first, the pixmap is fitted to it. The preview is a window, so global coordinates.
+    m_previewLabel->setGeometry(QRect(mapToGlobal(m_RectSelected.topRight()), m_RectSelected.size()));
+
+    // The fitted pixmap is at display size already, so the crop rarely needs scaling;
+    // when the preview's buttons make it larger, scale fast while dragging and resample once on release.
+    const QPixmap croppedPixmap = copyLogical(pixmap(), onPixmap);
+    const qreal dpr = m_previewLabel->devicePixelRatioF();
+    const QSize fitted = croppedPixmap.deviceIndependentSize().toSize().scaled(m_previewLabel->size(), Qt::KeepAspectRatio);
+    if (fitted == croppedPixmap.deviceIndependentSize().toSize()) {
+        m_previewLabel->setPixmap(croppedPixmap);
+    } else if (live) {
+        QPixmap stretched = croppedPixmap.scaled(fitted * dpr, Qt::KeepAspectRatio, Qt::FastTransformation);
+        stretched.setDevicePixelRatio(dpr);
+        m_previewLabel->setPixmap(stretched);
+    } else {
+        m_previewLabel->setPixmap(QPixmap::fromImage(ImageResampler::fitted(croppedPixmap.toImage(), fitted, dpr)));
     }
-    // Update the preview label's geometry and show it
-    m_previewLabel->setGeometry(m_RectSelected.topRight().x(), m_RectSelected.topRight().y(),
-                                m_RectSelected.width(), m_RectSelected.height());
 
     m_previewLabel->show();
 }
@@ -134,57 +386,139 @@ void ImageCropper::showCroppedPreview()
 
 void ImageCropper::mousePressEvent(QMouseEvent *ev)
 {
+    if (isZoomed()) {
+        m_panning = true;
+        m_panLast = ev->pos();
+        setCursor(Qt::ClosedHandCursor);
+        return;
+    }
+
     isPressed = true;
-    m_PosStart = ev->pos();
+    m_PosStart = m_PosEnd = ev->pos();
+    m_RectSelected = QRect();
+
+    // One live preview update per display refresh, however fast the mouse reports.
+    const qreal refreshRate = screen() ? screen()->refreshRate() : 0;
+    if (m_previewTimer)
+        m_previewTimer->setInterval(refreshRate > 0 ? qRound(1000 / refreshRate) : 16);
 }
 void ImageCropper::mouseReleaseEvent(QMouseEvent *ev)
 {
+    if (m_panning) {
+        m_panning = false;
+        setCursor(Qt::OpenHandCursor);
+        return;
+    }
+
     if(!isPressed) {
         qDebug() << "Was not pressed";
         return;
     }
 
+    const QRect previous = m_RectSelected;
     m_PosEnd = ev->pos();
+    m_RectSelected = QRect(m_PosStart, m_PosEnd).normalized();
 
-    m_RectSelected = QRect(m_PosStart, m_PosEnd);
-
-    showCroppedPreview();
+    if (m_previewTimer)
+        m_previewTimer->stop();
+    showCroppedPreview(false);
 
     isPressed = false;
+    update(QRegion(selectionBounds(previous)).united(selectionBounds(m_RectSelected)));
     m_PosStart = m_PosEnd = QPoint();
     m_RectSelected = QRect();
 }
 void ImageCropper::mouseMoveEvent(QMouseEvent* event)
 {
+    if (m_panning) {
+        m_center -= QPointF(event->pos() - m_panLast) / m_zoom;
+        m_panLast = event->pos();
+        clampCenter();
+        update();
+        return;
+    }
+
     if (isPressed) {
         // Check if left mouse button is pressed
+        const QRect previous = m_RectSelected;
         m_PosEnd = event->pos();
-        m_RectSelected = QRect(m_PosStart, m_PosEnd);
-        update();
+        m_RectSelected = QRect(m_PosStart, m_PosEnd).normalized();
+
+        // Only the old and the new overlay change; the rest of the image stays on screen.
+        update(QRegion(selectionBounds(previous)).united(selectionBounds(m_RectSelected)));
+        if (m_previewTimer && !m_previewTimer->isActive())
+            m_previewTimer->start();
     } else {
         // Left mouse button is not pressed, do nothing
     }
 }
 void ImageCropper::wheelEvent(QWheelEvent *event)
 {
-    Q_UNUSED(event)
+    if (!m_pyramid || !m_pyramid->isOpen() || pixmap().isNull()) {
+        QLabel::wheelEvent(event);
+        return;
+    }
+
+    const double fit = fitZoom();
+    const double current = isZoomed() ? m_zoom : fit;
+    const QPointF center = isZoomed() ? m_center : QPointF(m_sourceSize.width() / 2.0, m_sourceSize.height() / 2.0);
+
+    // 120 units per notch; touchpads send smaller steps and zoom continuously.
+    const double factor = std::pow(mApp::IMAGE_ZOOM_STEP, event->angleDelta().y() / 120.0);
+    const double zoom = qBound(fit, current * factor, double(mApp::IMAGE_ZOOM_SCALE_FACTOR));
+    event->accept();
+
+    if (zoom <= fit) {
+        resetZoom();
+        return;
+    }
+
+    // Keep the source point under the cursor where it is.
+    const QPointF fromCenter = event->position() - QPointF(rect().center());
+    const QPointF anchor = center + fromCenter / current;
+    m_center = anchor - fromCenter / zoom;
+    m_zoom = zoom;
+    clampCenter();
+
+    if (!m_panning)
+        setCursor(Qt::OpenHandCursor);
+    m_pyramid->build();
+    update();
+}
+void ImageCropper::mouseDoubleClickEvent(QMouseEvent *event)
+{
+    if (isZoomed())
+        resetZoom();
+    else
+        QLabel::mouseDoubleClickEvent(event);
+}
+void ImageCropper::resizeEvent(QResizeEvent *event)
+{
+    QLabel::resizeEvent(event);
+    if (isZoomed())
+        clampCenter();
 }
 void ImageCropper::paintEvent(QPaintEvent *event)
 {
-    QLabel::paintEvent(event);
-
-    m_RectSelected = QRect(m_PosStart, m_PosEnd);
+    if (isZoomed()) {
+        QPainter painter(this);
+        paintZoomed(painter);
+        return;
+    }
 
-    if(!m_RectSelected.isValid()) {
-        qDebug() << "Rect is too small";
+    if (pixmap().isNull()) {
+        QLabel::paintEvent(event);
         return;
     }
 
-    paintRectangle();
-    // showCroppedPreview();
+    // Painting is clipped to the exposed region, so a selection drag blits just its strip.
+    updateBacking();
+    QPainter painter(this);
+    drawFrame(&painter);
+    painter.drawPixmap(0, 0, m_backing);
 
-    // Optional: Additional debug output
-    qDebug() << Q_FUNC_INFO << "Returning from paintEvent";
+    if (isPressed && m_RectSelected.isValid())
+        paintRectangle(painter);
 }
 
 
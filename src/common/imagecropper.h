@@ -5,15 +5,31 @@
 #include <QMouseEvent>
 #include <QLabel>
 #include <QPoint>
+#include <QPointF>
 #include <QRect>
 #include <QPaintEvent>
 
 #define IMAGE_ZOOM_FACTOR
 
 namespace mApp {
-const int IMAGE_ZOOM_SCALE_FACTOR = 1;
+const int IMAGE_ZOOM_SCALE_FACTOR = 8;   // deepest zoom: screen pixels per source pixel
+const double IMAGE_ZOOM_STEP = 1.25;     // per wheel notch
+const int IMAGE_TILE_LOADS_PER_FRAME = 4;
+const int IMAGE_SELECTION_PEN_WIDTH = 2;
 }
 
+class QPainter;
+class QTimer;
+class TilePyramid;
+
+/*
+ * Image surface of the player. Fitted to the widget it is a plain label
+ * with a rubber-band crop selection. Wheel zoom goes past the fitted
+ * image into a tiled pyramid of the source (built on first zoom); while
+ * zoomed, dragging pans and a double-click returns to the fitted view.
+ * Source coordinates are upright; the pyramid keeps the file's stored
+ * orientation and its tiles are turned while drawn.
+ */
 class ImageCropper : public QLabel
 {
     Q_OBJECT
@@ -21,6 +37,16 @@ public:
     explicit ImageCropper(QWidget *parent = nullptr);
     explicit ImageCropper(ImageCropper* image, QRect);
 
+    // Source file behind the shown pixmap; an empty path disables zooming.
+    // sourceSize is upright, after the EXIF orientation.
+    void setImageSource(const QString& filePath, const QSize& sourceSize, int orientation = 1);
+    void resetZoom();
+    bool isZoomed() const { return m_zoom > 0; }
+
+    // Crop previews save this source rectangle at full resolution instead of their pixmap.
+    void setCropSource(const QString& filePath, const QRect& sourceRect, const QString& tileDirectory,
+                       int orientation);
+
 signals:
 protected:
     void mousePressEvent(QMouseEvent *ev);
@@ -28,18 +54,48 @@ protected:
     void mouseMoveEvent(QMouseEvent* ev);
     void paintEvent(QPaintEvent *event);
     void wheelEvent(QWheelEvent *event) override;
+    void mouseDoubleClickEvent(QMouseEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
 
 private:
+    double fitZoom() const;
+    QRect pixmapRect() const;
+    QRect sourceRectFor(const QRect& widgetRect) const;
+    void clampCenter();
+    void paintZoomed(QPainter& painter);
+    bool drawCoarserTile(QPainter& painter, int level, int column, int row, const QRectF& target);
     void printPos();
     void onCloseButtonClicked();
     void onSaveButtonClicked();
-    void paintRectangle();
-    void showCroppedPreview();
+    void paintRectangle(QPainter& painter);
+    static QRect selectionBounds(const QRect& selection);
+    void updateBacking();
+    // live: while dragging, cheap scaling and no source lookup.
+    void showCroppedPreview(bool live);
 
     bool isPressed = false;
     QPoint m_PosStart, m_PosEnd;
     QRect m_RectSelected;
     ImageCropper *m_previewLabel = nullptr;  // Preview label for the cropped region
+    QTimer* m_previewTimer = nullptr;         // paces live preview updates to the display
+
+    // The fitted view as drawn by QLabel, in device pixels; selection repaints only blit from it.
+    QPixmap m_backing;
+    qint64 m_backingKey = 0;
+
+    TilePyramid* m_pyramid = nullptr;
+    QString m_sourcePath;
+    QSize m_sourceSize;
+    int m_orientation = 1;
+    double m_zoom = 0;          // widget pixels per source pixel; 0 while fitted
+    QPointF m_center;           // source point at the widget center while zoomed
+    bool m_panning = false;
+    QPoint m_panLast;
+
+    QString m_cropSourcePath;
+    QRect m_cropSourceRect;
+    QString m_cropTileDirectory;
+    int m_cropOrientation = 1;
 };
 
 #endif // IMAGECROPPER_H
@@ -0,0 +1,16 @@
+#ifndef SIMD_H
+#define SIMD_H
+
+// Compile-time SIMD selection shared by the DSP and image kernels.
+// MSVC does not define __SSE2__, but SSE2 is always there on x64.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MINIMEDIA_HAVE_SSE2
+#endif
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define MINIMEDIA_HAVE_AVX2
+#endif
+
+#endif // SIMD_H
@@ -0,0 +1,83 @@
+#include "singleinstance.h"
+
+#include <QDebug>
+#include <QFileInfo>
+#include <QLocalServer>
+#include <QLocalSocket>
+
+SingleInstance::SingleInstance(QObject *parent)
+    : QObject(parent)
+{
+    // Per user, so two sessions on one machine do not share a player.
+    QString user = qEnvironmentVariable("USER");
+    if (user.isEmpty())
+        user = qEnvironmentVariable("USERNAME");
+    m_serverName = QStringLiteral("miniMedia-%1").arg(user);
+}
+
+bool SingleInstance::forwardToRunningInstance(const QStringList &filePaths)
+{
+    QLocalSocket socket;
+    socket.connectToServer(m_serverName);
+    if (!socket.waitForConnected(mApp::INSTANCE_CONNECT_TIMEOUT_MS))
+        return false;
+
+    // The receiver has a different working directory.
+    QStringList absolutePaths;
+    for (const QString& filePath : filePaths)
+        absolutePaths << QFileInfo(filePath).absoluteFilePath();
+
+    // No paths just brings the running instance to the front.
+    socket.write(absolutePaths.join('\n').toUtf8());
+    socket.disconnectFromServer();
+    if (socket.state() != QLocalSocket::UnconnectedState
+        && !socket.waitForDisconnected(mApp::INSTANCE_CONNECT_TIMEOUT_MS)) {
+        qWarning() << Q_FUNC_INFO << "Running instance did not take the files:" << socket.errorString();
+        return false;
+    }
+
+    qInfo() << Q_FUNC_INFO << "Handed" << absolutePaths.size() << "file(s) to the running instance";
+    return true;
+}
+
+bool SingleInstance::listen()
+{
+    m_server = new QLocalServer(this);
+    m_server->setSocketOptions(QLocalServer::UserAccessOption);
+
+    if (!m_server->listen(m_serverName)) {
+        // A crashed instance leaves its socket file behind. Only remove it when nobody is listening
+        // on it; a live instance that was slow to answer above keeps its name.
+        QLocalSocket probe;
+        probe.connectToServer(m_serverName);
+        if (probe.waitForConnected(mApp::INSTANCE_CONNECT_TIMEOUT_MS)) {
+            probe.disconnectFromServer();
+            qInfo() << Q_FUNC_INFO << "Another instance is listening on" << m_serverName;
+            return false;
+        }
+        if (probe.error() != QLocalSocket::ServerNotFoundError
+            && probe.error() != QLocalSocket::ConnectionRefusedError) {
+            qWarning() << Q_FUNC_INFO << "Leaving" << m_serverName << "alone:" << probe.errorString();
+            return false;
+        }
+        QLocalServer::removeServer(m_serverName);
+        if (!m_server->listen(m_serverName)) {
+            qWarning() << Q_FUNC_INFO << "Unable to listen on" << m_serverName << m_server->errorString();
+            return false;
+        }
+    }
+
+    connect(m_server, &QLocalServer::newConnection, this, &SingleInstance::handleNewConnection);
+    return true;
+}
+
+void SingleInstance::handleNewConnection()
+{
+    while (QLocalSocket* socket = m_server->nextPendingConnection()) {
+        connect(socket, &QLocalSocket::disconnected, this, [this, socket]() {
+            const QStringList filePaths = QString::fromUtf8(socket->readAll()).split('\n', Qt::SkipEmptyParts);
+            socket->deleteLater();
+            emit filesReceived(filePaths);
+        });
+    }
+}
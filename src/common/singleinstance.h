@@ -0,0 +1,43 @@
+#ifndef SINGLEINSTANCE_H
+#define SINGLEINSTANCE_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+
+class QLocalServer;
+
+namespace mApp {
+const int INSTANCE_CONNECT_TIMEOUT_MS = 200;
+}
+
+/*
+ * One running instance per user. A new launch first tries to hand its file
+ * paths to the running instance over a local socket and exits; otherwise it
+ * becomes the running instance and listens for paths from later launches.
+ * The wire format is the UTF-8 paths separated by newlines, ended by the
+ * sender disconnecting; no paths only raises the running instance. A socket
+ * name is taken over only when nothing is listening on it.
+ */
+class SingleInstance : public QObject
+{
+    Q_OBJECT
+public:
+    explicit SingleInstance(QObject* parent = nullptr);
+
+    bool forwardToRunningInstance(const QStringList& filePaths);
+    // False when another instance owns the name or it cannot be taken.
+    bool listen();
+
+signals:
+    // Empty when a launch without files asked to be raised.
+    void filesReceived(const QStringList& filePaths);
+
+private:
+    void handleNewConnection();
+
+    QString m_serverName;
+    QLocalServer* m_server = nullptr;
+};
+
+#endif // SINGLEINSTANCE_H
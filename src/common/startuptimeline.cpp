@@ -0,0 +1,83 @@
+#include "startuptimeline.h"
+
+#include <QDebug>
+#include <QEvent>
+#include <QWidget>
+
+StartupTimeline::StartupTimeline(QObject *parent)
+    : QObject(parent)
+{
+}
+
+StartupTimeline *StartupTimeline::instance()
+{
+    // Usable before QApplication exists, so the clock covers its construction too.
+    static StartupTimeline timeline;
+    return &timeline;
+}
+
+void StartupTimeline::start()
+{
+    m_phases.clear();
+    m_awaitMediaFrame = false;
+    m_finished = false;
+    m_clock.start();
+}
+
+void StartupTimeline::mark(const char *phase)
+{
+    if (!m_clock.isValid() || m_finished)
+        return;
+
+    m_phases.append({phase, m_clock.nsecsElapsed() / 1000});
+}
+
+void StartupTimeline::finishOnFirstPaint(QWidget *window)
+{
+    m_window = window;
+    window->installEventFilter(this);
+}
+
+bool StartupTimeline::eventFilter(QObject *watched, QEvent *event)
+{
+    if (event->type() == QEvent::Paint && watched == m_window) {
+        m_window->removeEventFilter(this);
+        mark("first paint");
+        if (!m_awaitMediaFrame)
+            finish();
+    }
+    return QObject::eventFilter(watched, event);
+}
+
+void StartupTimeline::expectMediaFrame()
+{
+    m_awaitMediaFrame = true;
+}
+
+void StartupTimeline::mediaFrameShown()
+{
+    if (!m_awaitMediaFrame || m_finished)
+        return;
+
+    mark("first media frame");
+    finish();
+}
+
+void StartupTimeline::finish()
+{
+    if (m_finished || m_phases.isEmpty())
+        return;
+    m_finished = true;
+
+    qint64 previousUs = 0;
+    for (const Phase& phase : std::as_const(m_phases)) {
+        qInfo().noquote() << QStringLiteral("startup %1 %2 us (at %3 us)")
+                                 .arg(QLatin1String(phase.name), -20)
+                                 .arg(phase.endUs - previousUs, 8)
+                                 .arg(phase.endUs, 8);
+        previousUs = phase.endUs;
+    }
+    qInfo() << Q_FUNC_INFO << "Startup to" << m_phases.last().name << previousUs << "us";
+
+    emit finished();
+}
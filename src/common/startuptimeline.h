@@ -0,0 +1,56 @@
+#ifndef STARTUPTIMELINE_H
+#define STARTUPTIMELINE_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QList>
+#include <QPointer>
+
+class QWidget;
+
+/*
+ * Process-wide startup timeline. main() starts the clock, each startup
+ * step marks the end of a named phase, and the first paint of the main
+ * window (or, when files were given on the command line, the first media
+ * frame after it) closes the timeline and logs every phase with its own
+ * cost and the time since start.
+ */
+class StartupTimeline : public QObject
+{
+    Q_OBJECT
+public:
+    struct Phase {
+        const char* name;
+        qint64 endUs;
+    };
+
+    static StartupTimeline* instance();
+
+    void start();
+    void mark(const char* phase);
+    void finishOnFirstPaint(QWidget* window);
+    void expectMediaFrame();
+    void mediaFrameShown();
+
+    bool isFinished() const { return m_finished; }
+    qint64 totalUs() const { return m_phases.isEmpty() ? 0 : m_phases.last().endUs; }
+    const QList<Phase>& phases() const { return m_phases; }
+
+signals:
+    void finished();
+
+protected:
+    bool eventFilter(QObject* watched, QEvent* event) override;
+
+private:
+    explicit StartupTimeline(QObject* parent = nullptr);
+    void finish();
+
+    QElapsedTimer m_clock;
+    QList<Phase> m_phases;
+    QPointer<QWidget> m_window;
+    bool m_awaitMediaFrame = false;
+    bool m_finished = false;
+};
+
+#endif // STARTUPTIMELINE_H
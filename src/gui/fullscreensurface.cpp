@@ -0,0 +1,110 @@
+#include "fullscreensurface.h"
+
+#include <QKeyEvent>
+#include <QScreen>
+#include <QVBoxLayout>
+#include <QVideoFrame>
+#include <QVideoSink>
+#include <QVideoWidget>
+#include <QWindow>
+
+FullscreenSurface::FullscreenSurface(QWidget *parent)
+    : QWidget(parent, Qt::Window | Qt::FramelessWindowHint)
+    , m_videoWidget(new QVideoWidget(this))
+{
+    setWindowTitle(tr("Mini-Media"));
+
+    QVBoxLayout* layout = new QVBoxLayout(this);
+    layout->setContentsMargins(0, 0, 0, 0);
+    layout->addWidget(m_videoWidget);
+
+    // Keys pressed on the video go to this window's handlers.
+    m_videoWidget->setFocusProxy(this);
+    setFocusPolicy(Qt::StrongFocus);
+
+    // Native window and video surface exist from the start; a toggle only shows them.
+    create();
+    if (windowHandle())
+        windowHandle()->installEventFilter(this);
+}
+
+void FullscreenSurface::setSourceSink(QVideoSink *sink)
+{
+    if (m_sourceSink == sink)
+        return;
+
+    const bool active = isActive();
+    disconnect(m_mirrorConnection);
+    m_sourceSink = sink;
+
+    if (active && m_sourceSink) {
+        m_mirrorConnection = connect(m_sourceSink, &QVideoSink::videoFrameChanged,
+                                     m_videoWidget->videoSink(), &QVideoSink::setVideoFrame);
+    }
+}
+
+void FullscreenSurface::enter(QScreen *screen)
+{
+    if (isActive())
+        return;
+
+    m_toggleClock.start();
+
+    if (m_sourceSink) {
+        m_mirrorConnection = connect(m_sourceSink, &QVideoSink::videoFrameChanged,
+                                     m_videoWidget->videoSink(), &QVideoSink::setVideoFrame);
+        // Paused video must not come up black: start from the frame already shown.
+        m_videoWidget->videoSink()->setVideoFrame(m_sourceSink->videoFrame());
+    }
+
+    if (screen) {
+        windowHandle()->setScreen(screen);
+        setGeometry(screen->geometry());
+    }
+    showFullScreen();
+    activateWindow();
+    setFocus();
+}
+
+void FullscreenSurface::leave()
+{
+    if (!isActive())
+        return;
+
+    QElapsedTimer leaveClock;
+    leaveClock.start();
+
+    disconnect(m_mirrorConnection);
+    m_mirrorConnection = QMetaObject::Connection();
+    hide();
+    m_videoWidget->videoSink()->setVideoFrame(QVideoFrame());
+
+    qInfo() << Q_FUNC_INFO << "Fullscreen leave took" << leaveClock.nsecsElapsed() / 1000 << "us";
+}
+
+bool FullscreenSurface::eventFilter(QObject *watched, QEvent *event)
+{
+    if (watched == windowHandle() && event->type() == QEvent::Expose && m_toggleClock.isValid()
+        && windowHandle()->isExposed()) {
+        m_lastEnterLatencyUs = m_toggleClock.nsecsElapsed() / 1000;
+        m_toggleClock.invalidate();
+        qInfo() << Q_FUNC_INFO << "Fullscreen enter latency:" << m_lastEnterLatencyUs << "us";
+    }
+    return QWidget::eventFilter(watched, event);
+}
+
+void FullscreenSurface::keyPressEvent(QKeyEvent *event)
+{
+    emit keyPressed(event);
+}
+
+void FullscreenSurface::keyReleaseEvent(QKeyEvent *event)
+{
+    emit keyReleased(event);
+}
+
+void FullscreenSurface::mouseDoubleClickEvent(QMouseEvent *event)
+{
+    Q_UNUSED(event)
+    emit exitRequested();
+}
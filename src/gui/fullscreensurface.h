@@ -0,0 +1,54 @@
+#ifndef FULLSCREENSURFACE_H
+#define FULLSCREENSURFACE_H
+
+#include <QWidget>
+#include <QElapsedTimer>
+#include <QPointer>
+
+class QScreen;
+class QVideoSink;
+class QVideoWidget;
+
+/*
+ * Dedicated top-level window for fullscreen video.
+ * Created once with its own native surface and never reparented. While
+ * shown it mirrors the frames arriving at the player's video sink, so
+ * the player, its sink and the windowed surface stay untouched and the
+ * playback clock keeps running across a toggle. Keys are forwarded to
+ * the player's handlers. Enter latency is measured up to the first
+ * expose of the surface.
+ */
+class FullscreenSurface : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit FullscreenSurface(QWidget* parent = nullptr);
+
+    void setSourceSink(QVideoSink* sink);
+    void enter(QScreen* screen);
+    void leave();
+
+    bool isActive() const { return isVisible(); }
+    qint64 lastEnterLatencyUs() const { return m_lastEnterLatencyUs; }
+
+signals:
+    void keyPressed(QKeyEvent* event);
+    void keyReleased(QKeyEvent* event);
+    void exitRequested();
+
+protected:
+    bool eventFilter(QObject* watched, QEvent* event) override;
+    void keyPressEvent(QKeyEvent* event) override;
+    void keyReleaseEvent(QKeyEvent* event) override;
+    void mouseDoubleClickEvent(QMouseEvent* event) override;
+
+private:
+    QVideoWidget* m_videoWidget = nullptr;
+    QPointer<QVideoSink> m_sourceSink;
+    QMetaObject::Connection m_mirrorConnection;
+
+    QElapsedTimer m_toggleClock;
+    qint64 m_lastEnterLatencyUs = -1;
+};
+
+#endif // FULLSCREENSURFACE_H
@@ -0,0 +1,77 @@
+#include "imageinfooverlay.h"
+
+#include <QFileInfo>
+#include <QLocale>
+
+ImageInfoOverlay::ImageInfoOverlay(QWidget *parent)
+    : QLabel(parent)
+{
+    setTextFormat(Qt::PlainText);
+    setMargin(6);
+    setAutoFillBackground(true);
+    setBackgroundRole(QPalette::ToolTipBase);
+    setForegroundRole(QPalette::ToolTipText);
+    setAttribute(Qt::WA_TransparentForMouseEvents);
+    hide();
+}
+
+void ImageInfoOverlay::setImage(const QString &filePath, const ExifData &exif)
+{
+    m_fileName = QFileInfo(filePath).fileName();
+    m_exif = exif;
+    m_sourceSize = QSize();
+    refresh();
+}
+
+void ImageInfoOverlay::setSourceSize(const QSize &sourceSize)
+{
+    m_sourceSize = sourceSize;
+    refresh();
+}
+
+void ImageInfoOverlay::toggle()
+{
+    setVisible(!isVisible());
+    if (isVisible())
+        raise();
+}
+
+void ImageInfoOverlay::refresh()
+{
+    QStringList lines;
+    lines << m_fileName;
+    if (m_sourceSize.isValid()) {
+        lines << tr("%1 x %2 (%3 MP)").arg(m_sourceSize.width()).arg(m_sourceSize.height())
+                     .arg(qint64(m_sourceSize.width()) * m_sourceSize.height() / 1e6, 0, 'f', 1);
+    }
+
+    const QString camera = m_exif.model.startsWith(m_exif.make) ? m_exif.model
+                                                                : QStringList({m_exif.make, m_exif.model}).join(' ').trimmed();
+    if (!camera.isEmpty())
+        lines << tr("Camera: %1").arg(camera);
+    if (!m_exif.lens.isEmpty())
+        lines << tr("Lens: %1").arg(m_exif.lens);
+    if (m_exif.captureTime.isValid())
+        lines << tr("Taken: %1").arg(QLocale().toString(m_exif.captureTime, QLocale::ShortFormat));
+
+    QStringList exposure;
+    if (m_exif.exposureSeconds > 0.0) {
+        exposure << (m_exif.exposureSeconds < 1.0 ? QString("1/%1 s").arg(qRound(1.0 / m_exif.exposureSeconds))
+                                                  : QString("%1 s").arg(m_exif.exposureSeconds, 0, 'g', 3));
+    }
+    if (m_exif.fNumber > 0.0)
+        exposure << QString("f/%1").arg(m_exif.fNumber, 0, 'g', 3);
+    if (m_exif.iso > 0)
+        exposure << QString("ISO %1").arg(m_exif.iso);
+    if (m_exif.focalLengthMm > 0.0)
+        exposure << QString("%1 mm").arg(m_exif.focalLengthMm, 0, 'g', 4);
+    if (!exposure.isEmpty())
+        lines << tr("Exposure: %1").arg(exposure.join("  "));
+
+    if (!m_exif.valid)
+        lines << tr("No EXIF data");
+
+    setText(lines.join('\n'));
+    adjustSize();
+    move(8, 8);
+}
@@ -0,0 +1,33 @@
+#ifndef IMAGEINFOOVERLAY_H
+#define IMAGEINFOOVERLAY_H
+
+#include <QLabel>
+#include <QSize>
+
+#include "src/media/exifreader.h"
+
+/*
+ * Photo details over the top-left corner of the image: size, camera,
+ * lens, capture time and exposure, from the EXIF header the viewer has
+ * already read for the thumbnail. A child of the image surface, so it
+ * goes away with it; mouse events pass through to the cropper.
+ */
+class ImageInfoOverlay : public QLabel
+{
+    Q_OBJECT
+public:
+    explicit ImageInfoOverlay(QWidget* parent);
+
+    void setImage(const QString& filePath, const ExifData& exif);
+    void setSourceSize(const QSize& sourceSize);
+    void toggle();
+
+private:
+    void refresh();
+
+    QString m_fileName;
+    ExifData m_exif;
+    QSize m_sourceSize;
+};
+
+#endif // IMAGEINFOOVERLAY_H
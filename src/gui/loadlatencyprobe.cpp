@@ -0,0 +1,74 @@
+#include "loadlatencyprobe.h"
+#include "src/common/startuptimeline.h"
+
+#include <QEvent>
+#include <QVideoSink>
+#include <QWidget>
+
+LoadLatencyProbe::LoadLatencyProbe(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void LoadLatencyProbe::setSurfaces(QWidget *imageSurface, QWidget *audioSurface, QVideoSink *videoSink)
+{
+    m_imageSurface = imageSurface;
+    m_audioSurface = audioSurface;
+    imageSurface->installEventFilter(this);
+    audioSurface->installEventFilter(this);
+
+    connect(videoSink, &QVideoSink::videoFrameChanged, this, [this]() {
+        if (m_type == mApp::Rendering_Video)
+            finish();
+    });
+}
+
+void LoadLatencyProbe::start(mApp::RenderType type)
+{
+    m_type = type;
+    m_contentReady = false;
+    m_clock.start();
+}
+
+void LoadLatencyProbe::contentReady()
+{
+    if (m_clock.isValid())
+        m_contentReady = true;
+}
+
+void LoadLatencyProbe::cancel()
+{
+    m_type = mApp::Rendering_None;
+    m_contentReady = false;
+    m_clock.invalidate();
+}
+
+bool LoadLatencyProbe::eventFilter(QObject *watched, QEvent *event)
+{
+    if (event->type() == QEvent::Paint && m_clock.isValid() && m_contentReady) {
+        if ((m_type == mApp::Rendering_Image && watched == m_imageSurface)
+            || (m_type == mApp::Rendering_Audio && watched == m_audioSurface))
+            finish();
+    }
+    return QObject::eventFilter(watched, event);
+}
+
+void LoadLatencyProbe::finish()
+{
+    if (!m_clock.isValid() || m_type == mApp::Rendering_None)
+        return;
+
+    const qint64 latencyUs = m_clock.nsecsElapsed() / 1000;
+    TypeStats& stats = m_stats[m_type];
+    ++stats.count;
+    stats.totalUs += latencyUs;
+    stats.maxUs = qMax(stats.maxUs, latencyUs);
+
+    static const char* const typeNames[] = {"none", "image", "audio", "video"};
+    qInfo() << Q_FUNC_INFO << "Load-to-first-pixel" << typeNames[m_type] << latencyUs << "us (avg"
+            << stats.totalUs / stats.count << "us, max" << stats.maxUs << "us over" << stats.count << "loads)";
+
+    StartupTimeline::instance()->mediaFrameShown();
+
+    cancel();
+}
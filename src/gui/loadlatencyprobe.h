@@ -0,0 +1,52 @@
+#ifndef LOADLATENCYPROBE_H
+#define LOADLATENCYPROBE_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QPointer>
+
+#include "mediaplayer.h"
+
+class QVideoSink;
+
+/*
+ * Measures load-to-first-pixel per media type: from the open request to
+ * the first paint of the image or waveform surface after contentReady()
+ * (paints of what was shown before do not count), or the first frame at
+ * the video sink. Keeps a running count/average/maximum per type.
+ */
+class LoadLatencyProbe : public QObject
+{
+    Q_OBJECT
+public:
+    explicit LoadLatencyProbe(QObject* parent = nullptr);
+
+    void setSurfaces(QWidget* imageSurface, QWidget* audioSurface, QVideoSink* videoSink);
+
+    void start(mApp::RenderType type);
+    // The new content has been handed to its surface; its next paint ends the measurement.
+    void contentReady();
+    void cancel();
+
+protected:
+    bool eventFilter(QObject* watched, QEvent* event) override;
+
+private:
+    void finish();
+
+    struct TypeStats {
+        int count = 0;
+        qint64 totalUs = 0;
+        qint64 maxUs = 0;
+    };
+
+    QPointer<QWidget> m_imageSurface;
+    QPointer<QWidget> m_audioSurface;
+
+    mApp::RenderType m_type = mApp::Rendering_None;
+    bool m_contentReady = false;
+    QElapsedTimer m_clock;
+    TypeStats m_stats[mApp::Rendering_Video + 1];
+};
+
+#endif // LOADLATENCYPROBE_H
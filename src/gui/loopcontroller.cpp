@@ -0,0 +1,87 @@
+#include "loopcontroller.h"
+
+#include <QDebug>
+#include <QTimer>
+
+#include <utility>
+
+LoopController::LoopController(QObject *parent)
+    : QObject(parent)
+    , m_wrapTimer(new QTimer(this))
+{
+    m_wrapTimer->setSingleShot(true);
+    m_wrapTimer->setTimerType(Qt::PreciseTimer);
+    connect(m_wrapTimer, &QTimer::timeout, this, &LoopController::wrapDue);
+}
+
+void LoopController::cycleMarker(qint64 positionMs)
+{
+    if (isLooping()) {
+        clear();
+    } else if (m_startMs < 0) {
+        m_startMs = positionMs;
+        emit markersChanged(m_startMs, m_endMs);
+    } else {
+        setRange(m_startMs, positionMs);
+    }
+}
+
+void LoopController::setRange(qint64 startMs, qint64 endMs)
+{
+    if (startMs > endMs)
+        std::swap(startMs, endMs);
+    if (endMs - startMs < mApp::LOOP_MIN_LENGTH_MS) {
+        qDebug() << Q_FUNC_INFO << "Loop too short, ignored:" << startMs << endMs;
+        return;
+    }
+
+    m_wrapTimer->stop();
+    m_startMs = startMs;
+    m_endMs = endMs;
+    m_wrapCount = 0;
+    emit markersChanged(m_startMs, m_endMs);
+
+    qDebug() << Q_FUNC_INFO << "Looping" << m_startMs << "-" << m_endMs << "ms";
+}
+
+void LoopController::clear()
+{
+    m_wrapTimer->stop();
+    if (m_startMs < 0 && m_endMs < 0)
+        return;
+
+    if (m_wrapCount > 0)
+        qInfo() << Q_FUNC_INFO << "Loop cleared after" << m_wrapCount << "wraps";
+
+    m_startMs = m_endMs = -1;
+    m_wrapCount = 0;
+    emit markersChanged(m_startMs, m_endMs);
+}
+
+void LoopController::setPlaybackRate(double rate)
+{
+    m_rate = rate > 0.0 ? rate : 1.0;
+    // An armed timer was computed for the old rate; the next update re-arms it.
+    m_wrapTimer->stop();
+}
+
+void LoopController::updatePosition(qint64 positionMs)
+{
+    if (!isLooping() || m_wrapTimer->isActive())
+        return;
+
+    if (positionMs >= m_endMs) {
+        emit wrapDue();
+        return;
+    }
+
+    const qint64 remainingMs = qint64((m_endMs - positionMs) / m_rate);
+    if (remainingMs <= mApp::LOOP_ARM_WINDOW_MS)
+        m_wrapTimer->start(int(remainingMs));
+}
+
+void LoopController::wrapped()
+{
+    m_wrapTimer->stop();
+    ++m_wrapCount;
+}
@@ -0,0 +1,53 @@
+#ifndef LOOPCONTROLLER_H
+#define LOOPCONTROLLER_H
+
+#include <QObject>
+
+class QTimer;
+
+namespace mApp {
+const int LOOP_ARM_WINDOW_MS = 300;   // the wrap timer is armed this close to B
+const qint64 LOOP_MIN_LENGTH_MS = 100;
+}
+
+/*
+ * A-B loop markers and wrap timing.
+ * The first mark sets A, the second sets B and starts looping, the
+ * third clears both. Position updates are too coarse to wrap on, so
+ * shortly before B a precise single-shot timer is armed for the
+ * remaining (rate-scaled) time and wrapDue() fires on it.
+ */
+class LoopController : public QObject
+{
+    Q_OBJECT
+public:
+    explicit LoopController(QObject* parent = nullptr);
+
+    void cycleMarker(qint64 positionMs);
+    void setRange(qint64 startMs, qint64 endMs);
+    void clear();
+
+    bool isLooping() const { return m_startMs >= 0 && m_endMs >= 0; }
+    qint64 loopStart() const { return m_startMs; }
+    qint64 loopEnd() const { return m_endMs; }
+    int wrapCount() const { return m_wrapCount; }
+
+    void setPlaybackRate(double rate);
+    void updatePosition(qint64 positionMs);
+    void wrapped();
+
+signals:
+    // -1 for a marker that is not set.
+    void markersChanged(qint64 startMs, qint64 endMs);
+    void wrapDue();
+
+private:
+    QTimer* m_wrapTimer = nullptr;
+
+    qint64 m_startMs = -1;
+    qint64 m_endMs = -1;
+    double m_rate = 1.0;
+    int m_wrapCount = 0;
+};
+
+#endif // LOOPCONTROLLER_H
@@ -0,0 +1,59 @@
+#include "loopmarkeroverlay.h"
+
+#include <QEvent>
+#include <QPainter>
+#include <QSlider>
+#include <QStyle>
+
+LoopMarkerOverlay::LoopMarkerOverlay(QSlider *slider)
+    : QWidget(slider)
+    , m_slider(slider)
+{
+    setAttribute(Qt::WA_TransparentForMouseEvents);
+    setAttribute(Qt::WA_NoSystemBackground);
+    resize(slider->size());
+    slider->installEventFilter(this);
+    hide();
+}
+
+void LoopMarkerOverlay::setMarkers(qint64 startMs, qint64 endMs)
+{
+    m_startMs = startMs;
+    m_endMs = endMs;
+    setVisible(m_startMs >= 0 || m_endMs >= 0);
+    update();
+}
+
+bool LoopMarkerOverlay::eventFilter(QObject *watched, QEvent *event)
+{
+    if (watched == m_slider && event->type() == QEvent::Resize)
+        resize(m_slider->size());
+    return QWidget::eventFilter(watched, event);
+}
+
+int LoopMarkerOverlay::xForValue(qint64 value) const
+{
+    return QStyle::sliderPositionFromValue(m_slider->minimum(), m_slider->maximum(),
+                                           int(qMin<qint64>(value, INT_MAX)), width());
+}
+
+void LoopMarkerOverlay::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event)
+
+    QPainter painter(this);
+    QColor marker = palette().color(QPalette::Highlight);
+
+    if (m_startMs >= 0 && m_endMs >= 0) {
+        QColor region = marker;
+        region.setAlpha(60);
+        const int left = xForValue(m_startMs);
+        painter.fillRect(left, 0, xForValue(m_endMs) - left, height(), region);
+    }
+
+    painter.setPen(QPen(marker, 2));
+    if (m_startMs >= 0)
+        painter.drawLine(xForValue(m_startMs), 0, xForValue(m_startMs), height());
+    if (m_endMs >= 0)
+        painter.drawLine(xForValue(m_endMs), 0, xForValue(m_endMs), height());
+}
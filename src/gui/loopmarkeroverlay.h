@@ -0,0 +1,32 @@
+#ifndef LOOPMARKEROVERLAY_H
+#define LOOPMARKEROVERLAY_H
+
+#include <QWidget>
+
+class QSlider;
+
+/*
+ * Draws the A-B loop region on top of the timeline slider.
+ * Transparent for the mouse and kept at the slider's size.
+ */
+class LoopMarkerOverlay : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit LoopMarkerOverlay(QSlider* slider);
+
+    void setMarkers(qint64 startMs, qint64 endMs);
+
+protected:
+    bool eventFilter(QObject* watched, QEvent* event) override;
+    void paintEvent(QPaintEvent* event) override;
+
+private:
+    int xForValue(qint64 value) const;
+
+    QSlider* m_slider = nullptr;
+    qint64 m_startMs = -1;
+    qint64 m_endMs = -1;
+};
+
+#endif // LOOPMARKEROVERLAY_H
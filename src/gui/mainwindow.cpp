@@ -3,8 +3,12 @@
 
 #include "src/theme/themehandler.h"
 #include "mediaplayer.h"
+#include "statusrefresher.h"
+#include "src/common/startuptimeline.h"
+#include "src/media/imageresampler.h"
 
 #include <QAudioOutput>
+#include <QElapsedTimer>
 #include <QFileDialog>
 #include <QLabel>
 #include <QMessageBox>
@@ -14,20 +18,59 @@
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
     , ui(new Ui::MainWindow)
-    , m_captureSession (new QMediaCaptureSession(this))
-    , m_audioRecorder (new QMediaRecorder(this))
-    , m_videoRecorder (new QMediaRecorder(this))
-    , m_audioInput (new QAudioInput(this))
-    , m_videoWidget (new QVideoWidget(this))
-    , m_imageCapture (new QImageCapture(this))
-    , m_imagePreviewLabel (new QLabel(this))
 {
+    StartupTimeline* timeline = StartupTimeline::instance();
+
     ui->setupUi(this);
+    timeline->mark("setup ui");
+
+    setFocusPolicy(Qt::NoFocus);
+
+    m_statusRefresher = new StatusRefresher(ui, this);
+
+    m_mediaPlayerHandler = new MediaPlayer(this, this);
+    timeline->mark("media player");
+
+    connectSlots();
+
+    // Open on the player; capture devices are only touched once the recorder tab is used.
+    ui->mainTabWidget->setCurrentIndex(static_cast<int>(mApp::TAB_MEDIA_PLAYER));
+
+    setWindowShown();
+
+    m_themeHandler = new ThemeHandler(this, this);
+    timeline->mark("themes");
+}
+
+void MainWindow::openFiles(const QStringList &filePaths)
+{
+    if (!filePaths.isEmpty())
+        ui->mainTabWidget->setCurrentIndex(static_cast<int>(mApp::TAB_MEDIA_PLAYER));
+
+    if (isMinimized())
+        showNormal();
+    raise();
+    activateWindow();
+
+    m_mediaPlayerHandler->openFiles(filePaths);
+}
+
+/* Enumerates capture devices and builds the capture session on first use of the recorder tab. */
+void MainWindow::initializeRecorder()
+{
+    QElapsedTimer clock;
+    clock.start();
 
     m_cameras     = QMediaDevices::videoInputs();
     m_microphones = QMediaDevices::audioInputs();
 
-    setFocusPolicy(Qt::NoFocus);
+    m_captureSession = new QMediaCaptureSession(this);
+    m_audioRecorder = new QMediaRecorder(this);
+    m_videoRecorder = new QMediaRecorder(this);
+    m_audioInput = new QAudioInput(this);
+    m_videoWidget = new QVideoWidget(this);
+    m_imageCapture = new QImageCapture(this);
+    m_imagePreviewLabel = new QLabel(this);
 
     if(!m_cameras.isEmpty())
         m_camera = new QCamera(m_cameras.first(), this);
@@ -57,25 +100,26 @@ MainWindow::MainWindow(QWidget *parent)
 
     logAboutAvailableMediaDevices();
 
-    handleRecordingTypeChange();
-
+    connectCaptureSlots();
 
-    m_mediaPlayerHandler = new MediaPlayer(this, this);
+    handleRecordingTypeChange();
 
-    connectSlots();
+    qInfo() << Q_FUNC_INFO << "Recorder ready in" << clock.elapsed() << "ms";
+}
 
-    if(ui->mainTabWidget->count() > 0)
-        ui->mainTabWidget->setCurrentIndex(0);
 
+void MainWindow::connectSlots()
+{
+    connect(ui->pushButtonNextButtonRecorder, &QPushButton::clicked, this, &MainWindow::handleRecordingTypeChange);
 
-    setWindowShown();
-    setToImageCaptureMode();
+    connect(ui->pushButtonCaptureMedia, &QPushButton::clicked, this, &MainWindow::handleMediaCaptureEvent);
+    connect(ui->pushButtonCancelRec, &QPushButton::clicked, this, &MainWindow::hideImagePreview);
+    connect(ui->pushButtonSaveMediaRec, &QPushButton::clicked, this, &MainWindow::handleSaveMediaButton);
 
-    m_themeHandler = new ThemeHandler(this, this);
+    connect(ui->mainTabWidget, &QTabWidget::currentChanged, this, &MainWindow::handleTabChanged);
 }
 
-
-void MainWindow::connectSlots()
+void MainWindow::connectCaptureSlots()
 {
     connect(m_imageCapture, &QImageCapture::imageCaptured, this, [](int id, const QImage &image) {
         Q_UNUSED (id)
@@ -89,25 +133,17 @@ void MainWindow::connectSlots()
 
     connect(m_imageCapture, &QImageCapture::imageCaptured, this, &MainWindow::showImagePreview);
 
-    connect(ui->pushButtonNextButtonRecorder, &QPushButton::clicked, this, &MainWindow::handleRecordingTypeChange);
-
-    connect(ui->pushButtonCaptureMedia, &QPushButton::clicked, this, &MainWindow::handleMediaCaptureEvent);
-    connect(ui->pushButtonCancelRec, &QPushButton::clicked, this, &MainWindow::hideImagePreview);
-    connect(ui->pushButtonSaveMediaRec, &QPushButton::clicked, this, &MainWindow::handleSaveMediaButton);
-
     connect(m_audioRecorder, &QMediaRecorder::durationChanged, this, [this](qint64 duration) {
         if (m_audioRecorder->recorderState() != QMediaRecorder::PausedState) {
-            ui->labelRecordingTimer->setText(m_mediaPlayerHandler->formatTime(duration));
+            m_statusRefresher->setRecorderDuration(duration);
         }
     });
 
     connect(m_videoRecorder, &QMediaRecorder::durationChanged, this, [this](qint64 duration) {
         if (m_videoRecorder->recorderState() != QMediaRecorder::PausedState) {
-            ui->labelRecordingTimer->setText(m_mediaPlayerHandler->formatTime(duration));
+            m_statusRefresher->setRecorderDuration(duration);
         }
     });
-
-    connect(ui->mainTabWidget, &QTabWidget::currentChanged, this, &MainWindow::handleTabChanged);    
 }
 
 
@@ -257,6 +293,11 @@ void MainWindow::handleTabChanged(int currentTab) {
             break;
         }
     } else {
+        if (!m_captureSession) {
+            initializeRecorder();
+            return;
+        }
+
         switch (m_recorderButtonType) {
         case mApp::RECORD_TYPE_NONE: {
             qDebug() << Q_FUNC_INFO << "No recording or capture event is active.";
@@ -297,7 +338,8 @@ void MainWindow::showCamera()
 }
 void MainWindow::closeCamera()
 {
-    m_videoWidget->hide();
+    if (m_videoWidget)
+        m_videoWidget->hide();
     if (m_camera)
         m_camera->stop();
 
@@ -322,9 +364,9 @@ void MainWindow::showImagePreview(int id, const QImage &preview)
     if (!preview.isNull() && m_imagePreviewLabel) {
         m_capturedImage = preview;
 
-        QPixmap pixmap = QPixmap::fromImage(preview);
-        m_imagePreviewLabel->setPixmap(pixmap.scaled(
-            m_videoWidget->size(), Qt::KeepAspectRatio, Qt::SmoothTransformation));
+        // Resampled straight to the label's device pixels, on the worker pool.
+        m_imagePreviewLabel->setPixmap(QPixmap::fromImage(
+            ImageResampler::fitted(preview, m_videoWidget->size(), m_videoWidget->devicePixelRatioF())));
 
         m_videoWidget->hide();
 
@@ -569,12 +611,12 @@ void MainWindow::setWindowShown() {
     ui->pushButtonSaveMediaRec->setToolTip(tr("Save recorded media"));
     ui->pushButtonCancelRec->setToolTip(tr("Cancel media recording"));
 
-    ui->pushButtonMediaRestart->setToolTip(tr("Restart the media"));
+    ui->pushButtonMediaRestart->setToolTip(tr("Restart the media (or the A-B loop)"));
 
-    ui->pushButtonMediaPrev->setToolTip(tr("Jump back: left Arrow"));
+    ui->pushButtonMediaPrev->setToolTip(tr("Jump back, or previous image in the folder: left Arrow"));
     ui->pushButtonToggleMedia->setToolTip(tr("Play/Pause: space Bar"));
-    ui->pushButtonMediaNext->setToolTip(tr("Jump forward: right Arrow"));
-    ui->pushButtonLoadMedia->setToolTip(tr("Load media(Image/Audio/Video) file: O"));
+    ui->pushButtonMediaNext->setToolTip(tr("Jump forward, or next image in the folder: right Arrow"));
+    ui->pushButtonLoadMedia->setToolTip(tr("Load media(Image/Audio/Video) file: O. Select several files for a playlist: N/P. Add a library folder: L"));
     ui->pushButtonSound->setToolTip(tr("Mute/Unmute sound: M"));
 
     ui->sliderMediaPlayerVolume->setToolTip(tr("Volume handler: arrow Up/Down"));
@@ -582,13 +624,14 @@ void MainWindow::setWindowShown() {
     ui->labelRecordingTimer->setToolTip(tr("Timer for recording"));
     ui->tabMediaPlayer->setToolTip(tr("Media player tab"));
     ui->labelMediaElapsedTime->setToolTip(tr("Elapsed time of media playback"));
-    ui->sliderMediaPlayback->setToolTip(tr("Slider for media playback"));
+    ui->sliderMediaPlayback->setToolTip(tr("Slider for media playback. A-B loop markers: B"));
     ui->labelMediaTotalTime->setToolTip(tr("Total time of the media"));
     ui->sliderMediaPlayerVolume->setToolTip(tr("Adjust media volume: arrow Up/Down"));
     ui->labelMediaVolume->setToolTip(tr("Label for media volume control"));
     ui->comboBoxAudioSelector->setToolTip(tr("Select audio track for media: A"));
 
-    ui->pushButtonFullScreen->setToolTip(tr("Fullscreen mode: F/Esc"));
+    ui->pushButtonFullScreen->setToolTip(tr("Fullscreen mode: F/Esc. Playback stats: I, export: Ctrl+I"));
+    ui->pushButtonPlaybackSpeed->setToolTip(tr("Playback speed: [ slower, ] faster, \\ normal"));
 
 }
 
@@ -602,7 +645,7 @@ void MainWindow::setToImageCaptureMode()
     ui->pushButtonCancelRec->setDisabled(true);
     ui->pushButtonCancelRec->setHidden(false);
     ui->labelRecordingTimer->setVisible(false);
-    ui->labelRecordingTimer->setText("00:00:00");
+    m_statusRefresher->resetRecorderStatus();
 
     qDebug() << Q_FUNC_INFO << "Set to Image capture mode";
 }
@@ -658,7 +701,7 @@ void MainWindow::setRecStateStopped()
     m_multimediaRecordingState = mApp::RECORDING_STOPPED;
 
     const auto* recorder = isVideoRec ? m_videoRecorder:m_audioRecorder;
-    ui->labelRecordingTimer->setText("00:00:00");
+    m_statusRefresher->resetRecorderStatus();
 
     if(recorder->recorderState() != QMediaRecorder::StoppedState)
         qWarning() << Q_FUNC_INFO << "Error recorder state mismatch.";
@@ -725,8 +768,7 @@ void MainWindow::keyPressEvent(QKeyEvent *event)
     m_mediaPlayerHandler->buttonHandler(event);
 }
 
-
-
-
-
-
+void MainWindow::keyReleaseEvent(QKeyEvent *event)
+{
+    m_mediaPlayerHandler->buttonReleaseHandler(event);
+}
@@ -62,6 +62,7 @@ enum TabType {
 
 class MediaPlayer;
 class ThemeHandler;
+class StatusRefresher;
 
 QT_BEGIN_NAMESPACE
 namespace Ui {
@@ -80,9 +81,15 @@ public:
     Ui::MainWindow * getMainUi() const {
         return ui;
     }
+    StatusRefresher* getStatusRefresher() const {
+        return m_statusRefresher;
+    }
+    // Brings the window forward and plays the files, if any, on the player tab.
+    void openFiles(const QStringList& filePaths);
 protected:
     void changeEvent(QEvent *event) override;
     void keyPressEvent(QKeyEvent* event) override;
+    void keyReleaseEvent(QKeyEvent* event) override;
 private slots:
 
 
@@ -126,7 +133,10 @@ private:
 
     void setWindowShown();
 
+    void initializeRecorder();
+
     void connectSlots();
+    void connectCaptureSlots();
 
     void cleanPlayerWidget(QVBoxLayout*);
 
@@ -159,6 +169,7 @@ private:
     // Only for audio/video: nothing, recording, paused.
     mApp::RecordingState m_multimediaRecordingState = mApp::RECORDING_STOPPED;
 
+    StatusRefresher* m_statusRefresher = nullptr;
     MediaPlayer* m_mediaPlayerHandler = nullptr;
     ThemeHandler* m_themeHandler = nullptr;
 };
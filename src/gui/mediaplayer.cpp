@@ -1,17 +1,47 @@
 #include "mediaplayer.h"
 
+#include <QCollator>
+#include <QDateTime>
+#include <QDir>
 #include <QFileDialog>
 #include <QStandardPaths>
 #include <QFileInfo>
+#include <QHash>
 #include <QString>
 #include <QLabel>
 #include <QImage>
+#include <QImageReader>
 #include <QKeyEvent>
 #include <QMainWindow>
 #include <QMediaMetaData>
 #include <QMediaFormat>
+#include <QSignalBlocker>
+#include <QStackedWidget>
+#include <QVideoSink>
+#include <QStyle>
 
 #include "mainwindow.h"
+#include "fullscreensurface.h"
+#include "imageinfooverlay.h"
+#include "loadlatencyprobe.h"
+#include "loopcontroller.h"
+#include "loopmarkeroverlay.h"
+#include "seekscheduler.h"
+#include "statsoverlay.h"
+#include "statusrefresher.h"
+#include "waveformwidget.h"
+#include "spectrumwidget.h"
+#include "src/media/audiotap.h"
+#include "src/media/exifreader.h"
+#include "src/media/keyframeindexer.h"
+#include "src/media/medialibrary.h"
+#include "src/media/mediasniffer.h"
+#include "src/media/imagedecoder.h"
+#include "src/media/imageprefetcher.h"
+#include "src/media/playbackstats.h"
+#include "src/media/speedcontroller.h"
+#include "src/media/timestretcher.h"
+#include "src/media/thumbnailcache.h"
 #include "src/common/imagecropper.h"
 
 #include "ui_mainwindow.h"
@@ -23,16 +53,69 @@ MediaPlayer::MediaPlayer(MainWindow* mainWindow, QObject* parent)
     , m_audioOutput(new QAudioOutput(mainWindow))
     , m_videoWidget(new QVideoWidget(mainWindow))
     , m_mediaPlayer(new QMediaPlayer(mainWindow))
+    , m_standbyAudioOutput(new QAudioOutput(mainWindow))
+    , m_standbyPlayer(new QMediaPlayer(mainWindow))
 {
     mainUi = m_mainWindow->getMainUi();
+    m_statusRefresher = m_mainWindow->getStatusRefresher();
 
     m_vLayoutMediaPlayer = mainUi->vLayoutMediaPlayer;
 
     m_mediaPlayer->setAudioOutput(m_audioOutput);
     m_mediaPlayer->setVideoOutput(m_videoWidget);
+    m_standbyPlayer->setAudioOutput(m_standbyAudioOutput);
 
-    m_videoWidget->hide();
-    m_imageLabel->hide();
+    m_seekScheduler = new SeekScheduler(m_mediaPlayer, this);
+    m_seekScheduler->setVideoSink(m_videoWidget->videoSink());
+
+    m_keyframeIndexer = new KeyframeIndexer(this);
+    m_mediaLibrary = new MediaLibrary(this);
+    m_thumbnailCache = new ThumbnailCache(this);
+
+    m_scrubPreview = new QLabel(mainUi->sliderMediaPlayback, Qt::ToolTip);
+    m_scrubPreview->hide();
+
+    m_loopController = new LoopController(this);
+    m_loopOverlay = new LoopMarkerOverlay(mainUi->sliderMediaPlayback);
+
+    m_waveformWidget = new WaveformWidget(mainWindow);
+
+    m_audioTap = new AudioTap(this);
+    m_audioTap->setPlayer(m_mediaPlayer);
+
+    m_speedController = new SpeedController(m_audioTap, this);
+    m_speedController->setPlayer(m_mediaPlayer, m_audioOutput);
+
+    // Spectrum/level panel above the transport controls, toggled with S.
+    m_spectrumWidget = new SpectrumWidget(m_audioTap, mainWindow);
+    m_spectrumWidget->hide();
+    mainUi->vLayoutMediaPlayerController->insertWidget(0, m_spectrumWidget);
+
+    // Frame timing overlay for video, toggled with I; collects nothing while hidden.
+    m_playbackStats = new PlaybackStats(this);
+    m_playbackStats->setPlayer(m_mediaPlayer);
+    m_playbackStats->setVideoSink(m_videoWidget->videoSink());
+    m_statsOverlay = new StatsOverlay(m_playbackStats, m_videoWidget);
+
+    // Top-level fullscreen surface, mirrors the video sink while shown.
+    m_fullscreenSurface = new FullscreenSurface;
+    m_fullscreenSurface->setSourceSink(m_videoWidget->videoSink());
+
+    m_emptySurface = new QWidget(mainWindow);
+    m_surfaceStack = new QStackedWidget(mainWindow);
+    m_surfaceStack->addWidget(m_emptySurface);
+    m_surfaceStack->addWidget(m_imageLabel);
+    m_surfaceStack->addWidget(m_waveformWidget);
+    m_surfaceStack->addWidget(m_videoWidget);
+    m_vLayoutMediaPlayer->addWidget(m_surfaceStack);
+
+    m_loadLatencyProbe = new LoadLatencyProbe(this);
+    m_loadLatencyProbe->setSurfaces(m_imageLabel, m_waveformWidget, m_videoWidget->videoSink());
+
+    // Images are decoded off the GUI thread at display size: preview first, then refined.
+    m_imageDecoder = new ImageDecoder(this);
+    m_imageInfo = new ImageInfoOverlay(m_imageLabel);
+    m_imagePrefetcher = new ImagePrefetcher(this);
 
     connectSlots();
 
@@ -41,6 +124,10 @@ MediaPlayer::MediaPlayer(MainWindow* mainWindow, QObject* parent)
 }
 
 MediaPlayer::~MediaPlayer() {
+    if(m_fullscreenSurface) {
+        delete m_fullscreenSurface;
+        m_fullscreenSurface = nullptr;
+    }
     if(m_videoWidget) {
         delete m_videoWidget;
         m_videoWidget = nullptr;
@@ -61,6 +148,53 @@ void MediaPlayer::buttonHandler(QKeyEvent *event)
         return;
     }
 
+    if (_key == Qt::Key_L) {
+        addLibraryFolder();
+        return;
+    }
+
+    if (_key == Qt::Key_S && (m_renderingType == mApp::Rendering_Audio || m_renderingType == mApp::Rendering_Video)) {
+        m_spectrumWidget->setVisible(!m_spectrumWidget->isVisible());
+        return;
+    }
+
+    if (m_renderingType == mApp::Rendering_Audio || m_renderingType == mApp::Rendering_Video) {
+        if (_key == Qt::Key_BracketRight) {
+            m_speedController->faster();
+            return;
+        }
+        if (_key == Qt::Key_BracketLeft) {
+            m_speedController->slower();
+            return;
+        }
+        if (_key == Qt::Key_Backslash) {
+            m_speedController->setRate(1.0);
+            return;
+        }
+        if (_key == Qt::Key_B) {
+            m_loopController->cycleMarker(m_mediaPlayer->position());
+            return;
+        }
+    }
+
+    if (m_renderingType == mApp::Rendering_Image) {
+        if (_key == Qt::Key_Right || _key == Qt::Key_N)
+            showFolderImage(1);
+        else if (_key == Qt::Key_Left || _key == Qt::Key_P)
+            showFolderImage(-1);
+        else if (_key == Qt::Key_I)
+            m_imageInfo->toggle();
+        return;
+    }
+
+    if (!m_playlist.isEmpty() && (_key == Qt::Key_N || _key == Qt::Key_P)) {
+        if (_key == Qt::Key_N)
+            playPlaylistNext();
+        else
+            playPlaylistPrevious();
+        return;
+    }
+
     if (m_renderingType != mApp::Rendering_Video)
         return;
 
@@ -68,12 +202,25 @@ void MediaPlayer::buttonHandler(QKeyEvent *event)
         goFullScreenVideo(event);
     else if (_key == Qt::Key_A)
         handleNextAudioTrack();
+    else if (_key == Qt::Key_I) {
+        if (event->modifiers() & Qt::CTRL)
+            exportPlaybackStats();
+        else
+            m_statsOverlay->toggle();
+    }
     else if (_key == Qt::Key_Space)
         handleMediaPlayerToggleButton();
-    else if (_key == Qt::Key_Right)
-        handleNextPressed();
-    else if (_key == Qt::Key_Left)
-        handlePrevPressed();
+    else if (_key == Qt::Key_Right || _key == Qt::Key_Left) {
+        // Holding the key scrubs: coarse seeks until the key is released.
+        if (event->isAutoRepeat()) {
+            m_seekScheduler->beginScrub();
+            m_statusRefresher->setSliderFollowsPosition(false);
+        }
+        if (_key == Qt::Key_Right)
+            handleNextPressed();
+        else
+            handlePrevPressed();
+    }
     else if (_key == Qt::Key_Down) {
         const int currentValue = mainUi->sliderMediaPlayerVolume->value();
         const int newValue = qMax(currentValue - 5, 0); // Make sure it doesn't go below 0
@@ -94,12 +241,66 @@ void MediaPlayer::buttonHandler(QKeyEvent *event)
 
 }
 
+void MediaPlayer::buttonReleaseHandler(QKeyEvent *event)
+{
+    if (event->isAutoRepeat())
+        return;
+
+    const auto _key = event->key();
+    if (_key == Qt::Key_Right || _key == Qt::Key_Left) {
+        m_seekScheduler->endScrub();
+        m_statusRefresher->setSliderFollowsPosition(true);
+    }
+}
 
 void MediaPlayer::connectSlots()
 {
     connect(mainUi->mainTabWidget, &QTabWidget::currentChanged, this, &MediaPlayer::handleTabChanged);
 
     connect(mainUi->sliderMediaPlayback, &QSlider::valueChanged, this, &MediaPlayer::handlePlaybackSlider);
+    connect(mainUi->sliderMediaPlayback, &QSlider::sliderPressed, m_seekScheduler, &SeekScheduler::beginScrub);
+    connect(mainUi->sliderMediaPlayback, &QSlider::sliderReleased, m_seekScheduler, &SeekScheduler::endScrub);
+    connect(mainUi->sliderMediaPlayback, &QSlider::sliderMoved, this, &MediaPlayer::showScrubPreview);
+    connect(mainUi->sliderMediaPlayback, &QSlider::sliderReleased, this, &MediaPlayer::hideScrubPreview);
+
+    connect(m_keyframeIndexer, &KeyframeIndexer::indexReady, this, [this](const QString& filePath, const KeyframeIndex& index) {
+        m_seekScheduler->setKeyframeIndex(index);
+        qDebug() << Q_FUNC_INFO << index.size() << "keyframes available for" << filePath;
+    });
+
+    connect(m_waveformWidget, &WaveformWidget::seekRequested, m_seekScheduler, &SeekScheduler::requestSeek);
+
+    // Stretched audio still queued for the old position is dropped after a seek.
+    connect(m_seekScheduler, &SeekScheduler::seekCompleted, m_speedController, &SpeedController::flush);
+    connect(m_speedController, &SpeedController::rateChanged, this, &MediaPlayer::updateSpeedButton);
+    connect(m_speedController, &SpeedController::rateChanged, m_loopController, &LoopController::setPlaybackRate);
+    connect(m_speedController, &SpeedController::statsChanged, this, &MediaPlayer::updateSpeedButton);
+    connect(mainUi->pushButtonPlaybackSpeed, &QPushButton::clicked, this, [this]() {
+        // Cycles through the speed steps, wrapping from the fastest to the slowest.
+        if (m_speedController->rate() >= mApp::STRETCH_MAX_RATE)
+            m_speedController->setRate(mApp::STRETCH_MIN_RATE);
+        else
+            m_speedController->faster();
+    });
+
+    connect(m_loopController, &LoopController::markersChanged, this, [this](qint64 startMs, qint64 endMs) {
+        m_loopOverlay->setMarkers(startMs, endMs);
+        m_waveformWidget->setLoopRange(startMs, endMs);
+
+        // While looping the standby pipeline waits at A instead of holding the next item.
+        if (m_loopController->isLooping()) {
+            primeLoopStandby();
+        } else if (!m_standbyPath.isEmpty() && m_standbyPath == m_currentFilePath) {
+            resetStandbyPlayer();
+            prerollNextItem();
+        }
+    });
+    connect(m_loopController, &LoopController::wrapDue, this, &MediaPlayer::wrapLoop);
+
+    connect(m_mediaLibrary, &MediaLibrary::mediaInfoUpdated, this, [this](const QString& filePath) {
+        if (filePath == m_currentFilePath)
+            showMediaInfo(filePath);
+    });
     connect(mainUi->sliderMediaPlayerVolume, &QSlider::valueChanged, this, &MediaPlayer::handleVolumeSlider);
 
     connect(mainUi->pushButtonMediaNext, &QPushButton::clicked, this, &MediaPlayer::handleNextPressed);
@@ -112,7 +313,7 @@ void MediaPlayer::connectSlots()
     connect(mainUi->pushButtonFullScreen, &QPushButton::clicked, this, [this](){
         if (m_renderingType != mApp::Rendering_Video)
             return;
-        if (!m_mainWindow->isFullScreen())
+        if (!isVideoFullScreen())
             setFullScreen();
         else
             unsetFullScreen();
@@ -121,43 +322,49 @@ void MediaPlayer::connectSlots()
     // Connect ComboBox activation to change the audio track
     connect(mainUi->comboBoxAudioSelector, QOverload<int>::of(&QComboBox::activated), this, [this](int idx) {
         m_mediaPlayer->setActiveAudioTrack(idx);
+        if (m_standbyPath == m_currentFilePath)
+            m_standbyPlayer->setActiveAudioTrack(idx);
         qDebug() << Q_FUNC_INFO << "Selected Audio Track Index:" << idx;
     });
 
-    // Duration changed handler
-    connect(m_mediaPlayer, &QMediaPlayer::durationChanged, this, [this]() {
-        if (!m_mediaPlayer) {
-            qWarning() << Q_FUNC_INFO << "Media player is null!";
-            return;
-        }
+    mainUi->comboBoxAudioSelector->setFocusPolicy(Qt::NoFocus);
 
-        const qint64 duration = m_mediaPlayer->duration();
-        const QString formattedTime = formatTime(duration);
+    connect(m_fullscreenSurface, &FullscreenSurface::keyPressed, this, &MediaPlayer::buttonHandler);
+    connect(m_fullscreenSurface, &FullscreenSurface::keyReleased, this, &MediaPlayer::buttonReleaseHandler);
+    connect(m_fullscreenSurface, &FullscreenSurface::exitRequested, this, &MediaPlayer::unsetFullScreen);
 
-        mainUi->labelMediaTotalTime->setText(formattedTime);
+    // First frame after a playlist switch ends the switch latency measurement.
+    connect(m_videoWidget->videoSink(), &QVideoSink::videoFrameChanged, this, [this]() {
+        if (!m_switchClock.isValid())
+            return;
+        qInfo() << Q_FUNC_INFO << "Playlist switch latency:" << m_switchClock.nsecsElapsed() / 1000 << "us";
+        m_switchClock.invalidate();
     });
 
-    connect(m_mediaPlayer, &QMediaPlayer::mediaStatusChanged, this, [this](QMediaPlayer::MediaStatus status) {
-        Q_UNUSED(status)
-        qint64 totalDuration = m_mediaPlayer->duration();
-        mainUi->labelMediaTotalTime->setText(formatTime(totalDuration));
-        qDebug() << Q_FUNC_INFO << "Played total time: " << m_mediaPlayer->duration();
+    connect(m_imageDecoder, &ImageDecoder::previewReady, this, [this](const QString& filePath, const QImage& image) {
+        if (filePath == m_pendingImagePath)
+            showDecodedImage(QPixmap::fromImage(image), true);
     });
-
-    mainUi->comboBoxAudioSelector->setFocusPolicy(Qt::NoFocus);
-
-    // Position changed handler
-    connect(m_mediaPlayer, &QMediaPlayer::positionChanged, this, [this]() {
-        if (!m_mediaPlayer) {
-            qWarning() << Q_FUNC_INFO << "Media player is null!";
+    connect(m_imageDecoder, &ImageDecoder::imageReady, this, [this](const QString& filePath, const QImage& image, const QSize& sourceSize) {
+        if (filePath != m_pendingImagePath)
             return;
-        }
-
-        const qint64 position = m_mediaPlayer->position();
-        const QString formattedTime = formatTime(position);
-
-        mainUi->labelMediaElapsedTime->setText(formattedTime);
+        showDecodedImage(QPixmap::fromImage(image), false);
+        setImageZoomSource(filePath, sourceSize);
+        m_imageInfo->setSourceSize(sourceSize);
+        m_imagePrefetcher->insert(filePath, imageTargetSize(), m_imageLabel->pixmap(), sourceSize);
+        prefetchFolderNeighbours();
+        m_pendingImagePath.clear();
+        qDebug() << Q_FUNC_INFO << "Image loaded successfully:" << filePath;
     });
+    connect(m_imageDecoder, &ImageDecoder::decodeFailed, this, [this](const QString& filePath, const QString& error) {
+        if (filePath != m_pendingImagePath)
+            return;
+        qDebug() << "Failed to load image from:" << filePath << error;
+        m_pendingImagePath.clear();
+        m_loadLatencyProbe->cancel();
+    });
+
+    connectPlayerSlots();
 
 
     // connect(m_imageLabel, QLabel::mousePressEvent, this, [this](QMouseEvent* event){
@@ -174,33 +381,127 @@ void MediaPlayer::connectSlots()
 
 void MediaPlayer::loadImage(const QString &filePath)
 {
-    QImage image(filePath);
-    if (image.isNull()) {
-        qDebug() << "Failed to load image from:" << filePath;
+    qDebug() << Q_FUNC_INFO << "Image loading started";
+
+    updateFolderImages(filePath);
+
+    // Only the mapped file header: metadata for the info panel and the embedded thumbnail.
+    const ExifData exif = ExifReader::readFile(filePath);
+    m_imageOrientation = exif.orientation;
+    m_imageInfo->setImage(filePath, exif);
+
+    // Prefetched neighbours are shown right away, without a decode.
+    const QSize targetSize = imageTargetSize();
+    ImagePrefetcher::Entry cached;
+    if (m_imagePrefetcher->lookup(filePath, targetSize, &cached)) {
+        m_imageDecoder->cancel();
+        m_pendingImagePath.clear();
+        showDecodedImage(cached.pixmap, false);
+        setImageZoomSource(filePath, cached.sourceSize);
+        m_imageInfo->setSourceSize(cached.sourceSize);
+        prefetchFolderNeighbours();
         return;
     }
 
-    qDebug() << Q_FUNC_INFO << "Image loading started";
+    // Decoded to fit the tab; the current media stays until the first pixels arrive.
+    m_pendingImagePath = filePath;
+    m_imageDecoder->decode(filePath, targetSize);
 
-    // Set the pixmap of the image label with the scaled image
-    m_imageLabel->setPixmap(QPixmap::fromImage(image).scaled(
-        mainUi->tabMediaPlayer->geometry().size(), // Scale to fit the QGroupBox
-        Qt::KeepAspectRatio,
-        Qt::SmoothTransformation // Smoother scaling
-        ));
-    m_imageLabel->setAlignment(Qt::AlignCenter); // Center the image within the label
+    // While the decoder works, the camera's thumbnail is the first thing shown.
+    const QImage thumbnail = exif.thumbnailImage();
+    if (!thumbnail.isNull())
+        showDecodedImage(QPixmap::fromImage(thumbnail), true);
+}
+
+void MediaPlayer::setImageZoomSource(const QString &filePath, const QSize &sourceSize)
+{
+    m_imageLabel->setImageSource(filePath, sourceSize, m_imageOrientation);
+}
 
-    stopMediaPlayer();
+void MediaPlayer::showDecodedImage(const QPixmap &pixmap, bool preview)
+{
+    // The preview is a fraction of the display size; stretch it cheaply until the refined image replaces it.
+    // Decoded in device pixels; with the ratio set the label draws them 1:1 on HiDPI screens.
+    QPixmap shown = preview ? pixmap.scaled(imageTargetSize(), Qt::KeepAspectRatio, Qt::FastTransformation) : pixmap;
+    shown.setDevicePixelRatio(m_imageLabel->devicePixelRatioF());
+    m_imageLabel->setPixmap(shown);
+    if (preview)
+        m_imageLabel->setImageSource(QString(), QSize()); // no zoom until the refined image is in
+    m_imageLabel->setAlignment(Qt::AlignCenter); // Center the image within the label
 
-    showImageWidget();
+    if (m_renderingType != mApp::Rendering_Image || m_surfaceStack->currentWidget() != m_imageLabel) {
+        stopMediaPlayer();
+        showImageWidget();
+    }
 
     setMediaPlayerLoadedImageState();
     m_renderingType = mApp::Rendering_Image;
+    m_loadLatencyProbe->contentReady();
+}
+
+QSize MediaPlayer::imageTargetSize() const
+{
+    // In device pixels: decode, cache and prefetch at the resolution the screen shows.
+    return mainUi->tabMediaPlayer->geometry().size() * m_imageLabel->devicePixelRatioF();
+}
+
+void MediaPlayer::updateFolderImages(const QString &filePath)
+{
+    const QFileInfo info(filePath);
+    const QString absolutePath = info.absoluteFilePath();
+    if (info.absolutePath() == m_folderPath && m_folderImages.setCurrentIndex(m_folderImages.indexOf(absolutePath)))
+        return;
+
+    // Listed by suffix; sniffing every file of a large folder would cost more than browsing saves.
+    static QStringList nameFilters;
+    if (nameFilters.isEmpty()) {
+        for (const QByteArray& format : QImageReader::supportedImageFormats())
+            nameFilters << "*." + QString::fromLatin1(format);
+    }
+
+    const QDir dir(info.absolutePath());
+    QStringList fileNames = dir.entryList(nameFilters, QDir::Files | QDir::Readable);
+    QCollator collator;
+    collator.setNumericMode(true);
+    collator.setCaseSensitivity(Qt::CaseInsensitive);
+    std::sort(fileNames.begin(), fileNames.end(), collator);
+
+    QStringList filePaths;
+    for (const QString& fileName : std::as_const(fileNames))
+        filePaths << dir.absoluteFilePath(fileName);
+    if (!filePaths.contains(absolutePath))
+        filePaths.prepend(absolutePath); // sniffed as an image despite its name
+
+    m_folderImages.setItems(filePaths);
+    m_folderImages.setCurrentIndex(filePaths.indexOf(absolutePath));
+    m_folderPath = info.absolutePath();
+    m_folderDirection = 1;
+}
+
+void MediaPlayer::showFolderImage(int step)
+{
+    if (!m_folderImages.setCurrentIndex(m_folderImages.currentIndex() + step))
+        return;
 
-    qDebug() << Q_FUNC_INFO << "Image loaded successfully:" << filePath;
+    m_folderDirection = step < 0 ? -1 : 1;
+    openFile(m_folderImages.currentItem());
 }
 
-void MediaPlayer::playMedia(const QString &filePath)
+void MediaPlayer::prefetchFolderNeighbours()
+{
+    // More ahead in the browsing direction than behind.
+    const int index = m_folderImages.currentIndex();
+    QStringList neighbours;
+    for (int i = 1; i <= mApp::IMAGE_PREFETCH_AHEAD; ++i)
+        neighbours << m_folderImages.itemAt(index + i * m_folderDirection);
+    for (int i = 1; i <= mApp::IMAGE_PREFETCH_BEHIND; ++i)
+        neighbours << m_folderImages.itemAt(index - i * m_folderDirection);
+    neighbours.removeAll(QString());
+
+    m_imagePrefetcher->prefetch(neighbours, imageTargetSize());
+}
+
+void MediaPlayer::playMedia(const QString &filePath, mApp::RenderType type)
 {
     if (!m_mediaPlayer) {
         qWarning() << Q_FUNC_INFO << "Media player unavailable!";
@@ -216,29 +517,41 @@ void MediaPlayer::playMedia(const QString &filePath)
 
     showNoneWidget();
 
+    m_loopController->clear();
+
+    // A pre-rolled item that is not the next one any more is useless.
+    if (m_standbyPath != m_playlist.nextItem() || m_playlist.nextItem().isEmpty())
+        resetStandbyPlayer();
+
     QUrl mediaUrl = QUrl::fromLocalFile(filePath);
     if (!mediaUrl.isValid()) {
         qWarning() << Q_FUNC_INFO << "Invalid file path provided:" << filePath;
         return;
     }
     m_mediaPlayer->setSource(mediaUrl);
-    showVideoWidget();
+    showWidgetForFile(filePath, type);
+
+    // Until the index is ready scrubbing falls back to the coarse grid.
+    m_seekScheduler->setKeyframeIndex(KeyframeIndex());
+    m_keyframeIndexer->indexFile(filePath);
+    m_thumbnailCache->open(filePath);
 
 
     // Set volume slider to reflect the current volume
-    if (m_mediaPlayer->audioOutput()) {
-        const int currentVolume = static_cast<int>(m_mediaPlayer->audioOutput()->volume() * 100);
+    if (m_audioOutput) {
+        const int currentVolume = static_cast<int>(m_audioOutput->volume() * 100);
         mainUi->sliderMediaPlayerVolume->setValue(currentVolume);
     } else {
         qWarning() << Q_FUNC_INFO << "Audio output is unavailable!";
     }
 
-    // Set position slider to reflect the current playback position
+    // Set position slider to reflect the current playback position (ms)
     if (m_mediaPlayer) {
+        const QSignalBlocker blocker(mainUi->sliderMediaPlayback);
         const qint64 duration = m_mediaPlayer->duration(); // Total duration in ms
         if (duration > 0) {
-            const int currentPos = static_cast<int>((m_mediaPlayer->position() * 100) / duration);
-            mainUi->sliderMediaPlayback->setValue(currentPos);
+            mainUi->sliderMediaPlayback->setRange(0, static_cast<int>(qMin<qint64>(duration, INT_MAX)));
+            mainUi->sliderMediaPlayback->setValue(static_cast<int>(m_mediaPlayer->position()));
         } else {
             mainUi->sliderMediaPlayback->setValue(0); // Reset slider if no duration is available
         }
@@ -251,27 +564,14 @@ void MediaPlayer::playMedia(const QString &filePath)
     m_mediaPlayer->play();
 
     // Retrieve available audio tracks
-    mainUi->comboBoxAudioSelector->clear();
-    QList<QMediaMetaData> audiosAvailable = m_mediaPlayer->audioTracks();
-
-    if(audiosAvailable.length() > 1) {
-        for (const QMediaMetaData &audioMetaData : audiosAvailable) {
-            QString language = audioMetaData.value(QMediaMetaData::Language).toString();
-            if (language.isEmpty()) {
-                language = "Unknown Language";
-            }
-            qDebug() << Q_FUNC_INFO << "Audio Track Language:" << language;
-            mainUi->comboBoxAudioSelector->addItem(language);
-        }
-    }
-
-    bool hasComboBox = mainUi->comboBoxAudioSelector->count() > 1;
-    mainUi->comboBoxAudioSelector->setEnabled(hasComboBox);
-    mainUi->comboBoxAudioSelector->setVisible(hasComboBox);
+    refreshAudioTracks();
 
 
     setMediaPlayerPlayingState();
 
+    m_currentFilePath = filePath;
+    showMediaInfo(filePath);
+
     qDebug() << Q_FUNC_INFO << "Playing media:" << filePath;
 }
 
@@ -312,6 +612,13 @@ void MediaPlayer::stopMediaPlayer()
     }
 
     // Stop playback and reset the media player
+    unsetFullScreen();
+    m_loopController->clear();
+    resetStandbyPlayer();
+    m_seekScheduler->reset();
+    m_keyframeIndexer->cancel();
+    m_thumbnailCache->close();
+    m_waveformWidget->clear();
     m_mediaPlayer->stop();
 
     // Clear the media source
@@ -341,20 +648,12 @@ void MediaPlayer::showNoneWidget()
     }
 
     // Reset media labels
-    mainUi->labelMediaElapsedTime->setText("00:00:00");
-    mainUi->labelMediaTotalTime->setText("00:00:00");
+    m_statusRefresher->resetPlayerStatus();
+    m_statsOverlay->hide();
     mainUi->labelMediaVolume->setText("00:00:00");
 
-
-    // Remove and delete all widgets from the layout
-    QLayoutItem* child;
-    while ((child = m_vLayoutMediaPlayer->takeAt(0)) != nullptr) {
-        if (child->widget()) {
-            child->widget()->hide();  // Hide the widget
-            m_vLayoutMediaPlayer->removeWidget(child->widget());  // Remove from layout
-        }
-        delete child;  // Free the QLayoutItem memory
-    }
+    // Surfaces stay alive in the stack; only the empty page is brought up.
+    m_surfaceStack->setCurrentWidget(m_emptySurface);
 
     // Reset the rendering type to None
     m_renderingType = mApp::Rendering_None;
@@ -366,23 +665,23 @@ void MediaPlayer::showWidget(QWidget* widget)
 {
     showNoneWidget();  // Clean any existing widgets
 
-    if (widget) {
-        m_vLayoutMediaPlayer->addWidget(widget);
-        widget->show();
-    }
+    // Fullscreen only makes sense while video is shown.
+    if (widget != m_videoWidget)
+        unsetFullScreen();
 
-    mainUi->tabMediaPlayer->update();
-    m_vLayoutMediaPlayer->update();
+    m_surfaceStack->setCurrentWidget(widget ? widget : m_emptySurface);
 }
 
 void MediaPlayer::showImageWidget()
 {
+    // Images have no audio; hiding the spectrum panel also releases the PCM tap.
+    m_spectrumWidget->hide();
     showWidget(m_imageLabel);  // Show image widget
 }
 
 void MediaPlayer::showAudioWidget()
 {
-    showWidget(nullptr);  // Placeholder for audio widget (you can add audio-specific widget if needed)
+    showWidget(m_waveformWidget);
 }
 
 void MediaPlayer::showVideoWidget()
@@ -390,38 +689,229 @@ void MediaPlayer::showVideoWidget()
     showWidget(m_videoWidget);
 }
 
+void MediaPlayer::showWidgetForFile(const QString &filePath, mApp::RenderType type)
+{
+    if (type == mApp::Rendering_Audio) {
+        m_waveformWidget->openFile(filePath);
+        showAudioWidget();
+        m_loadLatencyProbe->contentReady();
+    } else {
+        m_waveformWidget->clear();
+        showVideoWidget();
+    }
+}
+
 //------------------------------------------
 
 void MediaPlayer::loadMedia()
 {
-    QString filePath = QFileDialog::getOpenFileName(
+    const QStringList filePaths = QFileDialog::getOpenFileNames(
         m_mainWindow,
         tr("Load Media"),
         QStandardPaths::writableLocation(QStandardPaths::HomeLocation),
-        tr("Media Files (*.png *.jpg *.jpeg *.bmp *.mp3 *.wav *.mp4 *.avi *.mkv);;Images (*.png *.jpg *.jpeg *.bmp);;Audio (*.mp3 *.wav);;Video (*.mp4 *.avi *.mkv)")
+        tr("Media Files (*.png *.jpg *.jpeg *.bmp *.gif *.webp *.tif *.tiff *.svg *.heic *.avif "
+           "*.mp3 *.wav *.flac *.ogg *.opus *.m4a *.aac *.aiff *.wma "
+           "*.mp4 *.m4v *.mov *.avi *.mkv *.webm *.flv *.wmv *.ts *.mpg);;"
+           "Images (*.png *.jpg *.jpeg *.bmp *.gif *.webp *.tif *.tiff *.svg *.heic *.avif);;"
+           "Audio (*.mp3 *.wav *.flac *.ogg *.opus *.m4a *.aac *.aiff *.wma);;"
+           "Video (*.mp4 *.m4v *.mov *.avi *.mkv *.webm *.flv *.wmv *.ts *.mpg);;"
+           "All Files (*)")
         );
 
-    if (filePath.isEmpty()) {
+    if (filePaths.isEmpty()) {
         qDebug() << "Load operation cancelled.";
         return;
     }
 
-    QFileInfo fileInfo(filePath);
-    QString fileSuffix = fileInfo.suffix().toLower();
+    openFiles(filePaths);
+}
 
-    if (fileSuffix == "png" || fileSuffix == "jpg" || fileSuffix == "jpeg" || fileSuffix == "bmp") {
-        loadImage(filePath);
-    } else if (fileSuffix == "mp3" || fileSuffix == "wav") {
-        playMedia(filePath);
-        m_renderingType = mApp::Rendering_Audio;
-    } else if(fileSuffix == "mp4" || fileSuffix == "avi" || fileSuffix == "mkv") {
-        playMedia(filePath);
-        m_renderingType = mApp::Rendering_Video;
+void MediaPlayer::openFiles(const QStringList &filePaths)
+{
+    if (filePaths.isEmpty())
+        return;
+
+    // Several audio/video files are queued and played back to back.
+    QStringList playlistItems;
+    QHash<QString, mApp::RenderType> types;
+    for (const QString& filePath : filePaths) {
+        const mApp::RenderType type = renderTypeForFile(filePath);
+        types.insert(filePath, type);
+        if (type == mApp::Rendering_Audio || type == mApp::Rendering_Video)
+            playlistItems << filePath;
+    }
+
+    if (playlistItems.size() > 1) {
+        m_playlist.setItems(playlistItems);
+        openFile(m_playlist.currentItem(), types.value(m_playlist.currentItem()));
     } else {
+        m_playlist.clear();
+        openFile(filePaths.first(), types.value(filePaths.first()));
+    }
+}
+
+void MediaPlayer::openFile(const QString &filePath)
+{
+    openFile(filePath, renderTypeForFile(filePath));
+}
+
+void MediaPlayer::openFile(const QString &filePath, mApp::RenderType type)
+{
+    m_loadLatencyProbe->start(type);
+
+    // A slower image decode must not replace what is opened after it.
+    if (type != mApp::Rendering_Image) {
+        m_pendingImagePath.clear();
+        m_imageDecoder->cancel();
+    }
+
+    switch (type) {
+    case mApp::Rendering_Image:
+        loadImage(filePath);
+        break;
+    case mApp::Rendering_Audio:
+    case mApp::Rendering_Video:
+        playMedia(filePath, type);
+        m_renderingType = type;
+        break;
+    default:
         stopMediaPlayer();
         m_renderingType = mApp::Rendering_None;
         qDebug() << "Unsupported file type.";
+        break;
+    }
+}
+
+mApp::RenderType MediaPlayer::renderTypeForFile(const QString &filePath) const
+{
+    // A probed library entry knows whether the file really carries video, as long as it is unchanged.
+    const MediaInfo info = m_mediaLibrary->mediaInfo(filePath);
+    if (info.probed) {
+        const QFileInfo fileInfo(filePath);
+        if (info.size == fileInfo.size() && info.modifiedMs == fileInfo.lastModified().toMSecsSinceEpoch())
+            return info.hasVideo ? mApp::Rendering_Video : mApp::Rendering_Audio;
+    }
+
+    // Content decides, not the suffix: only the file header is mapped.
+    switch (MediaSniffer::sniffFile(filePath).kind) {
+    case MediaSniffer::Kind_Image:
+        return mApp::Rendering_Image;
+    case MediaSniffer::Kind_Audio:
+        return mApp::Rendering_Audio;
+    case MediaSniffer::Kind_Video:
+        return mApp::Rendering_Video;
+    default:
+        break;
+    }
+
+    // Image formats without a signature of their own, as the image plugins see them.
+    if (!QImageReader::imageFormat(filePath).isEmpty())
+        return mApp::Rendering_Image;
+    return mApp::Rendering_None;
+}
+
+void MediaPlayer::addLibraryFolder()
+{
+    const QString folderPath = QFileDialog::getExistingDirectory(
+        m_mainWindow,
+        tr("Add Library Folder"),
+        QStandardPaths::writableLocation(QStandardPaths::MusicLocation));
+
+    if (folderPath.isEmpty())
+        return;
+
+    m_mediaLibrary->addFolder(folderPath);
+    qDebug() << Q_FUNC_INFO << "Library folder added:" << folderPath;
+}
+
+void MediaPlayer::showScrubPreview(int positionMs)
+{
+    // Only what is already in the cache is shown, a missing tile is skipped.
+    const QImage thumbnail = m_thumbnailCache->thumbnailAt(positionMs);
+    if (thumbnail.isNull()) {
+        m_scrubPreview->hide();
+        return;
     }
+
+    QSlider* slider = mainUi->sliderMediaPlayback;
+    m_scrubPreview->setPixmap(QPixmap::fromImage(thumbnail));
+    m_scrubPreview->adjustSize();
+
+    const int handleX = QStyle::sliderPositionFromValue(slider->minimum(), slider->maximum(), positionMs, slider->width());
+    const QPoint anchor = slider->mapToGlobal(QPoint(handleX, 0));
+    m_scrubPreview->move(anchor.x() - m_scrubPreview->width() / 2, anchor.y() - m_scrubPreview->height() - 4);
+    m_scrubPreview->show();
+}
+
+void MediaPlayer::hideScrubPreview()
+{
+    m_scrubPreview->hide();
+}
+
+void MediaPlayer::showMediaInfo(const QString &filePath)
+{
+    // Library metadata is available before the backend has probed the file itself.
+    const MediaInfo info = m_mediaLibrary->mediaInfo(filePath);
+    if (!info.probed)
+        return;
+
+    if (m_mediaPlayer->duration() <= 0)
+        m_statusRefresher->setPlayerDuration(info.durationMs);
+
+    if (mainUi->comboBoxAudioSelector->count() <= 1 && info.audioLanguages.size() > 1) {
+        mainUi->comboBoxAudioSelector->clear();
+        for (const QString& language : info.audioLanguages)
+            mainUi->comboBoxAudioSelector->addItem(language.isEmpty() ? QString("Unknown Language") : language);
+        mainUi->comboBoxAudioSelector->setEnabled(true);
+        mainUi->comboBoxAudioSelector->setVisible(true);
+    }
+
+    mainUi->pushButtonAudioCodec->setText(info.hasVideo ? info.videoCodec : info.audioCodec);
+
+    QStringList details;
+    if (!info.title.isEmpty())
+        details << tr("Title: %1").arg(info.title);
+    if (!info.artist.isEmpty())
+        details << tr("Artist: %1").arg(info.artist);
+    if (!info.album.isEmpty())
+        details << tr("Album: %1").arg(info.album);
+    if (info.hasVideo)
+        details << tr("Video: %1 %2x%3").arg(info.videoCodec).arg(info.resolution.width()).arg(info.resolution.height());
+    details << tr("Audio: %1").arg(info.audioCodec);
+    details << tr("Duration: %1").arg(formatTime(info.durationMs));
+    mainUi->pushButtonAudioCodec->setToolTip(details.join('\n'));
+}
+
+void MediaPlayer::updateSpeedButton()
+{
+    const double rate = m_speedController->rate();
+    QString text = QString("%1x").arg(rate, 0, 'f', 2);
+    QString toolTip = tr("Playback speed: [ slower, ] faster, \\ normal");
+
+    if (m_speedController->isStretching()) {
+        const double load = m_speedController->dspLoad() * 100.0;
+        text += QString(" (%1%)").arg(load, 0, 'f', 1);
+        toolTip += '\n' + tr("Pitch-preserving time-stretch: %1% CPU, %2 underruns, %3 ms dropped")
+                               .arg(load, 0, 'f', 2).arg(m_speedController->underruns())
+                               .arg(m_speedController->droppedMs());
+    }
+
+    mainUi->pushButtonPlaybackSpeed->setText(text);
+    mainUi->pushButtonPlaybackSpeed->setToolTip(toolTip);
+}
+
+void MediaPlayer::exportPlaybackStats()
+{
+    const QString defaultPath = QDir(QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation))
+                                    .filePath(QString("miniMedia-stats-%1.csv")
+                                                  .arg(QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss")));
+    const QString filePath = QFileDialog::getSaveFileName(
+        m_mainWindow, tr("Export Playback Stats"), defaultPath, tr("CSV (*.csv)"));
+
+    if (filePath.isEmpty())
+        return;
+
+    m_playbackStats->exportTo(filePath);
 }
 
 // ------------------------------------------------------------------------
@@ -440,14 +930,13 @@ void MediaPlayer::setMediaPlayerNoMediaStateInternal()
     mainUi->pushButtonMediaRestart->setDisabled(true);
     mainUi->pushButtonSound->setDisabled(true);
     mainUi->pushButtonFullScreen->setDisabled(true);
+    mainUi->pushButtonPlaybackSpeed->setDisabled(true);
 
     mainUi->pushButtonToggleMedia->setIcon(QIcon(":/resource/playMedia.svg"));
     //     // Clear all existing widgets in the layout
 
-    m_imageLabel->hide();
-    m_vLayoutMediaPlayer->removeWidget(m_imageLabel);
-    m_videoWidget->hide();
-    m_vLayoutMediaPlayer->removeWidget(m_videoWidget);
+    m_surfaceStack->setCurrentWidget(m_emptySurface);
+    m_spectrumWidget->hide();   // releases the PCM tap
 
 
     mainUi->comboBoxAudioSelector->setEnabled(false);
@@ -461,12 +950,14 @@ void MediaPlayer::setMediaPlayerLoadedImageState()
     mainUi->sliderMediaPlayback->setDisabled(true);
     mainUi->sliderMediaPlayerVolume->setDisabled(true);
 
-    mainUi->pushButtonMediaPrev->setDisabled(true);
+    // Previous/next browse the image's folder.
+    mainUi->pushButtonMediaPrev->setDisabled(!m_folderImages.hasPrevious());
     mainUi->pushButtonToggleMedia->setDisabled(true);
-    mainUi->pushButtonMediaNext->setDisabled(true);
+    mainUi->pushButtonMediaNext->setDisabled(!m_folderImages.hasNext());
     mainUi->pushButtonMediaRestart->setDisabled(true);
     mainUi->pushButtonSound->setDisabled(true);
     mainUi->pushButtonFullScreen->setDisabled(true);
+    mainUi->pushButtonPlaybackSpeed->setDisabled(true);
 
     hideCodecButton();
 
@@ -484,7 +975,7 @@ void MediaPlayer::setMediaPlayerPlayingState()
     mainUi->pushButtonToggleMedia->setDisabled(false);
     mainUi->pushButtonMediaNext->setDisabled(false);
     mainUi->pushButtonFullScreen->setDisabled(false);
-
+    mainUi->pushButtonPlaybackSpeed->setDisabled(false);
 
     showCodecButton();
 
@@ -499,6 +990,11 @@ void MediaPlayer::setMediaPlayerPausedState()
 
 void MediaPlayer::handleNextPressed()
 {
+    if (m_renderingType == mApp::Rendering_Image) {
+        showFolderImage(1);
+        return;
+    }
+
     if (m_mediaPlayer->playbackState() == QMediaPlayer::PlayingState ||
         m_mediaPlayer->playbackState() == QMediaPlayer::PausedState) {
 
@@ -508,6 +1004,11 @@ void MediaPlayer::handleNextPressed()
 }
 void MediaPlayer::handlePrevPressed()
 {
+    if (m_renderingType == mApp::Rendering_Image) {
+        showFolderImage(-1);
+        return;
+    }
+
     if (m_mediaPlayer->playbackState() == QMediaPlayer::PlayingState ||
         m_mediaPlayer->playbackState() == QMediaPlayer::PausedState) {
 
@@ -519,7 +1020,11 @@ void MediaPlayer::handleRestartPressed()
 {
     if (m_mediaPlayer->playbackState() == QMediaPlayer::PlayingState ||
         m_mediaPlayer->playbackState() == QMediaPlayer::PausedState) {
-        mainUi->sliderMediaPlayback->setValue(mainUi->sliderMediaPlayback->minimum());
+        // While A-B looping, restart goes back to the start of the loop.
+        if (m_loopController->isLooping())
+            mainUi->sliderMediaPlayback->setValue(static_cast<int>(m_loopController->loopStart()));
+        else
+            mainUi->sliderMediaPlayback->setValue(mainUi->sliderMediaPlayback->minimum());
     } else {
         qDebug() << Q_FUNC_INFO << "Cant restart";
     }
@@ -617,25 +1122,21 @@ void MediaPlayer::handlePlaybackSlider(int valParam)
         return;
     }
 
-    const qint64 length = m_mediaPlayer->duration();
-    if (length > 0) {
-        // Calculate the media position based on slider value
-        qint64 newPosition = (length * valParam) / 100;
-        m_mediaPlayer->setPosition(newPosition);
-
-        qDebug() << Q_FUNC_INFO << "Slider moved to" << valParam << "%, setting media position to" << newPosition;
-    }
+    // The timeline is in milliseconds, the slider value is the target position.
+    if (m_mediaPlayer->duration() > 0)
+        m_seekScheduler->requestSeek(valParam);
 }
 
 void MediaPlayer::handleVolumeSlider(int valParam)
 {
-    if (!m_mediaPlayer || !m_mediaPlayer->audioOutput()) {
+    // The output stays detached from the player while the speed controller stretches audio.
+    if (!m_mediaPlayer || !m_audioOutput) {
         qWarning() << Q_FUNC_INFO << "Media player or audio output unavailable!";
         return;
     }
 
     const float updatedNormalizedVolume = valParam / 100.0f;
-    m_mediaPlayer->audioOutput()->setVolume(updatedNormalizedVolume);
+    m_audioOutput->setVolume(updatedNormalizedVolume);
 
     mainUi->labelMediaVolume->setText(QString::number(valParam) + "%");
 
@@ -652,37 +1153,33 @@ void MediaPlayer::handleNextAudioTrack()
         const int nextIndex = (currentIndex + 1) % mainUi->comboBoxAudioSelector->count();
         mainUi->comboBoxAudioSelector->setCurrentIndex(nextIndex);
         m_mediaPlayer->setActiveAudioTrack(nextIndex);
+        if (m_standbyPath == m_currentFilePath)
+            m_standbyPlayer->setActiveAudioTrack(nextIndex);
         qDebug() << Q_FUNC_INFO << "Current audio track:" << mainUi->comboBoxAudioSelector->itemText(nextIndex);
     }
 }
 
 void MediaPlayer::setFullScreen()
 {
-    mainUi->controllerWidgetContainer->hide();
-    m_mainWindow->showFullScreen();
-
-    QWidget *currentCentralWidget = m_mainWindow->centralWidget();
-    if (currentCentralWidget) {
-        currentCentralWidget->setParent(nullptr);
-    }
-
-    m_videoWidget->setParent(nullptr);
-    m_mainWindow->setCentralWidget(m_videoWidget);
+    // Nothing is reparented: the windowed surface and the sink stay as they are
+    // and the pre-created fullscreen surface shows the same frames.
+    m_fullscreenSurface->enter(m_mainWindow->screen());
+    m_statsOverlay->setAnchor(m_fullscreenSurface);
 }
 
 void MediaPlayer::unsetFullScreen()
 {
-    mainUi->controllerWidgetContainer->show();
+    if (!isVideoFullScreen())
+        return;
 
-    QWidget *currentCentralWidget = m_mainWindow->centralWidget();
-    if (currentCentralWidget) {
-        currentCentralWidget->setParent(nullptr);
-    }
+    m_fullscreenSurface->leave();
+    m_statsOverlay->setAnchor(m_videoWidget);
+    m_mainWindow->activateWindow();
+}
 
-    m_mainWindow->setCentralWidget(mainUi->centralwidget);
-    m_videoWidget->setParent(m_mainWindow);
-    m_vLayoutMediaPlayer->addWidget(m_videoWidget);
-    m_mainWindow->showNormal();
+bool MediaPlayer::isVideoFullScreen() const
+{
+    return m_fullscreenSurface && m_fullscreenSurface->isActive();
 }
 
 void MediaPlayer::hideCodecButton()
@@ -703,20 +1200,257 @@ void MediaPlayer::goFullScreenVideo(QKeyEvent* event) {
     if (m_renderingType != mApp::Rendering_Video)
         return;
 
-    if (!m_mainWindow->isFullScreen() && event->key() == Qt::Key_F)
+    if (!isVideoFullScreen() && event->key() == Qt::Key_F)
         setFullScreen();
-    else if(m_mainWindow->isFullScreen() && (event->key() == Qt::Key_Escape || event->key() == Qt::Key_F))
+    else if(isVideoFullScreen() && (event->key() == Qt::Key_Escape || event->key() == Qt::Key_F))
         unsetFullScreen();
 }
 
 
 QString MediaPlayer::formatTime(qint64 ms) const
 {
-    const qint64 sec = (ms / 1000) % 60;
-    const qint64 min = (ms / (1000 * 60)) % 60;
-    const qint64 hr = ms / (1000 * 60 * 60);
+    return StatusRefresher::formatTime(ms);
+}
+
+// ------------------------------------------------------------------------
+void MediaPlayer::connectPlayerSlots()
+{
+    // Only the active player drives the UI; connections move with it on a switch.
+    for (const QMetaObject::Connection& connection : std::as_const(m_playerConnections))
+        disconnect(connection);
+    m_playerConnections.clear();
+
+    // Duration changed handler; labels are refreshed once per frame by m_statusRefresher
+    m_playerConnections << connect(m_mediaPlayer, &QMediaPlayer::durationChanged, this, [this](qint64 duration) {
+        m_statusRefresher->setPlayerDuration(duration);
+        setPlaybackRange(duration);
+    });
+
+    m_playerConnections << connect(m_mediaPlayer, &QMediaPlayer::mediaStatusChanged, this, [this](QMediaPlayer::MediaStatus status) {
+        m_statusRefresher->setPlayerDuration(m_mediaPlayer->duration());
+
+        if (status == QMediaPlayer::BufferedMedia)
+            prerollNextItem();
+        else if (status == QMediaPlayer::EndOfMedia && m_loopController->isLooping())
+            wrapLoop();
+        else if (status == QMediaPlayer::EndOfMedia && m_playlist.hasNext())
+            switchToPrerolledItem();
+    });
+
+    // Position changed handler
+    m_playerConnections << connect(m_mediaPlayer, &QMediaPlayer::positionChanged, m_statusRefresher, &StatusRefresher::setPlayerPosition);
+    m_playerConnections << connect(m_mediaPlayer, &QMediaPlayer::positionChanged, m_waveformWidget, &WaveformWidget::setPositionMs);
+    m_playerConnections << connect(m_mediaPlayer, &QMediaPlayer::positionChanged, m_loopController, &LoopController::updatePosition);
+    m_playerConnections << connect(m_mediaPlayer, &QMediaPlayer::durationChanged, m_waveformWidget, &WaveformWidget::setDurationMs);
+}
+
+void MediaPlayer::setPlaybackRange(qint64 durationMs)
+{
+    // Millisecond timeline; changing the range must not trigger a seek.
+    const QSignalBlocker blocker(mainUi->sliderMediaPlayback);
+    mainUi->sliderMediaPlayback->setRange(0, static_cast<int>(qMin<qint64>(durationMs, INT_MAX)));
+    mainUi->sliderMediaPlayback->setSingleStep(mApp::PLAYBACK_SEEK_STEP_MS);
+    mainUi->sliderMediaPlayback->setPageStep(mApp::PLAYBACK_PAGE_STEP_MS);
+}
+
+void MediaPlayer::refreshAudioTracks()
+{
+    mainUi->comboBoxAudioSelector->clear();
+    QList<QMediaMetaData> audiosAvailable = m_mediaPlayer->audioTracks();
+
+    if(audiosAvailable.length() > 1) {
+        for (const QMediaMetaData &audioMetaData : audiosAvailable) {
+            QString language = audioMetaData.value(QMediaMetaData::Language).toString();
+            if (language.isEmpty()) {
+                language = "Unknown Language";
+            }
+            qDebug() << Q_FUNC_INFO << "Audio Track Language:" << language;
+            mainUi->comboBoxAudioSelector->addItem(language);
+        }
+    }
+
+    bool hasComboBox = mainUi->comboBoxAudioSelector->count() > 1;
+    mainUi->comboBoxAudioSelector->setEnabled(hasComboBox);
+    mainUi->comboBoxAudioSelector->setVisible(hasComboBox);
+}
+
+void MediaPlayer::prerollNextItem()
+{
+    const QString nextPath = m_playlist.nextItem();
+    if (nextPath.isEmpty() || nextPath == m_standbyPath || m_loopController->isLooping())
+        return;
+
+    // Open, probe and buffer the next item now so the switch only has to start it.
+    m_standbyPath = nextPath;
+    m_standbyPlayer->setSource(QUrl::fromLocalFile(nextPath));
+    m_standbyPlayer->pause();
 
-    return QTime(hr, min, sec).toString();
+    qDebug() << Q_FUNC_INFO << "Pre-rolling next playlist item:" << nextPath;
 }
 
+void MediaPlayer::switchToPrerolledItem()
+{
+    if (!m_playlist.advance())
+        return;
 
+    const QString filePath = m_playlist.currentItem();
+    if (m_standbyPath != filePath) {
+        // Nothing pre-rolled (e.g. the item was too short): fall back to a normal open.
+        openFile(filePath);
+        return;
+    }
+
+    m_switchClock.start();
+
+    activateStandbyPlayer();
+
+    if (!m_mediaPlayer->hasVideo()) {
+        qInfo() << Q_FUNC_INFO << "Playlist switch latency:" << m_switchClock.nsecsElapsed() / 1000 << "us";
+        m_switchClock.invalidate();
+    }
+
+    m_seekScheduler->setKeyframeIndex(KeyframeIndex());
+    m_keyframeIndexer->indexFile(filePath);
+    m_thumbnailCache->open(filePath);
+
+    // Video to video keeps the surface; anything else swaps the shown widget.
+    const mApp::RenderType nextType = renderTypeForFile(filePath);
+    if (nextType != mApp::Rendering_Video || m_renderingType != mApp::Rendering_Video)
+        showWidgetForFile(filePath, nextType);
+    m_waveformWidget->setDurationMs(m_mediaPlayer->duration());
+
+    m_statusRefresher->setPlayerDuration(m_mediaPlayer->duration());
+    m_statusRefresher->setPlayerPosition(m_mediaPlayer->position());
+    m_renderingType = nextType;
+
+    m_currentFilePath = filePath;
+    showMediaInfo(filePath);
+
+    resetStandbyPlayer();
+    prerollNextItem();
+
+    qDebug() << Q_FUNC_INFO << "Switched to playlist item" << m_playlist.currentIndex() << filePath;
+}
+
+void MediaPlayer::activateStandbyPlayer(bool sameStream)
+{
+    QMediaPlayer* finishedPlayer = m_mediaPlayer;
+    std::swap(m_mediaPlayer, m_standbyPlayer);
+    std::swap(m_audioOutput, m_standbyAudioOutput);
+
+    m_audioOutput->setVolume(m_standbyAudioOutput->volume());
+    m_audioOutput->setMuted(m_standbyAudioOutput->isMuted());
+
+    // Speed and the PCM tap follow the active player before it starts.
+    m_audioTap->setPlayer(m_mediaPlayer);
+    if (sameStream) {
+        // A loop pass: the language picked since the standby was primed carries over too.
+        if (m_mediaPlayer->activeAudioTrack() != finishedPlayer->activeAudioTrack())
+            m_mediaPlayer->setActiveAudioTrack(finishedPlayer->activeAudioTrack());
+        m_speedController->handOver(m_mediaPlayer, m_audioOutput);
+    } else {
+        m_speedController->setPlayer(m_mediaPlayer, m_audioOutput);
+    }
+
+    // The video widget keeps its surface, only the player feeding it changes.
+    m_mediaPlayer->setVideoOutput(m_videoWidget);
+    m_mediaPlayer->play();
+    if (finishedPlayer->isPlaying())
+        finishedPlayer->pause();
+    finishedPlayer->setVideoOutput(nullptr);
+
+    connectPlayerSlots();
+    m_seekScheduler->setPlayer(m_mediaPlayer, sameStream);
+    m_playbackStats->setPlayer(m_mediaPlayer);
+
+    // The standby player reported its duration and tracks during pre-roll, before it was connected.
+    // Another pass of the same file has the same ones.
+    if (!sameStream) {
+        setPlaybackRange(m_mediaPlayer->duration());
+        refreshAudioTracks();
+    }
+}
+
+void MediaPlayer::primeLoopStandby()
+{
+    if (m_currentFilePath.isEmpty())
+        return;
+
+    // The standby pipeline waits paused at A, so a wrap only has to start it.
+    if (m_standbyPath != m_currentFilePath) {
+        m_standbyPath = m_currentFilePath;
+        m_standbyPlayer->setSource(QUrl::fromLocalFile(m_currentFilePath));
+    }
+    m_standbyPlayer->pause();
+    m_standbyPlayer->setPosition(m_loopController->loopStart());
+
+    // The next pass plays with the language and speed of this one.
+    m_standbyPlayer->setActiveAudioTrack(m_mediaPlayer->activeAudioTrack());
+    m_standbyPlayer->setPlaybackRate(m_mediaPlayer->playbackRate());
+}
+
+bool MediaPlayer::isLoopStandbyReady() const
+{
+    const QMediaPlayer::MediaStatus status = m_standbyPlayer->mediaStatus();
+    return m_standbyPath == m_currentFilePath
+           && (status == QMediaPlayer::LoadedMedia || status == QMediaPlayer::BufferedMedia)
+           && qAbs(m_standbyPlayer->position() - m_loopController->loopStart()) <= mApp::LOOP_STANDBY_TOLERANCE_MS;
+}
+
+void MediaPlayer::wrapLoop()
+{
+    if (!m_loopController->isLooping() || m_mediaPlayer->playbackState() == QMediaPlayer::PausedState)
+        return;
+
+    QElapsedTimer wrapClock;
+    wrapClock.start();
+    const qint64 overshootMs = m_mediaPlayer->position() - m_loopController->loopEnd();
+
+    if (!isLoopStandbyReady()) {
+        // Standby not parked yet (loop just set): a plain seek, with its re-buffer.
+        m_mediaPlayer->setPosition(m_loopController->loopStart());
+        if (m_mediaPlayer->playbackState() != QMediaPlayer::PlayingState)
+            m_mediaPlayer->play();
+        m_loopController->wrapped();
+        primeLoopStandby();
+        qDebug() << Q_FUNC_INFO << "Loop wrapped by seek, standby not ready";
+        return;
+    }
+
+    // Swap to the parked pipeline; the pass that just ended is parked at A for the next wrap.
+    activateStandbyPlayer(true);
+    m_loopController->wrapped();
+    primeLoopStandby();
+
+    qDebug() << Q_FUNC_INFO << "Loop wrap" << m_loopController->wrapCount()
+             << "overshoot:" << overshootMs << "ms, switch:" << wrapClock.nsecsElapsed() / 1000 << "us";
+}
+
+void MediaPlayer::resetStandbyPlayer()
+{
+    m_standbyPath.clear();
+    m_standbyPlayer->stop();
+    m_standbyPlayer->setSource(QUrl());
+}
+
+void MediaPlayer::playPlaylistNext()
+{
+    if (!m_playlist.hasNext())
+        return;
+
+    if (m_standbyPath == m_playlist.nextItem()) {
+        switchToPrerolledItem();
+        return;
+    }
+
+    m_playlist.advance();
+    openFile(m_playlist.currentItem());
+}
+
+void MediaPlayer::playPlaylistPrevious()
+{
+    if (!m_playlist.goBack())
+        return;
+
+    openFile(m_playlist.currentItem());
+}
@@ -9,6 +9,9 @@
 #include <QLabel>
 #include <QLayout>
 #include <QPushButton>
+#include <QElapsedTimer>
+
+#include "src/media/playlist.h"
 
 
 namespace mApp{
@@ -18,6 +21,9 @@ enum RenderType {
     Rendering_Audio,
     Rendering_Video
 };
+const int PLAYBACK_SEEK_STEP_MS = 5000;   // Left/Right arrow jump
+const int PLAYBACK_PAGE_STEP_MS = 30000;  // PageUp/PageDown on the timeline
+const qint64 LOOP_STANDBY_TOLERANCE_MS = 100; // standby counts as parked at A within this
 }
 
 class MainWindow;
@@ -26,6 +32,25 @@ class MainWindow;
 }
 
 class ImageCropper;
+class SeekScheduler;
+class StatusRefresher;
+class KeyframeIndexer;
+class MediaLibrary;
+class ThumbnailCache;
+class WaveformWidget;
+class SpectrumWidget;
+class AudioTap;
+class SpeedController;
+class LoopController;
+class LoopMarkerOverlay;
+class PlaybackStats;
+class StatsOverlay;
+class FullscreenSurface;
+class LoadLatencyProbe;
+class ImageDecoder;
+class ImagePrefetcher;
+class ImageInfoOverlay;
+class QStackedWidget;
 
 class MediaPlayer : public QObject
 {
@@ -36,11 +61,14 @@ public:
 
 
     void buttonHandler(QKeyEvent* event);
+    void buttonReleaseHandler(QKeyEvent* event);
 
     void setMediaPlayerNoMediaState() {
         setMediaPlayerNoMediaStateInternal();
     }
     void goFullScreenVideo(QKeyEvent*);
+    // Opens and plays files given outside the load dialog (command line, another instance).
+    void openFiles(const QStringList& filePaths);
     // Utility function for formatting time
     QString formatTime(qint64 ms) const;
 signals:
@@ -48,7 +76,7 @@ signals:
 protected:
 
 private:
-    void playMedia(const QString& filePath);
+    void playMedia(const QString& filePath, mApp::RenderType type);
     void pauseMediaPlayer();
     void resumeMediaPlayer();
     void stopMediaPlayer();
@@ -59,10 +87,44 @@ private:
     void showImageWidget();
     void showAudioWidget();
     void showVideoWidget();
+    void showWidgetForFile(const QString& filePath, mApp::RenderType type);
 
     void loadMedia();
+    void openFile(const QString& filePath);
+    void openFile(const QString& filePath, mApp::RenderType type);
+    // Sniffs the file; call once per open and pass the result on.
+    mApp::RenderType renderTypeForFile(const QString& filePath) const;
 
     void loadImage(const QString &filePath);
+    void showDecodedImage(const QPixmap& pixmap, bool preview);
+    QSize imageTargetSize() const;
+    void setImageZoomSource(const QString& filePath, const QSize& sourceSize);
+    void updateFolderImages(const QString& filePath);
+    void showFolderImage(int step);
+    void prefetchFolderNeighbours();
+
+    void addLibraryFolder();
+    void showScrubPreview(int positionMs);
+    void hideScrubPreview();
+    void showMediaInfo(const QString& filePath);
+    void updateSpeedButton();
+    void exportPlaybackStats();
+
+    void primeLoopStandby();
+    bool isLoopStandbyReady() const;
+    void wrapLoop();
+
+    //------------------------- Playlist (gapless) -----------------------------
+    void connectPlayerSlots();
+    void setPlaybackRange(qint64 durationMs);
+    void refreshAudioTracks();
+    void prerollNextItem();
+    void switchToPrerolledItem();
+    // sameStream: the standby holds another pass of the current file (A-B loop).
+    void activateStandbyPlayer(bool sameStream = false);
+    void resetStandbyPlayer();
+    void playPlaylistNext();
+    void playPlaylistPrevious();
 
     //------------------------- Media Player State------------------------------
     void setMediaPlayerNoMediaStateInternal();
@@ -84,6 +146,7 @@ private:
 
     void setFullScreen();
     void unsetFullScreen();
+    bool isVideoFullScreen() const;
 
     void hideCodecButton();
     void showCodecButton();
@@ -92,12 +155,49 @@ private:
     void connectSlots();
 
     QLayout* m_vLayoutMediaPlayer = nullptr;
+    // Image, waveform and video surfaces are created once and only switched.
+    QStackedWidget* m_surfaceStack = nullptr;
+    QWidget* m_emptySurface = nullptr;
+    LoadLatencyProbe* m_loadLatencyProbe = nullptr;
+    ImageDecoder* m_imageDecoder = nullptr;
+    QString m_pendingImagePath;
+    ImageInfoOverlay* m_imageInfo = nullptr;   // toggled with I
+    int m_imageOrientation = 1;                // EXIF orientation of the shown image
+    // Images of the current image's folder, browsed with Left/Right and N/P.
+    ImagePrefetcher* m_imagePrefetcher = nullptr;
+    Playlist m_folderImages;
+    QString m_folderPath;
+    int m_folderDirection = 1;
 
     ImageCropper* m_imageLabel = nullptr;
     // QLabel* m_imageLabel = nullptr;
     QAudioOutput* m_audioOutput = nullptr;
     QVideoWidget* m_videoWidget = nullptr;
+    WaveformWidget* m_waveformWidget = nullptr;
+    SpectrumWidget* m_spectrumWidget = nullptr;
     QMediaPlayer* m_mediaPlayer = nullptr;
+    AudioTap* m_audioTap = nullptr;
+    SpeedController* m_speedController = nullptr;
+    LoopController* m_loopController = nullptr;
+    LoopMarkerOverlay* m_loopOverlay = nullptr;
+    PlaybackStats* m_playbackStats = nullptr;
+    StatsOverlay* m_statsOverlay = nullptr;
+    FullscreenSurface* m_fullscreenSurface = nullptr;
+
+    // Second pipeline holding the next playlist item opened and buffered.
+    QAudioOutput* m_standbyAudioOutput = nullptr;
+    QMediaPlayer* m_standbyPlayer = nullptr;
+    QString m_standbyPath;
+    Playlist m_playlist;
+    QList<QMetaObject::Connection> m_playerConnections;
+    QElapsedTimer m_switchClock;
+    SeekScheduler* m_seekScheduler = nullptr;
+    KeyframeIndexer* m_keyframeIndexer = nullptr;
+    MediaLibrary* m_mediaLibrary = nullptr;
+    ThumbnailCache* m_thumbnailCache = nullptr;
+    QLabel* m_scrubPreview = nullptr;
+    QString m_currentFilePath;
+    StatusRefresher* m_statusRefresher = nullptr;
 
 
     MainWindow* m_mainWindow;          // Store a pointer to MainWindow
@@ -105,7 +205,6 @@ private:
 
     mApp::RenderType m_renderingType = mApp::Rendering_None;
 
-    bool isFullscreen = false;
 };
 
 #endif // MEDIAPLAYER_H
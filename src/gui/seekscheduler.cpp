@@ -0,0 +1,233 @@
+#include "seekscheduler.h"
+
+#include <QDebug>
+#include <QMediaPlayer>
+#include <QTimer>
+#include <QVideoFrame>
+#include <QVideoSink>
+
+SeekScheduler::SeekScheduler(QMediaPlayer* player, QObject* parent)
+    : QObject(parent)
+    , m_throttleTimer(new QTimer(this))
+    , m_watchdogTimer(new QTimer(this))
+{
+    m_throttleTimer->setSingleShot(true);
+    m_watchdogTimer->setSingleShot(true);
+
+    connect(m_throttleTimer, &QTimer::timeout, this, &SeekScheduler::dispatchPending);
+    connect(m_watchdogTimer, &QTimer::timeout, this, &SeekScheduler::handleWatchdog);
+
+    setPlayer(player);
+}
+
+void SeekScheduler::setPlayer(QMediaPlayer *player, bool keepPending)
+{
+    if (m_player == player)
+        return;
+
+    if (m_player)
+        disconnect(m_player, nullptr, this, nullptr);
+
+    if (keepPending) {
+        // The old player's seek will not produce frames on the new one; the newest target still applies.
+        if (m_inFlight && m_pendingTarget < 0) {
+            m_pendingTarget = m_inFlightTarget;
+            m_pendingExact = m_inFlightExact;
+        }
+        m_watchdogTimer->stop();
+        m_inFlight = false;
+    } else {
+        reset();
+    }
+    m_player = player;
+
+    // Audio-only media has no frames, the first position update ends the seek.
+    connect(m_player, &QMediaPlayer::positionChanged, this, [this]() {
+        if (m_inFlight && !m_player->hasVideo())
+            finishSeek();
+    });
+
+    if (keepPending)
+        dispatchPending();
+}
+
+void SeekScheduler::setVideoSink(QVideoSink *sink)
+{
+    if (m_videoSink)
+        disconnect(m_videoSink, nullptr, this, nullptr);
+
+    m_videoSink = sink;
+
+    if (m_videoSink) {
+        connect(m_videoSink, &QVideoSink::videoFrameChanged, this, [this](const QVideoFrame& frame) {
+            // Past the watchdog any frame shows the backend is done with the seek.
+            if (m_inFlight && (m_inFlightTimedOut || isFrameAtTarget(frame)))
+                finishSeek();
+        });
+    }
+}
+
+void SeekScheduler::setKeyframeIndex(const KeyframeIndex &index)
+{
+    m_keyframeIndex = index;
+}
+
+void SeekScheduler::beginScrub()
+{
+    m_scrubbing = true;
+}
+
+void SeekScheduler::endScrub()
+{
+    if (!m_scrubbing)
+        return;
+
+    m_scrubbing = false;
+
+    // Replace whatever coarse target is left with one exact seek.
+    if (m_lastRequested >= 0)
+        requestSeek(m_lastRequested);
+}
+
+void SeekScheduler::requestSeek(qint64 positionMs)
+{
+    if (positionMs < 0)
+        positionMs = 0;
+
+    const bool backward = m_lastRequested >= 0 && positionMs < m_lastRequested;
+    m_lastRequested = positionMs;
+
+    if (m_pendingTarget >= 0)
+        ++m_droppedSeeks; // superseded before it was issued
+
+    m_pendingExact = !m_scrubbing;
+    m_pendingTarget = m_pendingExact ? positionMs : snapToScrubGrid(positionMs, backward);
+
+    dispatchPending();
+}
+
+void SeekScheduler::reset()
+{
+    m_throttleTimer->stop();
+    m_watchdogTimer->stop();
+
+    m_scrubbing = false;
+    m_inFlight = false;
+    m_inFlightTarget = -1;
+    m_pendingTarget = -1;
+    m_lastRequested = -1;
+}
+
+qint64 SeekScheduler::averageLatencyMs() const
+{
+    return m_completedSeeks > 0 ? m_totalLatencyMs / m_completedSeeks : 0;
+}
+
+void SeekScheduler::dispatchPending()
+{
+    if (m_inFlight || m_pendingTarget < 0)
+        return;
+
+    // Skip scrub seeks that land on the target already being shown.
+    if (!m_pendingExact && m_pendingTarget == m_inFlightTarget) {
+        m_pendingTarget = -1;
+        return;
+    }
+
+    if (!m_pendingExact && m_lastIssueClock.isValid()) {
+        const qint64 sinceLast = m_lastIssueClock.elapsed();
+        if (sinceLast < mApp::SEEK_SCRUB_INTERVAL_MS) {
+            if (!m_throttleTimer->isActive())
+                m_throttleTimer->start(static_cast<int>(mApp::SEEK_SCRUB_INTERVAL_MS - sinceLast));
+            return;
+        }
+    }
+
+    const qint64 target = m_pendingTarget;
+    const bool exact = m_pendingExact;
+    m_pendingTarget = -1;
+
+    issueSeek(target, exact);
+}
+
+void SeekScheduler::issueSeek(qint64 positionMs, bool exact)
+{
+    m_inFlight = true;
+    m_inFlightTimedOut = false;
+    m_inFlightExact = exact;
+    m_inFlightTarget = positionMs;
+
+    m_seekClock.start();
+    m_lastIssueClock.start();
+    m_watchdogTimer->start(mApp::SEEK_WATCHDOG_MS);
+
+    m_player->setPosition(positionMs);
+}
+
+void SeekScheduler::handleWatchdog()
+{
+    if (!m_inFlight)
+        return;
+
+    if (!m_inFlightTimedOut) {
+        // Still busy with this seek: keep it in flight, only its latency is lost.
+        qWarning() << Q_FUNC_INFO << "Seek to" << m_inFlightTarget << "ms produced no frame within"
+                   << mApp::SEEK_WATCHDOG_MS << "ms";
+        m_inFlightTimedOut = true;
+        m_watchdogTimer->start(mApp::SEEK_GIVE_UP_MS - mApp::SEEK_WATCHDOG_MS);
+        return;
+    }
+
+    qWarning() << Q_FUNC_INFO << "Giving up on seek to" << m_inFlightTarget << "ms after" << m_seekClock.elapsed() << "ms";
+    finishSeek();
+}
+
+void SeekScheduler::finishSeek()
+{
+    if (!m_inFlight)
+        return;
+
+    m_watchdogTimer->stop();
+    m_inFlight = false;
+
+    if (m_inFlightTimedOut) {
+        emit seekCompleted(m_inFlightTarget, -1);
+        dispatchPending();
+        return;
+    }
+
+    const qint64 latency = m_seekClock.elapsed();
+    m_lastLatencyMs = latency;
+    m_totalLatencyMs += latency;
+    ++m_completedSeeks;
+
+    if (m_inFlightExact) {
+        qDebug() << Q_FUNC_INFO << "Seek to" << m_inFlightTarget << "ms took" << latency
+                 << "ms (avg" << averageLatencyMs() << "ms, dropped" << m_droppedSeeks << ")";
+    }
+
+    emit seekCompleted(m_inFlightTarget, latency);
+
+    dispatchPending();
+}
+
+bool SeekScheduler::isFrameAtTarget(const QVideoFrame &frame) const
+{
+    // Frames decoded before the seek may still arrive after setPosition; they do not end it.
+    if (frame.startTime() < 0)
+        return true; // no timestamp, nothing to compare
+
+    const qint64 startUs = frame.startTime();
+    const qint64 frameUs = frame.endTime() > startUs ? frame.endTime() - startUs
+                                                      : mApp::SEEK_FALLBACK_FRAME_MS * 1000;
+    return qAbs(startUs - m_inFlightTarget * 1000) <= frameUs;
+}
+
+qint64 SeekScheduler::snapToScrubGrid(qint64 positionMs, bool backward) const
+{
+    // Dragging backwards must not show a frame past the handle.
+    if (!m_keyframeIndex.isEmpty())
+        return backward ? m_keyframeIndex.keyframeAtOrBefore(positionMs) : m_keyframeIndex.nearestKeyframe(positionMs);
+
+    return (positionMs / mApp::SEEK_SCRUB_GRID_MS) * mApp::SEEK_SCRUB_GRID_MS;
+}
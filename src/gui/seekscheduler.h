@@ -0,0 +1,92 @@
+#ifndef SEEKSCHEDULER_H
+#define SEEKSCHEDULER_H
+
+#include <QObject>
+#include <QElapsedTimer>
+
+#include "src/media/keyframeindex.h"
+
+class QMediaPlayer;
+class QVideoSink;
+class QTimer;
+class QVideoFrame;
+
+namespace mApp {
+const int SEEK_SCRUB_INTERVAL_MS = 50;   // minimum gap between two scrub seeks
+const int SEEK_WATCHDOG_MS = 750;        // a seek slower than this is not counted in the latency
+const int SEEK_GIVE_UP_MS = 5000;        // the next seek is issued even if the backend never answers
+const qint64 SEEK_SCRUB_GRID_MS = 250;   // scrub snap grid when no keyframe index is known
+const qint64 SEEK_FALLBACK_FRAME_MS = 40; // frame length assumed when a frame carries no end time
+}
+
+/*
+ * Keeps at most one seek in flight on a QMediaPlayer.
+ * New targets replace the pending one instead of queueing behind it, scrub
+ * seeks are throttled and snapped to the nearest keyframe (the one at or
+ * before the target when dragging backwards, or a coarse grid
+ * until the keyframe index is ready), and the final seek on release is exact.
+ * Seek latency is measured up to the first frame within one frame of the
+ * target (or position update for audio-only media) after the seek.
+ * A seek that outlives the watchdog stays in flight until the backend
+ * delivers any frame (or SEEK_GIVE_UP_MS passes), so a busy backend is
+ * not handed the next seek; it completes with a latency of -1.
+ */
+class SeekScheduler : public QObject
+{
+    Q_OBJECT
+public:
+    explicit SeekScheduler(QMediaPlayer* player, QObject* parent = nullptr);
+
+    // keepPending: another player of the same stream; an unfinished seek is issued again on it.
+    void setPlayer(QMediaPlayer* player, bool keepPending = false);
+    void setVideoSink(QVideoSink* sink);
+    void setKeyframeIndex(const KeyframeIndex& index);
+
+    void beginScrub();
+    void endScrub();
+    void requestSeek(qint64 positionMs);
+    void reset();
+
+    bool isScrubbing() const { return m_scrubbing; }
+    qint64 lastLatencyMs() const { return m_lastLatencyMs; }
+    qint64 averageLatencyMs() const;
+    int completedSeeks() const { return m_completedSeeks; }
+    int droppedSeeks() const { return m_droppedSeeks; }
+
+signals:
+    void seekCompleted(qint64 positionMs, qint64 latencyMs);
+
+private:
+    void dispatchPending();
+    void issueSeek(qint64 positionMs, bool exact);
+    void handleWatchdog();
+    void finishSeek();
+    bool isFrameAtTarget(const QVideoFrame& frame) const;
+    qint64 snapToScrubGrid(qint64 positionMs, bool backward) const;
+
+    QMediaPlayer* m_player = nullptr;
+    QVideoSink* m_videoSink = nullptr;
+    KeyframeIndex m_keyframeIndex;
+    QTimer* m_throttleTimer = nullptr;
+    QTimer* m_watchdogTimer = nullptr;
+
+    QElapsedTimer m_seekClock;      // started when the in-flight seek was issued
+    QElapsedTimer m_lastIssueClock; // used for throttling scrub seeks
+
+    bool m_scrubbing = false;
+    bool m_inFlight = false;
+    bool m_inFlightExact = false;
+    bool m_inFlightTimedOut = false;
+    qint64 m_inFlightTarget = -1;
+
+    qint64 m_pendingTarget = -1;
+    bool m_pendingExact = false;
+    qint64 m_lastRequested = -1;
+
+    qint64 m_lastLatencyMs = 0;
+    qint64 m_totalLatencyMs = 0;
+    int m_completedSeeks = 0;
+    int m_droppedSeeks = 0;
+};
+
+#endif // SEEKSCHEDULER_H
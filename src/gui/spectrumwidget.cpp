@@ -0,0 +1,127 @@
+#include "spectrumwidget.h"
+
+#include <QPainter>
+#include <QThread>
+
+namespace mApp {
+const float SPECTRUM_PEAK_HOLD_DECAY_DB = 0.5f; // per received frame
+const int SPECTRUM_METER_WIDTH = 10;
+}
+
+SpectrumWidget::SpectrumWidget(AudioTap* tap, QWidget* parent)
+    : QWidget(parent)
+    , m_tap(tap)
+    , m_thread(new QThread(this))
+    , m_analyzer(new SpectrumAnalyzer)
+{
+    setMinimumHeight(60);
+    setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
+
+    m_peakHoldDb[0] = m_peakHoldDb[1] = mApp::SPECTRUM_FLOOR_DB;
+
+    m_analyzer->moveToThread(m_thread);
+    connect(m_thread, &QThread::finished, m_analyzer, &QObject::deleteLater);
+    connect(this, &SpectrumWidget::resetRequested, m_analyzer, &SpectrumAnalyzer::reset);
+    connect(m_analyzer, &SpectrumAnalyzer::frameReady, this, &SpectrumWidget::acceptFrame);
+
+    m_thread->start();
+}
+
+SpectrumWidget::~SpectrumWidget()
+{
+    detach();
+    m_thread->quit();
+    m_thread->wait();
+}
+
+void SpectrumWidget::attach()
+{
+    if (!m_tap || m_tapConnection)
+        return;
+
+    // Runs in the emitting thread: hand the buffer over or drop it, never wait.
+    SpectrumAnalyzer* analyzer = m_analyzer;
+    m_tapConnection = connect(m_tap, &AudioTap::bufferReceived, analyzer, [analyzer](const QAudioBuffer& buffer) {
+        if (!analyzer->reserveSlot())
+            return;
+        QMetaObject::invokeMethod(analyzer, [analyzer, buffer]() {
+            analyzer->processBuffer(buffer);
+        }, Qt::QueuedConnection);
+    }, Qt::DirectConnection);
+    m_tap->acquire();
+
+    emit resetRequested();
+}
+
+void SpectrumWidget::detach()
+{
+    if (!m_tapConnection)
+        return;
+
+    disconnect(m_tapConnection);
+    m_tapConnection = QMetaObject::Connection();
+    if (m_tap)
+        m_tap->release();
+}
+
+void SpectrumWidget::showEvent(QShowEvent *event)
+{
+    QWidget::showEvent(event);
+    attach();
+}
+
+void SpectrumWidget::hideEvent(QHideEvent *event)
+{
+    QWidget::hideEvent(event);
+    detach();
+}
+
+void SpectrumWidget::acceptFrame(const SpectrumFrame &frame)
+{
+    m_frame = frame;
+    for (int c = 0; c < 2; ++c)
+        m_peakHoldDb[c] = qMax(m_peakHoldDb[c] - mApp::SPECTRUM_PEAK_HOLD_DECAY_DB, frame.peakDb[c]);
+    update();
+}
+
+void SpectrumWidget::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event)
+
+    QPainter painter(this);
+    painter.fillRect(rect(), palette().color(QPalette::Base));
+
+    const int h = height();
+    const float floorDb = mApp::SPECTRUM_FLOOR_DB;
+    auto heightFor = [h, floorDb](float db) {
+        return int(h * (db - floorDb) / -floorDb);
+    };
+
+    // Level meters on the left: RMS bar, peak tick and decaying peak hold.
+    const int meterWidth = mApp::SPECTRUM_METER_WIDTH;
+    for (int c = 0; c < 2; ++c) {
+        const int x = 2 + c * (meterWidth + 2);
+        const int rmsH = heightFor(m_frame.rmsDb[c]);
+        painter.fillRect(x, h - rmsH, meterWidth, rmsH, palette().color(QPalette::Highlight));
+        painter.setPen(palette().color(QPalette::Text));
+        painter.drawLine(x, h - heightFor(m_frame.peakDb[c]), x + meterWidth, h - heightFor(m_frame.peakDb[c]));
+        painter.setPen(Qt::red);
+        painter.drawLine(x, h - heightFor(m_peakHoldDb[c]), x + meterWidth, h - heightFor(m_peakHoldDb[c]));
+    }
+
+    // Spectrum bars in the remaining width.
+    const int bands = m_frame.bandsDb.size();
+    const int left = 2 * (meterWidth + 2) + 6;
+    if (bands > 0) {
+        const double barWidth = double(width() - left) / bands;
+        for (int b = 0; b < bands; ++b) {
+            const int barH = heightFor(m_frame.bandsDb[b]);
+            const int x = left + int(b * barWidth);
+            painter.fillRect(x, h - barH, qMax(1, int(barWidth) - 1), barH, palette().color(QPalette::Highlight));
+        }
+    }
+
+    painter.setPen(palette().color(QPalette::Text));
+    painter.drawText(rect().adjusted(0, 2, -4, 0), Qt::AlignRight | Qt::AlignTop,
+                     tr("DSP %1%").arg(m_frame.dspLoad * 100.0f, 0, 'f', 2));
+}
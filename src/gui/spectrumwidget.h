@@ -0,0 +1,47 @@
+#ifndef SPECTRUMWIDGET_H
+#define SPECTRUMWIDGET_H
+
+#include <QWidget>
+#include <QPointer>
+
+#include "src/media/audiotap.h"
+#include "src/media/spectrumanalyzer.h"
+
+class QThread;
+
+/*
+ * Live spectrum bars plus left/right peak and RMS meters for the player.
+ * The PCM tap is only held while the panel is visible, so a hidden
+ * panel costs nothing.
+ */
+class SpectrumWidget : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit SpectrumWidget(AudioTap* tap, QWidget* parent = nullptr);
+    ~SpectrumWidget();
+
+signals:
+    void resetRequested();
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+    void showEvent(QShowEvent* event) override;
+    void hideEvent(QHideEvent* event) override;
+
+private:
+    void attach();
+    void detach();
+    void acceptFrame(const SpectrumFrame& frame);
+
+    QPointer<AudioTap> m_tap;
+    QMetaObject::Connection m_tapConnection;
+
+    QThread* m_thread = nullptr;
+    SpectrumAnalyzer* m_analyzer = nullptr;
+
+    SpectrumFrame m_frame;
+    float m_peakHoldDb[2];
+};
+
+#endif // SPECTRUMWIDGET_H
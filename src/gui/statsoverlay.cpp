@@ -0,0 +1,84 @@
+#include "statsoverlay.h"
+
+#include <QFontDatabase>
+#include <QTimer>
+
+#include <algorithm>
+
+#include "src/media/playbackstats.h"
+
+namespace mApp {
+const int STATS_REFRESH_MS = 250;
+const int STATS_HISTOGRAM_WIDTH = 20; // characters for the fullest bucket
+}
+
+StatsOverlay::StatsOverlay(PlaybackStats *stats, QWidget *anchor)
+    : QLabel(anchor, Qt::ToolTip)
+    , m_stats(stats)
+    , m_anchor(anchor)
+    , m_refreshTimer(new QTimer(this))
+{
+    setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    setTextFormat(Qt::PlainText);
+    setMargin(6);
+    setAttribute(Qt::WA_TransparentForMouseEvents);
+    setAttribute(Qt::WA_ShowWithoutActivating);
+
+    m_refreshTimer->setInterval(mApp::STATS_REFRESH_MS);
+    connect(m_refreshTimer, &QTimer::timeout, this, &StatsOverlay::refresh);
+    hide();
+}
+
+void StatsOverlay::setAnchor(QWidget *anchor)
+{
+    m_anchor = anchor;
+    if (isVisible())
+        refresh();
+}
+
+void StatsOverlay::toggle()
+{
+    setVisible(!isVisible());
+}
+
+void StatsOverlay::showEvent(QShowEvent *event)
+{
+    QLabel::showEvent(event);
+    m_stats->setEnabled(true);
+    m_refreshTimer->start();
+    refresh();
+}
+
+void StatsOverlay::hideEvent(QHideEvent *event)
+{
+    QLabel::hideEvent(event);
+    m_refreshTimer->stop();
+    m_stats->setEnabled(false);
+}
+
+void StatsOverlay::refresh()
+{
+    const PlaybackStatsSnapshot s = m_stats->snapshot();
+
+    QStringList lines;
+    lines << tr("fps  presented %1  decoded %2").arg(s.presentedFps, 5, 'f', 1).arg(s.decodedFps, 5, 'f', 1);
+    lines << tr("frames %1  dropped %2").arg(s.presentedFrames).arg(s.droppedFrames);
+    lines << tr("A/V offset %1 ms (max %2)").arg(s.avOffsetMs, 6, 'f', 1).arg(s.avOffsetMaxMs, 0, 'f', 1);
+    lines << tr("queue (est.) %1 frames").arg(s.queueFrames, 0, 'f', 1);
+    lines << tr("GUI delivery %1 ms (max %2), stall max %3 ms")
+                 .arg(s.deliveryLagMs, 0, 'f', 1).arg(s.deliveryLagMaxMs, 0, 'f', 1).arg(s.guiStallMaxMs, 0, 'f', 1);
+
+    lines << tr("interval jitter (ms):");
+    const QStringList labels = PlaybackStats::jitterBucketLabels();
+    const qint64 fullest = s.jitterHistogram.isEmpty() ? 0 : *std::max_element(s.jitterHistogram.cbegin(), s.jitterHistogram.cend());
+    for (int i = 0; i < s.jitterHistogram.size(); ++i) {
+        const qint64 count = s.jitterHistogram.at(i);
+        const int bar = fullest > 0 ? int(count * mApp::STATS_HISTOGRAM_WIDTH / fullest) : 0;
+        lines << QString("%1 %2 %3").arg(labels.value(i), 5).arg(QString(bar, QChar('#')), -mApp::STATS_HISTOGRAM_WIDTH).arg(count);
+    }
+    setText(lines.join('\n'));
+    adjustSize();
+
+    if (m_anchor && m_anchor->isVisible())
+        move(m_anchor->mapToGlobal(QPoint(8, 8)));
+}
@@ -0,0 +1,36 @@
+#ifndef STATSOVERLAY_H
+#define STATSOVERLAY_H
+
+#include <QLabel>
+#include <QPointer>
+
+class PlaybackStats;
+class QTimer;
+
+/*
+ * Playback statistics drawn over the top-left corner of the video.
+ * A tool-tip window, like the scrub preview, so it stays above the
+ * native video surface. Stats are only collected while it is shown.
+ */
+class StatsOverlay : public QLabel
+{
+    Q_OBJECT
+public:
+    StatsOverlay(PlaybackStats* stats, QWidget* anchor);
+
+    void setAnchor(QWidget* anchor);
+    void toggle();
+
+protected:
+    void showEvent(QShowEvent* event) override;
+    void hideEvent(QHideEvent* event) override;
+
+private:
+    void refresh();
+
+    PlaybackStats* m_stats = nullptr;
+    QPointer<QWidget> m_anchor;
+    QTimer* m_refreshTimer = nullptr;
+};
+
+#endif // STATSOVERLAY_H
@@ -0,0 +1,129 @@
+#include "statusrefresher.h"
+#include "ui_mainwindow.h"
+
+#include <QDebug>
+#include <QGuiApplication>
+#include <QScreen>
+#include <QSignalBlocker>
+#include <QTimer>
+
+namespace mApp {
+const qreal STATUS_DEFAULT_REFRESH_HZ = 60.0;
+}
+
+StatusRefresher::StatusRefresher(Ui::MainWindow* mainUi, QObject* parent)
+    : QObject(parent)
+    , mainUi(mainUi)
+    , m_refreshTimer(new QTimer(this))
+{
+    // Qt Widgets has no vsync callback, tick at the primary screen's refresh period.
+    qreal refreshHz = mApp::STATUS_DEFAULT_REFRESH_HZ;
+    if (const QScreen* screen = QGuiApplication::primaryScreen()) {
+        if (screen->refreshRate() > 1.0)
+            refreshHz = screen->refreshRate();
+    }
+
+    m_refreshTimer->setTimerType(Qt::PreciseTimer);
+    m_refreshTimer->setInterval(qMax(1, qRound(1000.0 / refreshHz)));
+
+    connect(m_refreshTimer, &QTimer::timeout, this, &StatusRefresher::refresh);
+}
+
+void StatusRefresher::setPlayerPosition(qint64 positionMs)
+{
+    m_playerPosition = positionMs;
+    scheduleRefresh();
+}
+
+void StatusRefresher::setPlayerDuration(qint64 durationMs)
+{
+    m_playerDuration = durationMs;
+    scheduleRefresh();
+}
+
+void StatusRefresher::setRecorderDuration(qint64 durationMs)
+{
+    m_recorderDuration = durationMs;
+    scheduleRefresh();
+}
+
+void StatusRefresher::resetPlayerStatus()
+{
+    if (m_receivedUpdates > 0) {
+        qDebug() << Q_FUNC_INFO << coalescedUpdates() << "of" << m_receivedUpdates
+                 << "status updates coalesced into" << m_appliedUpdates << "refreshes";
+    }
+
+    m_playerPosition = m_playerDuration = 0;
+    m_shownPlayerPosition = m_shownPlayerDuration = 0;
+
+    mainUi->labelMediaElapsedTime->setText(formatTime(0));
+    mainUi->labelMediaTotalTime->setText(formatTime(0));
+}
+
+void StatusRefresher::resetRecorderStatus()
+{
+    m_recorderDuration = m_shownRecorderDuration = 0;
+    mainUi->labelRecordingTimer->setText(formatTime(0));
+}
+
+QString StatusRefresher::formatTime(qint64 ms)
+{
+    const qint64 totalSec = qMax<qint64>(ms, 0) / 1000;
+    const qint64 sec = totalSec % 60;
+    const qint64 min = (totalSec / 60) % 60;
+    const qint64 hr = totalSec / 3600;
+
+    return QStringLiteral("%1:%2:%3")
+        .arg(hr, 2, 10, QLatin1Char('0'))
+        .arg(min, 2, 10, QLatin1Char('0'))
+        .arg(sec, 2, 10, QLatin1Char('0'));
+}
+
+void StatusRefresher::scheduleRefresh()
+{
+    ++m_receivedUpdates;
+    if (!m_refreshTimer->isActive())
+        m_refreshTimer->start();
+}
+
+void StatusRefresher::refresh()
+{
+    bool changed = false;
+
+    // Labels show whole seconds, anything finer is not visible.
+    if (m_playerPosition / 1000 != m_shownPlayerPosition / 1000 || m_shownPlayerPosition < 0) {
+        mainUi->labelMediaElapsedTime->setText(formatTime(m_playerPosition));
+        changed = true;
+    }
+    m_shownPlayerPosition = m_playerPosition;
+
+    if (m_playerDuration / 1000 != m_shownPlayerDuration / 1000 || m_shownPlayerDuration < 0) {
+        mainUi->labelMediaTotalTime->setText(formatTime(m_playerDuration));
+        changed = true;
+    }
+    m_shownPlayerDuration = m_playerDuration;
+
+    if (m_recorderDuration / 1000 != m_shownRecorderDuration / 1000 || m_shownRecorderDuration < 0) {
+        mainUi->labelRecordingTimer->setText(formatTime(m_recorderDuration));
+        changed = true;
+    }
+    m_shownRecorderDuration = m_recorderDuration;
+
+    // Move the slider only when the handle would move by at least one pixel.
+    QSlider* slider = mainUi->sliderMediaPlayback;
+    if (m_sliderFollowsPosition && !slider->isSliderDown() && slider->maximum() > 0) {
+        const int value = static_cast<int>(qMin<qint64>(m_playerPosition, slider->maximum()));
+        const qint64 msPerPixel = qMax<qint64>(1, slider->maximum() / qMax(1, slider->width()));
+        if (qAbs(value - slider->value()) >= msPerPixel) {
+            const QSignalBlocker blocker(slider); // a position update is not a seek
+            slider->setValue(value);
+            changed = true;
+        }
+    }
+
+    if (changed)
+        ++m_appliedUpdates;
+    else
+        m_refreshTimer->stop(); // nothing visible changed: idle until the next signal
+}
@@ -0,0 +1,58 @@
+#ifndef STATUSREFRESHER_H
+#define STATUSREFRESHER_H
+
+#include <QObject>
+#include <QString>
+
+class QTimer;
+
+namespace Ui {
+class MainWindow;
+}
+
+/*
+ * Batches player and recorder status into one UI update per display frame.
+ * Signal handlers only store the latest values; the refresh tick formats
+ * and pushes them into the labels/slider when they visibly changed.
+ * The tick stops itself while nothing is pending.
+ */
+class StatusRefresher : public QObject
+{
+    Q_OBJECT
+public:
+    explicit StatusRefresher(Ui::MainWindow* mainUi, QObject* parent = nullptr);
+
+    void setPlayerPosition(qint64 positionMs);
+    void setPlayerDuration(qint64 durationMs);
+    void setRecorderDuration(qint64 durationMs);
+
+    void resetPlayerStatus();
+    void resetRecorderStatus();
+
+    // Slider is left alone while the user drags it.
+    void setSliderFollowsPosition(bool follow) { m_sliderFollowsPosition = follow; }
+
+    quint64 receivedUpdates() const { return m_receivedUpdates; }
+    quint64 appliedUpdates() const { return m_appliedUpdates; }
+    quint64 coalescedUpdates() const { return m_receivedUpdates - m_appliedUpdates; }
+
+    static QString formatTime(qint64 ms);
+
+private:
+    void scheduleRefresh();
+    void refresh();
+
+    Ui::MainWindow* mainUi = nullptr;
+    QTimer* m_refreshTimer = nullptr;
+
+    qint64 m_playerPosition = 0, m_shownPlayerPosition = -1;
+    qint64 m_playerDuration = 0, m_shownPlayerDuration = -1;
+    qint64 m_recorderDuration = 0, m_shownRecorderDuration = -1;
+
+    bool m_sliderFollowsPosition = true;
+
+    quint64 m_receivedUpdates = 0;
+    quint64 m_appliedUpdates = 0;
+};
+
+#endif // STATUSREFRESHER_H
@@ -0,0 +1,174 @@
+#include "waveformwidget.h"
+#include "src/media/waveformbuilder.h"
+
+#include <QMouseEvent>
+#include <QPainter>
+#include <QStandardPaths>
+#include <QThread>
+
+#include <algorithm>
+
+WaveformWidget::WaveformWidget(QWidget* parent)
+    : QWidget(parent)
+    , m_thread(new QThread(this))
+    , m_builder(new WaveformBuilder)
+{
+    setMinimumHeight(80);
+    setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
+
+    m_builder->moveToThread(m_thread);
+    connect(m_thread, &QThread::finished, m_builder, &QObject::deleteLater);
+    connect(this, &WaveformWidget::buildRequested, m_builder, &WaveformBuilder::build);
+    connect(this, &WaveformWidget::stopRequested, m_builder, &WaveformBuilder::stop);
+
+    auto acceptData = [this](int generation, const WaveformData& data) {
+        if (generation != m_generation)
+            return;
+        m_data = data;
+        update();
+    };
+    connect(m_builder, &WaveformBuilder::progress, this, acceptData);
+    connect(m_builder, &WaveformBuilder::finished, this, acceptData);
+
+    m_thread->start(QThread::LowPriority);
+}
+
+WaveformWidget::~WaveformWidget()
+{
+    m_thread->quit();
+    m_thread->wait();
+}
+
+void WaveformWidget::openFile(const QString &filePath)
+{
+    clear();
+    emit buildRequested(filePath, m_generation,
+                        QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/waveforms");
+}
+
+void WaveformWidget::clear()
+{
+    ++m_generation;
+    emit stopRequested();
+
+    m_data = WaveformData();
+    m_durationMs = m_positionMs = 0;
+    update();
+}
+
+void WaveformWidget::setDurationMs(qint64 durationMs)
+{
+    if (m_durationMs == durationMs)
+        return;
+    m_durationMs = durationMs;
+    update();
+}
+
+void WaveformWidget::setPositionMs(qint64 positionMs)
+{
+    // Repaint only the two cursor columns, and only when the cursor moves a pixel.
+    const int oldX = xForPosition(m_positionMs);
+    m_positionMs = positionMs;
+    const int newX = xForPosition(m_positionMs);
+    if (oldX == newX)
+        return;
+
+    update(QRect(oldX - 1, 0, 3, height()));
+    update(QRect(newX - 1, 0, 3, height()));
+}
+
+void WaveformWidget::setLoopRange(qint64 startMs, qint64 endMs)
+{
+    m_loopStartMs = startMs;
+    m_loopEndMs = endMs;
+    update();
+}
+
+qint64 WaveformWidget::positionForX(int x) const
+{
+    const qint64 total = m_durationMs > 0 ? m_durationMs : m_data.durationMs();
+    if (width() <= 0)
+        return 0;
+    return qBound<qint64>(0, total * x / width(), total);
+}
+
+int WaveformWidget::xForPosition(qint64 positionMs) const
+{
+    const qint64 total = m_durationMs > 0 ? m_durationMs : m_data.durationMs();
+    if (total <= 0)
+        return 0;
+    return static_cast<int>(positionMs * width() / total);
+}
+
+void WaveformWidget::paintEvent(QPaintEvent *event)
+{
+    QPainter painter(this);
+    painter.fillRect(event->rect(), palette().color(QPalette::Base));
+
+    const int h = height();
+    const int midY = h / 2;
+    const float halfHeight = h / 2.0f;
+
+    if (!m_data.isEmpty()) {
+        // Pick the level with about one peak per pixel across the whole file.
+        const qint64 total = m_durationMs > 0 ? m_durationMs : m_data.durationMs();
+        const qint64 samplesTotal = total * m_data.sampleRate() / 1000;
+        const int wantedPeaks = std::max(1, width());
+        const WaveformData::Level& level = m_data.levelFor(wantedPeaks);
+        const double peaksPerPixel = double(samplesTotal) / level.samplesPerPeak / std::max(1, width());
+
+        const QColor peakColor = palette().color(QPalette::Highlight);
+        QColor rmsColor = peakColor.lighter(150);
+
+        const int firstX = event->rect().left();
+        const int lastX = std::min(event->rect().right(), width() - 1);
+        for (int x = firstX; x <= lastX; ++x) {
+            const int begin = static_cast<int>(x * peaksPerPixel);
+            const int end = std::max(begin + 1, static_cast<int>((x + 1) * peaksPerPixel));
+            if (begin >= level.size())
+                break; // not decoded yet
+
+            float mn = level.min[begin], mx = level.max[begin], rms = level.rms[begin];
+            for (int i = begin + 1; i < std::min(end, level.size()); ++i) {
+                mn = std::min(mn, level.min[i]);
+                mx = std::max(mx, level.max[i]);
+                rms = std::max(rms, level.rms[i]);
+            }
+
+            painter.setPen(peakColor);
+            painter.drawLine(x, midY - int(mx * halfHeight), x, midY - int(mn * halfHeight));
+            painter.setPen(rmsColor);
+            painter.drawLine(x, midY - int(rms * halfHeight), x, midY + int(rms * halfHeight));
+        }
+    }
+
+    // A-B loop region and markers.
+    QColor loopColor = palette().color(QPalette::Highlight);
+    if (m_loopStartMs >= 0 && m_loopEndMs >= 0) {
+        QColor region = loopColor;
+        region.setAlpha(50);
+        const int left = xForPosition(m_loopStartMs);
+        painter.fillRect(left, 0, xForPosition(m_loopEndMs) - left, h, region);
+    }
+    painter.setPen(loopColor.darker(150));
+    if (m_loopStartMs >= 0)
+        painter.drawLine(xForPosition(m_loopStartMs), 0, xForPosition(m_loopStartMs), h);
+    if (m_loopEndMs >= 0)
+        painter.drawLine(xForPosition(m_loopEndMs), 0, xForPosition(m_loopEndMs), h);
+
+    painter.setPen(palette().color(QPalette::Text));
+    const int cursorX = xForPosition(m_positionMs);
+    painter.drawLine(cursorX, 0, cursorX, h);
+}
+
+void WaveformWidget::mousePressEvent(QMouseEvent *event)
+{
+    if (event->button() == Qt::LeftButton)
+        emit seekRequested(positionForX(event->position().toPoint().x()));
+}
+
+void WaveformWidget::mouseMoveEvent(QMouseEvent *event)
+{
+    if (event->buttons() & Qt::LeftButton)
+        emit seekRequested(positionForX(event->position().toPoint().x()));
+}
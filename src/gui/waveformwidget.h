@@ -0,0 +1,55 @@
+#ifndef WAVEFORMWIDGET_H
+#define WAVEFORMWIDGET_H
+
+#include <QWidget>
+
+#include "src/media/waveformdata.h"
+
+class QThread;
+class WaveformBuilder;
+
+/*
+ * Overview of an audio file for mApp::Rendering_Audio.
+ * Peaks are built by a WaveformBuilder on a worker thread and drawn
+ * progressively; clicking or dragging requests a seek.
+ */
+class WaveformWidget : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit WaveformWidget(QWidget* parent = nullptr);
+    ~WaveformWidget();
+
+    void openFile(const QString& filePath);
+    void clear();
+
+    void setDurationMs(qint64 durationMs);
+    void setPositionMs(qint64 positionMs);
+    void setLoopRange(qint64 startMs, qint64 endMs);
+
+signals:
+    void buildRequested(const QString& filePath, int generation, const QString& cacheDir);
+    void stopRequested();
+    void seekRequested(qint64 positionMs);
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+    void mousePressEvent(QMouseEvent* event) override;
+    void mouseMoveEvent(QMouseEvent* event) override;
+
+private:
+    qint64 positionForX(int x) const;
+    int xForPosition(qint64 positionMs) const;
+
+    QThread* m_thread = nullptr;
+    WaveformBuilder* m_builder = nullptr;
+    int m_generation = 0;
+
+    WaveformData m_data;
+    qint64 m_durationMs = 0;
+    qint64 m_positionMs = 0;
+    qint64 m_loopStartMs = -1;
+    qint64 m_loopEndMs = -1;
+};
+
+#endif // WAVEFORMWIDGET_H
@@ -1,19 +1,170 @@
 #include "gui/mainwindow.h"
+#include "common/singleinstance.h"
+#include "common/startuptimeline.h"
+#include "media/batchprocessor.h"
 
 #include <QApplication>
+#include <QCommandLineParser>
 #include <QFile>
 #include <QString>
 #include <QStyle>
+#include <QTextStream>
+#include <QTimer>
 
+#include <cstring>
+
+namespace mApp {
+const int STARTUP_BENCHMARK_TIMEOUT_MS = 30000;
+}
+
+namespace {
+// Batch mode needs no display; checked before QApplication picks a platform.
+bool isBatchMode(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--batch") == 0 || std::strncmp(argv[i], "--batch=", 8) == 0)
+            return true;
+    }
+    return false;
+}
+
+int runBatch(const BatchOptions& options)
+{
+    BatchProcessor processor(options);
+    BatchProcessor::Stats stats;
+    if (!processor.run(&stats))
+        return 2;
+
+    const double seconds = qMax<qint64>(1, stats.elapsedUs) / 1e6;
+    const double megabyte = 1024.0 * 1024.0;
+    QTextStream(stdout) << QString("%1 images written (%2 failed) in %3 s on %4 threads: %5 images/s, %6 MB/s read, %7 MB/s written\n"
+                                   "decode+transform %8 s, encode %9 s of worker time\n")
+                               .arg(stats.images).arg(stats.failed).arg(seconds, 0, 'f', 2).arg(stats.threads)
+                               .arg(stats.images / seconds, 0, 'f', 1)
+                               .arg(stats.inputBytes / megabyte / seconds, 0, 'f', 1)
+                               .arg(stats.outputBytes / megabyte / seconds, 0, 'f', 1)
+                               .arg(stats.decodeUs / 1e6, 0, 'f', 2)
+                               .arg(stats.encodeUs / 1e6, 0, 'f', 2);
+    return stats.failed > 0 ? 1 : 0;
+}
+}
 
 int main(int argc, char *argv[])
 {
+    StartupTimeline* timeline = StartupTimeline::instance();
+    timeline->start();
+
+    const bool batchMode = isBatchMode(argc, argv);
+    if (batchMode && qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
     QApplication a(argc, argv);
+    timeline->mark("application");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QApplication::translate("main", "Mini Media player and recorder"));
+    parser.addHelpOption();
+    parser.addPositionalArgument("files", QApplication::translate("main", "Media files to open and play."), "[files...]");
+    const QCommandLineOption benchmarkStartupOption(
+        "benchmark-startup",
+        QApplication::translate("main", "Print the startup timeline and time-to-first-frame, then quit."));
+    parser.addOption(benchmarkStartupOption);
+
+    const QCommandLineOption batchOption(
+        "batch",
+        QApplication::translate("main", "Convert every image in <dir> without opening a window."), "dir");
+    const QCommandLineOption outputOption(
+        "output", QApplication::translate("main", "Batch: output directory."), "dir");
+    const QCommandLineOption formatOption(
+        "format", QApplication::translate("main", "Batch: output format, e.g. jpg, png, webp."), "format", "jpg");
+    const QCommandLineOption qualityOption(
+        "quality", QApplication::translate("main", "Batch: encoder quality, 0-100."), "quality",
+        QString::number(mApp::BATCH_DEFAULT_QUALITY));
+    const QCommandLineOption resizeOption(
+        "resize", QApplication::translate("main", "Batch: fit within WxH; never upscales."), "WxH");
+    const QCommandLineOption cropOption(
+        "crop", QApplication::translate("main", "Batch: crop x,y,w,h in upright source pixels, before resizing."), "x,y,w,h");
+    const QCommandLineOption threadsOption(
+        "threads", QApplication::translate("main", "Batch: worker threads; default one per core."), "count", "0");
+    const QCommandLineOption memoryOption(
+        "max-memory", QApplication::translate("main", "Batch: decoded image memory in flight, in MB."), "MB",
+        QString::number(mApp::BATCH_DEFAULT_MEMORY_MB));
+    parser.addOptions({batchOption, outputOption, formatOption, qualityOption, resizeOption, cropOption,
+                       threadsOption, memoryOption});
+    parser.process(a);
+
+    if (batchMode) {
+        BatchOptions options;
+        options.inputDir = parser.value(batchOption);
+        options.outputDir = parser.value(outputOption);
+        options.format = parser.value(formatOption).toLower().toLatin1();
+        options.quality = qBound(0, parser.value(qualityOption).toInt(), 100);
+        options.threads = parser.value(threadsOption).toInt();
+        options.memoryMb = parser.value(memoryOption).toInt();
+        if (parser.isSet(resizeOption))
+            options.maxSize = BatchProcessor::parseSize(parser.value(resizeOption));
+        if (parser.isSet(cropOption))
+            options.crop = BatchProcessor::parseRect(parser.value(cropOption));
+
+        if (options.outputDir.isEmpty() || (parser.isSet(resizeOption) && options.maxSize.isEmpty())
+            || (parser.isSet(cropOption) && options.crop.isEmpty())) {
+            QTextStream(stderr) << "--batch needs --output <dir>; --resize takes WxH and --crop x,y,w,h\n";
+            return 2;
+        }
+        return runBatch(options);
+    }
+
+    const QStringList filePaths = parser.positionalArguments();
+    const bool benchmarkStartup = parser.isSet(benchmarkStartupOption);
+
+    // A benchmark always measures a cold start of its own.
+    SingleInstance instance;
+    if (!benchmarkStartup) {
+        // Without files the running instance is just raised. If it answers only after the first attempt
+        // timed out, it still gets the files; otherwise this launch runs on its own without the name.
+        if (instance.forwardToRunningInstance(filePaths))
+            return 0;
+        if (!instance.listen() && instance.forwardToRunningInstance(filePaths))
+            return 0;
+    }
+    timeline->mark("instance check");
 
     qDebug() << a.style()->name();
 
     MainWindow w;
+    timeline->mark("main window");
 
+    QObject::connect(&instance, &SingleInstance::filesReceived, &w, &MainWindow::openFiles);
+
+    if (benchmarkStartup) {
+        QObject::connect(timeline, &StartupTimeline::finished, &a, [timeline]() {
+            QTextStream out(stdout);
+            qint64 previousUs = 0;
+            for (const StartupTimeline::Phase& phase : timeline->phases()) {
+                out << QString("%1 %2 ms\n").arg(QLatin1String(phase.name), -20)
+                           .arg((phase.endUs - previousUs) / 1000.0, 8, 'f', 2);
+                previousUs = phase.endUs;
+            }
+            out << QString("time-to-first-frame %1 ms\n").arg(timeline->totalUs() / 1000.0, 0, 'f', 2);
+            out.flush();
+            QTimer::singleShot(0, qApp, &QApplication::quit);
+        });
+        QTimer::singleShot(mApp::STARTUP_BENCHMARK_TIMEOUT_MS, &a, []() {
+            QTextStream(stderr) << "No frame shown within " << mApp::STARTUP_BENCHMARK_TIMEOUT_MS << " ms\n";
+            QApplication::exit(1);
+        });
+    }
+
+    if (!filePaths.isEmpty())
+        timeline->expectMediaFrame();
+
+    timeline->finishOnFirstPaint(&w);
     w.show();
+    timeline->mark("show");
+
+    if (!filePaths.isEmpty())
+        w.openFiles(filePaths);
+    timeline->mark("open files");
+
     return a.exec();
 }
@@ -0,0 +1,81 @@
+#include "audiotap.h"
+
+#include <QAudioFormat>
+#include <QMediaPlayer>
+#include <QtGlobal>
+
+#if QT_VERSION >= QT_VERSION_CHECK(6, 8, 0)
+#include <QAudioBufferOutput>
+#endif
+
+AudioTap::AudioTap(QObject *parent)
+    : QObject(parent)
+{
+#if QT_VERSION >= QT_VERSION_CHECK(6, 8, 0)
+    QAudioFormat format;
+    format.setSampleFormat(QAudioFormat::Float);
+    format.setChannelCount(2);
+    format.setSampleRate(48000);
+    m_bufferOutput = new QAudioBufferOutput(format, this);
+
+    connect(m_bufferOutput, &QAudioBufferOutput::audioBufferReceived,
+            this, &AudioTap::bufferReceived, Qt::DirectConnection);
+#endif
+}
+
+AudioTap::~AudioTap()
+{
+    detach();
+}
+
+bool AudioTap::isSupported()
+{
+#if QT_VERSION >= QT_VERSION_CHECK(6, 8, 0)
+    return true;
+#else
+    return false;
+#endif
+}
+
+void AudioTap::setPlayer(QMediaPlayer *player)
+{
+    if (m_player == player)
+        return;
+
+    detach();
+    m_player = player;
+    if (m_users > 0)
+        attach();
+}
+
+void AudioTap::acquire()
+{
+    if (m_users++ == 0)
+        attach();
+}
+
+void AudioTap::release()
+{
+    if (m_users == 0) {
+        qWarning() << Q_FUNC_INFO << "Unbalanced release";
+        return;
+    }
+    if (--m_users == 0)
+        detach();
+}
+
+void AudioTap::attach()
+{
+#if QT_VERSION >= QT_VERSION_CHECK(6, 8, 0)
+    if (m_player)
+        m_player->setAudioBufferOutput(m_bufferOutput);
+#endif
+}
+
+void AudioTap::detach()
+{
+#if QT_VERSION >= QT_VERSION_CHECK(6, 8, 0)
+    if (m_player && m_player->audioBufferOutput() == m_bufferOutput)
+        m_player->setAudioBufferOutput(nullptr);
+#endif
+}
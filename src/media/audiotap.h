@@ -0,0 +1,45 @@
+#ifndef AUDIOTAP_H
+#define AUDIOTAP_H
+
+#include <QObject>
+#include <QAudioBuffer>
+
+class QAudioBufferOutput;
+class QMediaPlayer;
+
+/*
+ * Shared PCM tap on the active player. A player takes a single buffer
+ * output, so every consumer (spectrum, time-stretch) goes through this.
+ * The tap is only attached while at least one consumer holds it.
+ * bufferReceived is emitted in the backend's delivery thread: connect
+ * with Qt::DirectConnection and hand the buffer over without waiting.
+ */
+class AudioTap : public QObject
+{
+    Q_OBJECT
+public:
+    explicit AudioTap(QObject* parent = nullptr);
+    ~AudioTap();
+
+    // False when Qt is too old to provide QAudioBufferOutput.
+    static bool isSupported();
+
+    void setPlayer(QMediaPlayer* player);
+    QMediaPlayer* player() const { return m_player; }
+
+    void acquire();
+    void release();
+
+signals:
+    void bufferReceived(const QAudioBuffer& buffer);
+
+private:
+    void attach();
+    void detach();
+
+    QMediaPlayer* m_player = nullptr;
+    QAudioBufferOutput* m_bufferOutput = nullptr;
+    int m_users = 0;
+};
+
+#endif // AUDIOTAP_H
@@ -0,0 +1,354 @@
+#include "bandreader.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QImageReader>
+#include <QtEndian>
+
+#ifdef MINIMEDIA_HAVE_LIBPNG
+#include <png.h>
+#endif
+#ifdef MINIMEDIA_HAVE_LIBTIFF
+#include <tiffio.h>
+#endif
+
+#include <csetjmp>
+
+namespace {
+
+#ifdef MINIMEDIA_HAVE_LIBPNG
+// Shared by the I/O and error callbacks of one read struct.
+struct PngIo
+{
+    QFile* file = nullptr;
+    QString error;
+};
+
+void pngRead(png_structp png, png_bytep data, png_size_t length)
+{
+    PngIo* io = static_cast<PngIo*>(png_get_io_ptr(png));
+    if (io->file->read(reinterpret_cast<char*>(data), qint64(length)) != qint64(length))
+        png_error(png, "Unexpected end of file");
+}
+
+void pngError(png_structp png, png_const_charp message)
+{
+    static_cast<PngIo*>(png_get_error_ptr(png))->error = QString::fromLatin1(message);
+    png_longjmp(png, 1);
+}
+
+void pngWarning(png_structp, png_const_charp)
+{
+    // Ancillary chunk problems do not matter for the pixels.
+}
+#endif
+
+#ifdef MINIMEDIA_HAVE_LIBTIFF
+tmsize_t tiffRead(thandle_t handle, void* data, tmsize_t size)
+{
+    return static_cast<QFile*>(handle)->read(static_cast<char*>(data), size);
+}
+
+tmsize_t tiffWrite(thandle_t, void*, tmsize_t)
+{
+    return 0;
+}
+
+toff_t tiffSeek(thandle_t handle, toff_t offset, int whence)
+{
+    QFile* file = static_cast<QFile*>(handle);
+    qint64 position = qint64(offset);
+    if (whence == SEEK_CUR)
+        position += file->pos();
+    else if (whence == SEEK_END)
+        position += file->size();
+    return file->seek(position) ? toff_t(position) : toff_t(-1);
+}
+
+int tiffClose(thandle_t)
+{
+    return 0;
+}
+
+toff_t tiffSize(thandle_t handle)
+{
+    return toff_t(static_cast<QFile*>(handle)->size());
+}
+
+int tiffMap(thandle_t, void**, toff_t*)
+{
+    return 0;
+}
+
+void tiffUnmap(thandle_t, void*, toff_t)
+{
+}
+#endif
+
+} // namespace
+
+#ifdef MINIMEDIA_HAVE_LIBPNG
+struct BandReader::PngState
+{
+    PngIo io;
+    png_structp png = nullptr;
+    png_infop info = nullptr;
+    int nextRow = 0;
+};
+#endif
+
+#ifdef MINIMEDIA_HAVE_LIBTIFF
+struct BandReader::TiffState
+{
+    TIFF* tiff = nullptr;
+    TIFFRGBAImage image;
+    bool begun = false;
+};
+#endif
+
+BandReader::BandReader(const QString &filePath)
+    : m_filePath(filePath)
+{
+}
+
+BandReader::~BandReader()
+{
+    closeStreams();
+    delete m_file;
+}
+
+bool BandReader::open()
+{
+    QImageReader reader(m_filePath);
+    m_size = reader.size();
+    const QByteArray format = reader.format();
+
+    if (m_size.isValid() && reader.supportsOption(QImageIOHandler::ClipRect)) {
+        m_method = Method_RegionRead;
+        return true;
+    }
+
+    m_file = new QFile(m_filePath);
+    if (!m_file->open(QIODevice::ReadOnly)) {
+        m_error = m_file->errorString();
+        return false;
+    }
+
+#ifdef MINIMEDIA_HAVE_LIBPNG
+    if (format == "png") {
+        if (openPng()) {
+            m_method = Method_PngRows;
+            return true;
+        }
+        closeStreams();
+        m_file->seek(0);
+    }
+#endif
+#ifdef MINIMEDIA_HAVE_LIBTIFF
+    if (format == "tiff" || format == "tif") {
+        if (openTiff()) {
+            m_method = Method_TiffRows;
+            return true;
+        }
+        closeStreams();
+    }
+#endif
+
+    // The codec needs the whole image in memory once.
+    m_method = Method_FullDecode;
+    reader.setAllocationLimit(mApp::BAND_FULL_DECODE_LIMIT_MB);
+    m_whole = reader.read();
+    if (m_whole.isNull()) {
+        m_error = QStringLiteral("%1 can only be decoded whole, which failed (limit %2 MB): %3")
+                      .arg(m_filePath).arg(mApp::BAND_FULL_DECODE_LIMIT_MB).arg(reader.errorString());
+        return false;
+    }
+    m_size = m_whole.size();
+    return true;
+}
+
+QImage BandReader::readRows(int top, int count)
+{
+    const QRect rows = QRect(0, top, m_size.width(), count).intersected(QRect(QPoint(0, 0), m_size));
+    if (rows.isEmpty()) {
+        m_error = QStringLiteral("Rows %1-%2 are outside the image").arg(top).arg(top + count - 1);
+        return QImage();
+    }
+
+    switch (m_method) {
+    case Method_RegionRead: {
+        QImageReader reader(m_filePath);
+        reader.setClipRect(rows);
+        const QImage band = reader.read();
+        if (band.isNull())
+            m_error = reader.errorString();
+        return band;
+    }
+#ifdef MINIMEDIA_HAVE_LIBPNG
+    case Method_PngRows:
+        return readPng(rows.top(), rows.height());
+#endif
+#ifdef MINIMEDIA_HAVE_LIBTIFF
+    case Method_TiffRows:
+        return readTiff(rows.top(), rows.height());
+#endif
+    case Method_FullDecode:
+        return m_whole.copy(rows);
+    default:
+        break;
+    }
+    return QImage();
+}
+
+const char *BandReader::methodName(Method method)
+{
+    static const char* const names[] = {"region reads", "libpng rows", "libtiff strips", "full decode"};
+    return names[method];
+}
+
+void BandReader::closeStreams()
+{
+#ifdef MINIMEDIA_HAVE_LIBPNG
+    if (m_png) {
+        png_destroy_read_struct(&m_png->png, &m_png->info, nullptr);
+        delete m_png;
+        m_png = nullptr;
+    }
+#endif
+#ifdef MINIMEDIA_HAVE_LIBTIFF
+    if (m_tiff) {
+        if (m_tiff->begun)
+            TIFFRGBAImageEnd(&m_tiff->image);
+        if (m_tiff->tiff)
+            TIFFClose(m_tiff->tiff);
+        delete m_tiff;
+        m_tiff = nullptr;
+    }
+#endif
+}
+
+#ifdef MINIMEDIA_HAVE_LIBPNG
+bool BandReader::openPng()
+{
+    m_png = new PngState;
+    m_png->io.file = m_file;
+    m_png->png = png_create_read_struct(PNG_LIBPNG_VER_STRING, &m_png->io, pngError, pngWarning);
+    if (m_png->png)
+        m_png->info = png_create_info_struct(m_png->png);
+    if (!m_png->info)
+        return false;
+
+    png_structp png = m_png->png;
+    png_infop info = m_png->info;
+    if (setjmp(png_jmpbuf(png)))
+        return false;
+
+    png_set_read_fn(png, &m_png->io, pngRead);
+    png_read_info(png, info);
+
+    // Adam7 passes each cover the whole image; only plain row order streams.
+    if (png_get_interlace_type(png, info) != PNG_INTERLACE_NONE)
+        return false;
+
+    // Every colour type and depth to 8-bit RGBA.
+    png_set_expand(png);
+    png_set_strip_16(png);
+    png_set_gray_to_rgb(png);
+    png_set_filler(png, 0xFF, PNG_FILLER_AFTER);
+    png_read_update_info(png, info);
+
+    const png_uint_32 width = png_get_image_width(png, info);
+    const png_uint_32 height = png_get_image_height(png, info);
+    if (width == 0 || height == 0 || width > png_uint_32(INT_MAX / 4) || height > png_uint_32(INT_MAX)
+        || png_get_rowbytes(png, info) != png_size_t(width) * 4)
+        return false;
+
+    m_size = QSize(int(width), int(height));
+    return true;
+}
+
+QImage BandReader::readPng(int top, int height)
+{
+    QImage rows(m_size.width(), height, QImage::Format_RGBA8888);
+    if (rows.isNull()) {
+        m_error = QStringLiteral("Not enough memory for %1 rows of %2").arg(height).arg(m_filePath);
+        return QImage();
+    }
+    if (top < m_png->nextRow) {
+        m_error = QStringLiteral("Rows of %1 must be read top to bottom").arg(m_filePath);
+        return QImage();
+    }
+
+    if (setjmp(png_jmpbuf(m_png->png))) {
+        m_error = QStringLiteral("Unable to read rows %1-%2 of %3: %4")
+                      .arg(top).arg(top + height - 1).arg(m_filePath, m_png->io.error);
+        return QImage();
+    }
+
+    // Rows above the band were not asked for; decoded into the first line and dropped.
+    while (m_png->nextRow < top) {
+        png_read_row(m_png->png, rows.scanLine(0), nullptr);
+        ++m_png->nextRow;
+    }
+    for (int y = 0; y < height; ++y) {
+        png_read_row(m_png->png, rows.scanLine(y), nullptr);
+        ++m_png->nextRow;
+    }
+    return rows;
+}
+#endif
+
+#ifdef MINIMEDIA_HAVE_LIBTIFF
+bool BandReader::openTiff()
+{
+    m_tiff = new TiffState;
+    m_tiff->tiff = TIFFClientOpen(m_filePath.toLocal8Bit().constData(), "r", m_file,
+                                  tiffRead, tiffWrite, tiffSeek, tiffClose, tiffSize, tiffMap, tiffUnmap);
+    if (!m_tiff->tiff)
+        return false;
+
+    char message[1024] = {};
+    if (!TIFFRGBAImageOK(m_tiff->tiff, message) || !TIFFRGBAImageBegin(&m_tiff->image, m_tiff->tiff, 0, message)) {
+        qWarning() << Q_FUNC_INFO << m_filePath << message;
+        return false;
+    }
+    m_tiff->begun = true;
+    m_tiff->image.req_orientation = ORIENTATION_TOPLEFT;
+
+    if (m_tiff->image.width == 0 || m_tiff->image.height == 0 || m_tiff->image.width > uint32_t(INT_MAX / 4)
+        || m_tiff->image.height > uint32_t(INT_MAX))
+        return false;
+
+    m_size = QSize(int(m_tiff->image.width), int(m_tiff->image.height));
+    return true;
+}
+
+QImage BandReader::readTiff(int top, int height)
+{
+    // libtiff premultiplies unassociated alpha on the way out.
+    QImage rows(m_size.width(), height, QImage::Format_RGBA8888_Premultiplied);
+    if (rows.isNull()) {
+        m_error = QStringLiteral("Not enough memory for %1 rows of %2").arg(height).arg(m_filePath);
+        return QImage();
+    }
+
+    // Strips or tiles that straddle the band edge are decoded for both bands.
+    m_tiff->image.row_offset = top;
+    m_tiff->image.col_offset = 0;
+    if (!TIFFRGBAImageGet(&m_tiff->image, reinterpret_cast<uint32_t*>(rows.bits()), uint32_t(rows.width()),
+                          uint32_t(height))) {
+        m_error = QStringLiteral("Unable to read rows %1-%2 of %3").arg(top).arg(top + height - 1).arg(m_filePath);
+        return QImage();
+    }
+
+#if Q_BYTE_ORDER == Q_BIG_ENDIAN
+    // Pixels are packed with red in the low byte.
+    for (int y = 0; y < height; ++y) {
+        quint32* line = reinterpret_cast<quint32*>(rows.scanLine(y));
+        for (int x = 0; x < rows.width(); ++x)
+            line[x] = qbswap(line[x]);
+    }
+#endif
+    return rows;
+}
+#endif
@@ -0,0 +1,72 @@
+#ifndef BANDREADER_H
+#define BANDREADER_H
+
+#include <QImage>
+#include <QSize>
+#include <QString>
+
+class QFile;
+
+namespace mApp {
+const int BAND_FULL_DECODE_LIMIT_MB = 1024;     // codecs that can neither stream nor read regions
+}
+
+/*
+ * Reads an image top to bottom in full-width bands without holding the
+ * whole image, for sources larger than memory. Region reads are used
+ * where Qt's codec has them (JPEG); non-interlaced PNG is read row by row
+ * through libpng and TIFF strip by strip or tile by tile through libtiff,
+ * when built with them (MINIMEDIA_HAVE_LIBPNG, MINIMEDIA_HAVE_LIBTIFF).
+ * Anything else is decoded whole once, within BAND_FULL_DECODE_LIMIT_MB.
+ * Bands must be requested in increasing order; rows are skipped, not
+ * decoded twice. Blocking; meant for the Qt Concurrent pool.
+ */
+class BandReader
+{
+public:
+    enum Method {
+        Method_RegionRead = 0,
+        Method_PngRows,
+        Method_TiffRows,
+        Method_FullDecode
+    };
+
+    explicit BandReader(const QString& filePath);
+    ~BandReader();
+
+    // Reads the header and picks the method; false with errorString() set on failure.
+    bool open();
+
+    QSize size() const { return m_size; }
+    Method method() const { return m_method; }
+    QString errorString() const { return m_error; }
+
+    // count full-width rows from top, clipped to the image; null with errorString() set on failure.
+    QImage readRows(int top, int count);
+
+    static const char* methodName(Method method);
+
+private:
+    Q_DISABLE_COPY(BandReader)
+
+    struct PngState;
+    struct TiffState;
+
+    void closeStreams();
+    bool openPng();
+    bool openTiff();
+    QImage readPng(int top, int height);
+    QImage readTiff(int top, int height);
+
+    QString m_filePath;
+    QSize m_size;
+    Method m_method = Method_FullDecode;
+    QString m_error;
+
+    QFile* m_file = nullptr;
+    PngState* m_png = nullptr;
+    TiffState* m_tiff = nullptr;
+    QImage m_whole;
+};
+
+#endif // BANDREADER_H
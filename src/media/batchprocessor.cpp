@@ -0,0 +1,214 @@
+#include "batchprocessor.h"
+
+#include <QCollator>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QImageWriter>
+#include <QMutex>
+#include <QRegularExpression>
+#include <QSemaphore>
+#include <QSet>
+#include <QTextStream>
+#include <QThreadPool>
+
+#include <algorithm>
+
+#include "cropexporter.h"
+#include "exifreader.h"
+#include "imagedecoder.h"
+#include "imageresampler.h"
+
+BatchProcessor::BatchProcessor(const BatchOptions &options)
+    : m_options(options)
+{
+}
+
+QSize BatchProcessor::parseSize(const QString &text)
+{
+    static const QRegularExpression pattern("^(\\d+)x(\\d+)$");
+    const QRegularExpressionMatch match = pattern.match(text.trimmed());
+    if (!match.hasMatch())
+        return QSize();
+    return QSize(match.captured(1).toInt(), match.captured(2).toInt());
+}
+
+QRect BatchProcessor::parseRect(const QString &text)
+{
+    static const QRegularExpression pattern("^(\\d+),(\\d+),(\\d+),(\\d+)$");
+    const QRegularExpressionMatch match = pattern.match(text.trimmed());
+    if (!match.hasMatch())
+        return QRect();
+    return QRect(match.captured(1).toInt(), match.captured(2).toInt(),
+                 match.captured(3).toInt(), match.captured(4).toInt());
+}
+
+QVector<BatchProcessor::Job> BatchProcessor::listJobs() const
+{
+    // Listed by suffix, like the viewer's folder browsing.
+    QStringList nameFilters;
+    for (const QByteArray& format : QImageReader::supportedImageFormats())
+        nameFilters << "*." + QString::fromLatin1(format);
+
+    const QDir input(m_options.inputDir);
+    QStringList fileNames = input.entryList(nameFilters, QDir::Files | QDir::Readable);
+    QCollator collator;
+    collator.setNumericMode(true);
+    collator.setCaseSensitivity(Qt::CaseInsensitive);
+    std::sort(fileNames.begin(), fileNames.end(), collator);
+
+    // photo.png and photo.jpg would both become photo.<format>; the second keeps its suffix in the name.
+    const QDir output(m_options.outputDir);
+    const QString suffix = QString::fromLatin1(m_options.format);
+    QSet<QString> outputNames;
+    QVector<Job> jobs;
+    for (const QString& fileName : std::as_const(fileNames)) {
+        QString outputName = QFileInfo(fileName).completeBaseName() + '.' + suffix;
+        if (outputNames.contains(outputName))
+            outputName = fileName + '.' + suffix;
+        outputNames.insert(outputName);
+        jobs.append(Job{input.absoluteFilePath(fileName), output.absoluteFilePath(outputName)});
+    }
+    return jobs;
+}
+
+qint64 BatchProcessor::estimateCostKb(const QString &filePath) const
+{
+    const QSize sourceSize = QImageReader(filePath).size();
+    if (!sourceSize.isValid())
+        return qint64(mApp::BATCH_UNKNOWN_SIZE_MB) * 1024;
+
+    // Conservative: codecs without scaled or region decoding hold the whole image.
+    QSize outputSize = m_options.crop.isValid() ? m_options.crop.size().boundedTo(sourceSize) : sourceSize;
+    if (m_options.maxSize.isValid()
+        && (outputSize.width() > m_options.maxSize.width() || outputSize.height() > m_options.maxSize.height()))
+        outputSize = outputSize.scaled(m_options.maxSize, Qt::KeepAspectRatio);
+
+    const qint64 pixels = qint64(sourceSize.width()) * sourceSize.height()
+            + qint64(outputSize.width()) * outputSize.height();
+    return pixels * 4 / 1024 + 1;
+}
+
+BatchProcessor::JobResult BatchProcessor::process(const Job &job) const
+{
+    JobResult result;
+    result.inputBytes = QFileInfo(job.inputPath).size();
+
+    QElapsedTimer clock;
+    clock.start();
+
+    QImage image;
+    if (m_options.crop.isValid()) {
+        // Region decode where the codec has it, turned upright like the uncropped path, then fit.
+        const int orientation = ExifReader::readFile(job.inputPath).orientation;
+        const CropExporter::Result crop = CropExporter::readRegion(job.inputPath, m_options.crop, QString(), orientation);
+        if (!crop.error.isEmpty()) {
+            result.error = crop.error;
+            return result;
+        }
+        image = crop.image;
+        if (m_options.maxSize.isValid()
+            && (image.width() > m_options.maxSize.width() || image.height() > m_options.maxSize.height()))
+            image = ImageResampler::scaled(image, image.size().scaled(m_options.maxSize, Qt::KeepAspectRatio));
+    } else {
+        // Scaled decode where the codec has it; without a size limit this is a plain decode.
+        const ImageDecoder::Result decoded = ImageDecoder::decodeToFit(job.inputPath, m_options.maxSize);
+        if (!decoded.error.isEmpty()) {
+            result.error = decoded.error;
+            return result;
+        }
+        image = decoded.image;
+    }
+    result.decodeUs = clock.nsecsElapsed() / 1000;
+
+    clock.restart();
+    QImageWriter writer(job.outputPath, m_options.format);
+    writer.setQuality(m_options.quality);
+    if (!writer.write(image)) {
+        result.error = writer.errorString();
+        return result;
+    }
+    result.encodeUs = clock.nsecsElapsed() / 1000;
+    result.outputBytes = QFileInfo(job.outputPath).size();
+    return result;
+}
+
+bool BatchProcessor::run(Stats *stats)
+{
+    QTextStream err(stderr);
+
+    if (!QImageWriter::supportedImageFormats().contains(m_options.format)) {
+        err << "Unsupported output format: " << m_options.format << '\n';
+        return false;
+    }
+    if (!QFileInfo(m_options.inputDir).isDir()) {
+        err << "Not a directory: " << m_options.inputDir << '\n';
+        return false;
+    }
+    if (QFileInfo(m_options.inputDir).canonicalFilePath() == QFileInfo(m_options.outputDir).canonicalFilePath()) {
+        err << "The output directory must differ from the input directory\n";
+        return false;
+    }
+    if (!QDir().mkpath(m_options.outputDir)) {
+        err << "Cannot create " << m_options.outputDir << '\n';
+        return false;
+    }
+
+    const QVector<Job> jobs = listJobs();
+    if (jobs.isEmpty()) {
+        err << "No images in " << m_options.inputDir << '\n';
+        return false;
+    }
+
+    // Batch tasks and the resampler's row tiles share one pool; when every worker is busy with
+    // an image, the tiles run on the worker itself, so the pool is never oversubscribed.
+    QThreadPool* pool = QThreadPool::globalInstance();
+    if (m_options.threads > 0)
+        pool->setMaxThreadCount(m_options.threads);
+    stats->threads = pool->maxThreadCount();
+
+    const int budgetKb = qMax(1, m_options.memoryMb) * 1024;
+    QSemaphore budget(budgetKb);
+    QMutex mutex;
+
+    QElapsedTimer clock;
+    clock.start();
+    QElapsedTimer progressClock;
+    progressClock.start();
+    const int total = jobs.size();
+
+    for (const Job& job : jobs) {
+        // Reserved before queueing, so queued images hold no pixels. One larger than the budget runs alone.
+        const int costKb = int(qMin<qint64>(estimateCostKb(job.inputPath), budgetKb));
+        budget.acquire(costKb);
+
+        pool->start([this, job, costKb, total, stats, &budget, &mutex, &progressClock]() {
+            const JobResult result = process(job);
+
+            // Only written images count towards throughput.
+            QMutexLocker locker(&mutex);
+            if (result.error.isEmpty()) {
+                ++stats->images;
+                stats->inputBytes += result.inputBytes;
+                stats->outputBytes += result.outputBytes;
+                stats->decodeUs += result.decodeUs;
+                stats->encodeUs += result.encodeUs;
+            } else {
+                ++stats->failed;
+                QTextStream(stderr) << job.inputPath << ": " << result.error << '\n';
+            }
+            budget.release(costKb);
+
+            // Reported as images finish, so progress continues through the tail of the run.
+            if (progressClock.hasExpired(mApp::BATCH_PROGRESS_INTERVAL_MS)) {
+                QTextStream(stderr) << stats->images + stats->failed << '/' << total << " images\n";
+                progressClock.restart();
+            }
+        });
+    }
+
+    pool->waitForDone();
+    stats->elapsedUs = clock.nsecsElapsed() / 1000;
+    return true;
+}
@@ -0,0 +1,85 @@
+#ifndef BATCHPROCESSOR_H
+#define BATCHPROCESSOR_H
+
+#include <QByteArray>
+#include <QRect>
+#include <QSize>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+namespace mApp {
+const int BATCH_DEFAULT_QUALITY = 90;
+const int BATCH_DEFAULT_MEMORY_MB = 512;    // decoded pixels in flight across all workers
+const int BATCH_UNKNOWN_SIZE_MB = 64;       // reserved for images without a readable header size
+const int BATCH_PROGRESS_INTERVAL_MS = 1000;
+}
+
+struct BatchOptions
+{
+    QString inputDir;
+    QString outputDir;
+    QByteArray format = "jpg";
+    int quality = mApp::BATCH_DEFAULT_QUALITY;
+    QSize maxSize;              // fit within, never upscale; invalid: keep the size
+    QRect crop;                 // in upright source pixels (EXIF orientation applied), before resizing; invalid: whole image
+    int threads = 0;            // 0: one per core
+    int memoryMb = mApp::BATCH_DEFAULT_MEMORY_MB;
+};
+
+/*
+ * Headless crop/resize/convert of every image in a directory, for
+ * miniMedia --batch. Each image is one task on the global thread pool
+ * (decode -> transform -> encode), so the stages of different images
+ * overlap and idle workers take the next image. Decoding goes through the
+ * viewer's ImageDecoder (scaled decode) and CropExporter (region decode).
+ * A byte budget, reserved from the image headers before a task is queued,
+ * bounds the decoded pixels in flight.
+ */
+class BatchProcessor
+{
+public:
+    struct Stats {
+        int images = 0;         // written; bytes and times below cover these only
+        int failed = 0;
+        qint64 inputBytes = 0;
+        qint64 outputBytes = 0;
+        qint64 decodeUs = 0;    // decode and transform, summed over workers
+        qint64 encodeUs = 0;
+        qint64 elapsedUs = 0;
+        int threads = 0;
+    };
+
+    explicit BatchProcessor(const BatchOptions& options);
+
+    // Blocking; false if the options are unusable (reported on stderr).
+    bool run(Stats* stats);
+
+    // "WxH" and "x,y,w,h"; invalid results on malformed input.
+    static QSize parseSize(const QString& text);
+    static QRect parseRect(const QString& text);
+
+private:
+    struct Job {
+        QString inputPath;
+        QString outputPath;
+    };
+
+    struct JobResult {
+        qint64 inputBytes = 0;
+        qint64 outputBytes = 0;
+        qint64 decodeUs = 0;
+        qint64 encodeUs = 0;
+        QString error;
+    };
+
+    QVector<Job> listJobs() const;
+    // Decoded plus transformed pixels, from the header alone.
+    qint64 estimateCostKb(const QString& filePath) const;
+    // Runs on a worker.
+    JobResult process(const Job& job) const;
+
+    BatchOptions m_options;
+};
+
+#endif // BATCHPROCESSOR_H
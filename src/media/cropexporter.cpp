@@ -0,0 +1,118 @@
+#include "cropexporter.h"
+#include "bandreader.h"
+#include "exifreader.h"
+#include "tilepyramid.h"
+
+#include <QElapsedTimer>
+#include <QImageReader>
+#include <QImageWriter>
+#include <QPainter>
+
+#include <cstring>
+
+CropExporter::Result CropExporter::readRegion(const QString &filePath, const QRect &sourceRect, const QString &tileDirectory,
+                                              int orientation)
+{
+    Result result;
+    QElapsedTimer clock;
+    clock.start();
+
+    QImageReader reader(filePath);
+    const QSize sourceSize = reader.size();
+    const QRect storedRect = ExifReader::storedRect(sourceRect, orientation, sourceSize);
+    const QRect region = sourceSize.isValid() ? storedRect.intersected(QRect(QPoint(0, 0), sourceSize)) : storedRect;
+    if (region.isEmpty()) {
+        result.error = QStringLiteral("Crop rectangle is outside the image");
+        return result;
+    }
+
+    if (reader.supportsOption(QImageIOHandler::ClipRect)) {
+        result.method = Method_RegionRead;
+        reader.setClipRect(region);
+        result.image = reader.read();
+        if (result.image.isNull())
+            result.error = reader.errorString();
+        result.peakBytes = result.image.sizeInBytes();
+    } else if (!tileDirectory.isEmpty()) {
+        // Assembled tile by tile; only one tile is decoded at a time.
+        result.method = Method_PyramidTiles;
+        result.image = QImage(region.size(), QImage::Format_ARGB32_Premultiplied);
+        result.image.fill(Qt::transparent);
+        QPainter painter(&result.image);
+        painter.setCompositionMode(QPainter::CompositionMode_Source);
+
+        const int tileSize = mApp::PYRAMID_TILE_SIZE;
+        qint64 tileBytes = 0;
+        for (int row = region.top() / tileSize; row <= region.bottom() / tileSize && result.error.isEmpty(); ++row) {
+            for (int column = region.left() / tileSize; column <= region.right() / tileSize; ++column) {
+                const QImage tile(TilePyramid::tileFileName(tileDirectory, 0, column, row));
+                if (tile.isNull()) {
+                    result.error = QStringLiteral("Missing tile %1,%2 in %3").arg(column).arg(row).arg(tileDirectory);
+                    break;
+                }
+                tileBytes = qMax(tileBytes, tile.sizeInBytes());
+                painter.drawImage(QPoint(column * tileSize, row * tileSize) - region.topLeft(), tile);
+            }
+        }
+        painter.end();
+        result.peakBytes = result.image.sizeInBytes() + tileBytes;
+    } else {
+        // Rows above the region are skipped, rows below it never read; one band is held at a time.
+        BandReader bands(filePath);
+        if (!bands.open()) {
+            result.error = bands.errorString();
+        } else {
+            result.method = bands.method() == BandReader::Method_FullDecode ? Method_FullDecode : Method_BandStream;
+            result.image = QImage(region.size(), QImage::Format_ARGB32_Premultiplied);
+            if (result.image.isNull())
+                result.error = QStringLiteral("Not enough memory for a %1x%2 crop").arg(region.width()).arg(region.height());
+            const int bandRows = int(qBound<qint64>(1, mApp::CROP_BAND_BYTES / (qint64(bands.size().width()) * 4),
+                                                    region.height()));
+            qint64 bandBytes = 0;
+            for (int y = region.top(); y <= region.bottom() && result.error.isEmpty(); y += bandRows) {
+                const QImage band = bands.readRows(y, qMin(bandRows, region.bottom() + 1 - y));
+                if (band.isNull()) {
+                    result.error = bands.errorString();
+                    break;
+                }
+                bandBytes = qMax(bandBytes, band.sizeInBytes());
+                const QImage rows = band.copy(region.left(), 0, region.width(), band.height())
+                                        .convertToFormat(QImage::Format_ARGB32_Premultiplied);
+                for (int row = 0; row < rows.height(); ++row)
+                    std::memcpy(result.image.scanLine(y - region.top() + row), rows.constScanLine(row),
+                                size_t(result.image.bytesPerLine()));
+            }
+            result.peakBytes = result.image.sizeInBytes() + bandBytes;
+        }
+    }
+
+    if (!result.error.isEmpty())
+        result.image = QImage();
+    else
+        result.image = ExifReader::oriented(result.image, orientation);
+    result.decodeUs = clock.nsecsElapsed() / 1000;
+    return result;
+}
+
+CropExporter::Result CropExporter::exportRegion(const QString &filePath, const QRect &sourceRect,
+                                                const QString &tileDirectory, const QString &savePath, int orientation)
+{
+    Result result = readRegion(filePath, sourceRect, tileDirectory, orientation);
+    if (!result.error.isEmpty())
+        return result;
+
+    QElapsedTimer clock;
+    clock.start();
+
+    QImageWriter writer(savePath);
+    if (!writer.write(result.image))
+        result.error = writer.errorString();
+    result.encodeUs = clock.nsecsElapsed() / 1000;
+    return result;
+}
+
+const char *CropExporter::methodName(Method method)
+{
+    static const char* const names[] = {"region read", "pyramid tiles", "band stream", "full decode"};
+    return names[method];
+}
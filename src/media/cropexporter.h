@@ -0,0 +1,51 @@
+#ifndef CROPEXPORTER_H
+#define CROPEXPORTER_H
+
+#include <QImage>
+#include <QRect>
+#include <QString>
+
+namespace mApp {
+const qint64 CROP_BAND_BYTES = 64 * 1024 * 1024;   // source rows decoded at once when streaming
+}
+
+/*
+ * Reads a rectangle of an image file at source resolution, without
+ * decoding the rest of the image where possible: a region read when the
+ * codec supports ClipRect (JPEG), otherwise the level-0 tiles of a built
+ * TilePyramid, otherwise the rows of the region streamed in bands through
+ * BandReader. Only codecs that can do none of these are decoded whole, and
+ * only within BandReader's limit. sourceRect is in upright pixels of a
+ * photo with the given EXIF orientation; the stored pixels under it are
+ * read and the result is turned upright. Blocking; meant for the Qt
+ * Concurrent pool.
+ */
+class CropExporter
+{
+public:
+    enum Method {
+        Method_RegionRead = 0,
+        Method_PyramidTiles,
+        Method_BandStream,
+        Method_FullDecode
+    };
+
+    struct Result {
+        QImage image;
+        Method method = Method_FullDecode;
+        qint64 decodeUs = 0;
+        qint64 encodeUs = 0;
+        qint64 peakBytes = 0;   // estimated pixel memory held while reading
+        QString error;
+    };
+
+    // tileDirectory: level-0 tiles, in stored orientation, covering sourceRect, or empty.
+    static Result readRegion(const QString& filePath, const QRect& sourceRect, const QString& tileDirectory = QString(),
+                             int orientation = 1);
+    static Result exportRegion(const QString& filePath, const QRect& sourceRect, const QString& tileDirectory,
+                               const QString& savePath, int orientation = 1);
+
+    static const char* methodName(Method method);
+};
+
+#endif // CROPEXPORTER_H
@@ -0,0 +1,253 @@
+#include "exifreader.h"
+
+#include <QTransform>
+#include <QtEndian>
+
+#include <cstring>
+
+#include "src/common/fileheader.h"
+
+namespace {
+enum Tag : quint16 {
+    Tag_Make = 0x010F,
+    Tag_Model = 0x0110,
+    Tag_Orientation = 0x0112,
+    Tag_DateTime = 0x0132,
+    Tag_ThumbnailOffset = 0x0201,
+    Tag_ThumbnailLength = 0x0202,
+    Tag_ExposureTime = 0x829A,
+    Tag_FNumber = 0x829D,
+    Tag_ExifIfd = 0x8769,
+    Tag_Iso = 0x8827,
+    Tag_DateTimeOriginal = 0x9003,
+    Tag_FocalLength = 0x920A,
+    Tag_LensModel = 0xA434
+};
+
+const int IFD_ENTRY_SIZE = 12;
+
+// EXIF 2, 4, 5 and 7 mirror first; 3, 4 rotate by 180, 5, 8 by 270 and 6, 7 by 90 degrees clockwise.
+const int ORIENTATION_ROTATION[] = {0, 0, 0, 180, 180, 270, 90, 90, 270};
+
+bool isMirrored(int orientation)
+{
+    return orientation == 2 || orientation == 4 || orientation == 5 || orientation == 7;
+}
+
+/*
+ * Bounds-checked view of a TIFF structure; every offset is relative to
+ * the byte order mark at its start.
+ */
+class TiffView
+{
+public:
+    TiffView(const uchar* data, qint64 size)
+        : m_data(data)
+        , m_size(size)
+        , m_bigEndian(size >= 2 && data[0] == 'M')
+    {
+    }
+
+    bool contains(qint64 offset, qint64 count) const { return offset >= 0 && count >= 0 && offset + count <= m_size; }
+    const uchar* at(qint64 offset) const { return m_data + offset; }
+
+    quint16 u16(qint64 offset) const
+    {
+        return m_bigEndian ? qFromBigEndian<quint16>(m_data + offset) : qFromLittleEndian<quint16>(m_data + offset);
+    }
+    quint32 u32(qint64 offset) const
+    {
+        return m_bigEndian ? qFromBigEndian<quint32>(m_data + offset) : qFromLittleEndian<quint32>(m_data + offset);
+    }
+
+    // Values of up to four bytes sit in the entry itself, larger ones at an offset.
+    qint64 valueOffset(qint64 entry, qint64 bytes) const { return bytes <= 4 ? entry + 8 : u32(entry + 8); }
+
+    quint32 integer(qint64 entry) const
+    {
+        const quint16 type = u16(entry + 2);
+        return type == 3 ? u16(entry + 8) : u32(entry + 8); // SHORT or LONG
+    }
+
+    double rational(qint64 entry) const
+    {
+        const qint64 offset = valueOffset(entry, 8);
+        if (!contains(offset, 8) || u32(offset + 4) == 0)
+            return 0.0;
+        return double(u32(offset)) / u32(offset + 4);
+    }
+
+    QString ascii(qint64 entry) const
+    {
+        const qint64 count = u32(entry + 4);
+        const qint64 offset = valueOffset(entry, count);
+        if (!contains(offset, count))
+            return QString();
+        const char* text = reinterpret_cast<const char*>(at(offset));
+        return QString::fromLatin1(text, qstrnlen(text, size_t(count))).trimmed();
+    }
+
+    // Calls handle(tag, entry) for every entry of the IFD at offset; returns the next IFD offset or 0.
+    template <typename Handler>
+    quint32 forEachEntry(qint64 offset, Handler handle) const
+    {
+        if (offset < 8 || !contains(offset, 2))   // inside the header: damaged
+            return 0;
+        const int count = u16(offset);
+        if (!contains(offset + 2, qint64(count) * IFD_ENTRY_SIZE + 4))
+            return 0;
+        for (int i = 0; i < count; ++i) {
+            const qint64 entry = offset + 2 + qint64(i) * IFD_ENTRY_SIZE;
+            handle(u16(entry), entry);
+        }
+        return u32(offset + 2 + qint64(count) * IFD_ENTRY_SIZE);
+    }
+
+private:
+    const uchar* m_data;
+    qint64 m_size;
+    bool m_bigEndian;
+};
+}
+
+QImage ExifData::thumbnailImage() const
+{
+    if (thumbnail.isEmpty())
+        return QImage();
+    return ExifReader::oriented(QImage::fromData(thumbnail, "JPEG"), orientation);
+}
+
+ExifData ExifReader::readFile(const QString &filePath)
+{
+    const FileHeader header(filePath, mApp::EXIF_HEADER_BYTES);
+    return header.isEmpty() ? ExifData() : read(header.data(), header.size());
+}
+
+ExifData ExifReader::read(const uchar *data, qint64 size)
+{
+    ExifData exif;
+
+    // TIFF-based files carry the structure at the start.
+    if (size >= 4 && (std::memcmp(data, "II*\0", 4) == 0 || std::memcmp(data, "MM\0*", 4) == 0)) {
+        readTiff(data, size, &exif);
+        return exif;
+    }
+
+    if (size < 4 || data[0] != 0xFF || data[1] != 0xD8)
+        return exif;
+
+    // JPEG: walk the marker segments up to the image data.
+    qint64 pos = 2;
+    while (pos + 4 <= size && data[pos] == 0xFF) {
+        const uchar marker = data[pos + 1];
+        if (marker == 0xFF) {   // fill byte
+            ++pos;
+            continue;
+        }
+        if (marker == 0xDA || marker == 0xD9) // start of scan, end of image
+            break;
+
+        const qint64 length = (qint64(data[pos + 2]) << 8) | data[pos + 3];
+        const qint64 payload = pos + 4;
+        if (length < 2)
+            break;
+        if (marker == 0xE1 && length >= 8 && payload + 6 <= size && std::memcmp(data + payload, "Exif\0\0", 6) == 0) {
+            // The segment may run past the mapped window; the view stops at its end.
+            const qint64 tiffStart = payload + 6;
+            readTiff(data + tiffStart, qMin(length - 8, size - tiffStart), &exif);
+            break;
+        }
+        pos += 2 + length;
+    }
+    return exif;
+}
+
+void ExifReader::readTiff(const uchar *data, qint64 size, ExifData *exif)
+{
+    const TiffView tiff(data, size);
+    if (!tiff.contains(0, 8) || tiff.u16(2) != 42)
+        return;
+    exif->valid = true;
+
+    QString dateTime;
+    quint32 exifIfd = 0;
+    const quint32 ifd1 = tiff.forEachEntry(tiff.u32(4), [&](quint16 tag, qint64 entry) {
+        switch (tag) {
+        case Tag_Make: exif->make = tiff.ascii(entry); break;
+        case Tag_Model: exif->model = tiff.ascii(entry); break;
+        case Tag_DateTime: dateTime = tiff.ascii(entry); break;
+        case Tag_ExifIfd: exifIfd = tiff.integer(entry); break;
+        case Tag_Orientation: {
+            const int orientation = int(tiff.integer(entry));
+            exif->orientation = orientation >= 1 && orientation <= 8 ? orientation : 1;
+            break;
+        }
+        default: break;
+        }
+    });
+
+    QString dateTimeOriginal;
+    if (exifIfd) {
+        tiff.forEachEntry(exifIfd, [&](quint16 tag, qint64 entry) {
+            switch (tag) {
+            case Tag_ExposureTime: exif->exposureSeconds = tiff.rational(entry); break;
+            case Tag_FNumber: exif->fNumber = tiff.rational(entry); break;
+            case Tag_FocalLength: exif->focalLengthMm = tiff.rational(entry); break;
+            case Tag_Iso: exif->iso = int(tiff.integer(entry)); break;
+            case Tag_DateTimeOriginal: dateTimeOriginal = tiff.ascii(entry); break;
+            case Tag_LensModel: exif->lens = tiff.ascii(entry); break;
+            default: break;
+            }
+        });
+    }
+    exif->captureTime = QDateTime::fromString(dateTimeOriginal.isEmpty() ? dateTime : dateTimeOriginal,
+                                              QStringLiteral("yyyy:MM:dd HH:mm:ss"));
+
+    // IFD1 describes the thumbnail.
+    if (ifd1) {
+        quint32 offset = 0, length = 0;
+        tiff.forEachEntry(ifd1, [&](quint16 tag, qint64 entry) {
+            if (tag == Tag_ThumbnailOffset)
+                offset = tiff.integer(entry);
+            else if (tag == Tag_ThumbnailLength)
+                length = tiff.integer(entry);
+        });
+        if (length > 2 && tiff.contains(offset, length) && tiff.at(offset)[0] == 0xFF && tiff.at(offset)[1] == 0xD8)
+            exif->thumbnail = QByteArray(reinterpret_cast<const char*>(tiff.at(offset)), length);
+    }
+}
+
+QImage ExifReader::oriented(const QImage &image, int orientation)
+{
+    if (image.isNull() || orientation < 2 || orientation > 8)
+        return image;
+
+    QImage result = isMirrored(orientation) ? image.mirrored(true, false) : image;
+    if (ORIENTATION_ROTATION[orientation])
+        result = result.transformed(QTransform().rotate(ORIENTATION_ROTATION[orientation]));
+    return result;
+}
+
+QTransform ExifReader::transform(int orientation, const QSize &storedSize)
+{
+    if (orientation < 2 || orientation > 8)
+        return QTransform();
+
+    // Same steps as oriented(), on pixel edges: mirror, then turn clockwise.
+    const qreal width = storedSize.width();
+    const qreal height = storedSize.height();
+    const QTransform mirror = isMirrored(orientation) ? QTransform(-1, 0, 0, 1, width, 0) : QTransform();
+    switch (ORIENTATION_ROTATION[orientation]) {
+    case 90: return mirror * QTransform(0, 1, -1, 0, height, 0);
+    case 180: return mirror * QTransform(-1, 0, 0, -1, width, height);
+    case 270: return mirror * QTransform(0, -1, 1, 0, 0, width);
+    default: return mirror;
+    }
+}
+
+QRect ExifReader::storedRect(const QRect &uprightRect, int orientation, const QSize &storedSize)
+{
+    if (orientation < 2 || orientation > 8 || !storedSize.isValid())
+        return uprightRect;
+    return transform(orientation, storedSize).inverted().mapRect(QRectF(uprightRect)).toAlignedRect();
+}
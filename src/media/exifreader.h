@@ -0,0 +1,62 @@
+#ifndef EXIFREADER_H
+#define EXIFREADER_H
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QImage>
+#include <QRect>
+#include <QString>
+#include <QTransform>
+
+namespace mApp {
+const qint64 EXIF_HEADER_BYTES = 128 * 1024; // the APP1 segment is at most 64 KB, after SOI and maybe JFIF
+}
+
+/*
+ * The EXIF fields the viewer shows, plus the embedded JPEG thumbnail.
+ * orientation is the EXIF value, 1 (as stored) to 8.
+ */
+struct ExifData
+{
+    bool valid = false;
+    int orientation = 1;
+    QString make;
+    QString model;
+    QString lens;
+    QDateTime captureTime;
+    double exposureSeconds = 0.0;
+    double fNumber = 0.0;
+    double focalLengthMm = 0.0;
+    int iso = 0;
+    QByteArray thumbnail;       // JPEG, empty when there is none
+
+    // Decoded and turned upright.
+    QImage thumbnailImage() const;
+};
+
+/*
+ * EXIF parser for JPEG APP1 segments and TIFF headers. readFile() only
+ * looks at the first EXIF_HEADER_BYTES of the file through FileHeader
+ * (mapped, or read where mapping fails), which covers the metadata and
+ * the thumbnail of camera and phone JPEGs; the image data is never read.
+ * Offsets are bounds-checked, a damaged header just yields fewer fields.
+ */
+class ExifReader
+{
+public:
+    static ExifData readFile(const QString& filePath);
+    static ExifData read(const uchar* data, qint64 size);
+
+    // Applies an EXIF orientation, e.g. 6 turns the image 90 degrees clockwise.
+    static QImage oriented(const QImage& image, int orientation);
+    // The same as a mapping from stored to upright pixel coordinates.
+    static QTransform transform(int orientation, const QSize& storedSize);
+    // An upright rectangle in the stored image, where tiles and region reads live.
+    static QRect storedRect(const QRect& uprightRect, int orientation, const QSize& storedSize);
+    static bool isTransposed(int orientation) { return orientation >= 5 && orientation <= 8; }
+
+private:
+    static void readTiff(const uchar* data, qint64 size, ExifData* exif);
+};
+
+#endif // EXIFREADER_H
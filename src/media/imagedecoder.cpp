@@ -0,0 +1,243 @@
+#include "imagedecoder.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QImageReader>
+#include <QTransform>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <cstring>
+
+#include "bandreader.h"
+#include "imageresampler.h"
+
+namespace {
+
+// Codecs whose scaled decode skips work: JPEG scales in the DCT.
+bool hasReducedDecode(const QByteArray& format)
+{
+    return format == "jpeg" || format == "jpg";
+}
+
+// Codecs BandReader reads row by row. Qt's PNG handler offers ScaledSize, but decodes the whole image for it.
+bool isStreamable(const QByteArray& format)
+{
+    return format == "png" || format == "tiff" || format == "tif";
+}
+
+} // namespace
+
+ImageDecoder::ImageDecoder(QObject *parent)
+    : QObject(parent)
+{
+}
+
+ImageDecoder::~ImageDecoder()
+{
+    cancel();
+}
+
+void ImageDecoder::decode(const QString &filePath, const QSize &targetSize)
+{
+    cancel();
+
+    auto* watcher = new QFutureWatcher<Result>(this);
+    m_watcher = watcher;
+    connect(watcher, &QFutureWatcher<Result>::resultReadyAt, this, [this, watcher](int index) {
+        handleResult(watcher, index);
+    });
+    connect(watcher, &QFutureWatcher<Result>::finished, this, [this, watcher]() {
+        if (watcher == m_watcher)
+            m_watcher = nullptr;
+    });
+    connect(watcher, &QFutureWatcher<Result>::finished, watcher, &QObject::deleteLater);
+    watcher->setFuture(QtConcurrent::run(&ImageDecoder::run, filePath, targetSize));
+}
+
+void ImageDecoder::cancel()
+{
+    if (!m_watcher)
+        return;
+
+    // The running stage finishes on the pool, the next one is skipped; results are ignored.
+    m_watcher->disconnect(this);
+    m_watcher->cancel();
+    m_watcher = nullptr;
+}
+
+void ImageDecoder::handleResult(QFutureWatcher<Result> *watcher, int index)
+{
+    if (watcher != m_watcher)
+        return;
+
+    const Result result = watcher->resultAt(index);
+    if (!result.error.isEmpty()) {
+        emit decodeFailed(result.filePath, result.error);
+        return;
+    }
+
+    qInfo() << Q_FUNC_INFO << (result.preview ? "Preview" : "Image") << result.filePath
+            << result.sourceSize << "->" << result.image.size()
+            << "decoded in" << result.decodeUs / 1000.0 << "ms, peak"
+            << result.peakBytes / 1024 << "KB (full decode"
+            << qint64(result.sourceSize.width()) * result.sourceSize.height() * 4 / 1024 << "KB)";
+
+    if (result.preview)
+        emit previewReady(result.filePath, result.image);
+    else
+        emit imageReady(result.filePath, result.image, result.sourceSize);
+}
+
+QSize ImageDecoder::orientedSize(QImageReader &reader)
+{
+    // Sizes are given upright: a portrait photo stored sideways reports its height as width.
+    const QSize size = reader.size();
+    return reader.transformation() & QImageIOHandler::TransformationRotate90 ? size.transposed() : size;
+}
+
+void ImageDecoder::run(QPromise<Result> &promise, const QString &filePath, const QSize &targetSize)
+{
+    QImageReader reader(filePath);
+    const QSize sourceSize = orientedSize(reader);
+    const QSize displaySize = fittedSize(sourceSize, targetSize);
+
+    // A preview only pays off when the codec skips the work for it.
+    const bool wantPreview = hasReducedDecode(reader.format()) && sourceSize.isValid()
+                             && sourceSize.width() >= displaySize.width() * mApp::IMAGE_PREVIEW_MIN_SOURCE_FACTOR
+                             && sourceSize.height() >= displaySize.height() * mApp::IMAGE_PREVIEW_MIN_SOURCE_FACTOR;
+
+    if (wantPreview) {
+        const QSize previewSize = (displaySize / mApp::IMAGE_PREVIEW_DIVISOR).expandedTo(QSize(1, 1));
+        promise.addResult(readScaled(filePath, previewSize, true));
+        if (promise.isCanceled())
+            return;
+    }
+
+    promise.addResult(readScaled(filePath, displaySize, false));
+}
+
+ImageDecoder::Result ImageDecoder::decodeToFit(const QString &filePath, const QSize &targetSize, bool parallel)
+{
+    QImageReader reader(filePath);
+    return readScaled(filePath, fittedSize(orientedSize(reader), targetSize), false, parallel);
+}
+
+QSize ImageDecoder::fittedSize(const QSize &sourceSize, const QSize &targetSize)
+{
+    // Fit into the target, never upscale. Without a header size the target is the bound.
+    if (!sourceSize.isValid())
+        return targetSize;
+    if (targetSize.isValid()
+        && (sourceSize.width() > targetSize.width() || sourceSize.height() > targetSize.height()))
+        return sourceSize.scaled(targetSize, Qt::KeepAspectRatio);
+    return sourceSize;
+}
+
+ImageDecoder::Result ImageDecoder::readScaled(const QString &filePath, const QSize &scaledSize, bool preview, bool parallel)
+{
+    Result result;
+    result.filePath = filePath;
+    result.preview = preview;
+
+    QElapsedTimer clock;
+    clock.start();
+
+    // EXIF orientation is applied after decoding, so the codec scales the image as stored.
+    QImageReader reader(filePath);
+    reader.setAutoTransform(true);
+    const bool transposed = reader.transformation() & QImageIOHandler::TransformationRotate90;
+    result.sourceSize = orientedSize(reader);
+    const QByteArray format = reader.format();
+    const bool streamable = isStreamable(format);
+    const bool canScale = reader.supportsOption(QImageIOHandler::ScaledSize) && !streamable;
+
+    if (canScale && result.sourceSize.isValid() && scaledSize.isValid() && scaledSize != result.sourceSize)
+        reader.setScaledSize(transposed ? scaledSize.transposed() : scaledSize);
+
+    // Too large to hold at once: read in bands, scale each band down.
+    const bool streamed = streamable && result.sourceSize.isValid() && scaledSize.isValid()
+                          && (scaledSize.width() < result.sourceSize.width() || scaledSize.height() < result.sourceSize.height())
+                          && qint64(result.sourceSize.width()) * result.sourceSize.height() * 4
+                                 > qint64(mApp::IMAGE_STREAM_DECODE_MB) * 1024 * 1024;
+
+    qint64 peakBytes = 0;
+    QImage image;
+    if (streamed) {
+        image = readStreamed(filePath, transposed ? scaledSize.transposed() : scaledSize, parallel, &peakBytes, &result.error);
+        if (image.isNull())
+            return result;
+        // BandReader reads the image as stored; turn it like autoTransform would.
+        const QImageIOHandler::Transformations transformation = reader.transformation();
+        image = image.mirrored(transformation & QImageIOHandler::TransformationMirror,
+                               transformation & QImageIOHandler::TransformationFlip);
+        if (transposed)
+            image = image.transformed(QTransform().rotate(90));
+    } else {
+        image = reader.read();
+        if (image.isNull()) {
+            result.error = reader.errorString();
+            return result;
+        }
+        peakBytes = image.sizeInBytes();
+    }
+
+    if (!result.sourceSize.isValid())
+        result.sourceSize = image.size();
+
+    // Codecs without scaled decoding hand back the full image; scale it here, off the GUI thread.
+    if (scaledSize.isValid() && (image.width() > scaledSize.width() || image.height() > scaledSize.height())) {
+        const QSize size = image.size().scaled(scaledSize, Qt::KeepAspectRatio);
+        image = ImageResampler::scaled(image, size, ImageResampler::filterFor(image.size(), size), parallel);
+        peakBytes += image.sizeInBytes();
+    }
+
+    result.image = image;
+    result.peakBytes = peakBytes;
+    result.decodeUs = clock.nsecsElapsed() / 1000;
+    return result;
+}
+
+QImage ImageDecoder::readStreamed(const QString &filePath, const QSize &scaledSize, bool parallel,
+                                  qint64 *peakBytes, QString *error)
+{
+    BandReader reader(filePath);
+    if (!reader.open()) {
+        *error = reader.errorString();
+        return QImage();
+    }
+
+    const QSize sourceSize = reader.size();
+    const QSize outputSize = sourceSize.scaled(scaledSize, Qt::KeepAspectRatio).expandedTo(QSize(1, 1));
+    QImage image(outputSize, QImage::Format_ARGB32_Premultiplied);
+    if (image.isNull()) {
+        *error = QStringLiteral("Not enough memory for a %1x%2 image").arg(outputSize.width()).arg(outputSize.height());
+        return QImage();
+    }
+
+    // Each band covers the output rows its source rows map to; rounding is shared, so bands meet exactly.
+    const int bandRows = int(qBound<qint64>(1, mApp::IMAGE_STREAM_BAND_BYTES / (qint64(sourceSize.width()) * 4), sourceSize.height()));
+    qint64 bandBytes = 0;
+    for (int y = 0; y < sourceSize.height(); y += bandRows) {
+        const int rows = qMin(bandRows, sourceSize.height() - y);
+        const int top = int(qint64(y) * outputSize.height() / sourceSize.height());
+        const int bottom = int(qint64(y + rows) * outputSize.height() / sourceSize.height());
+        if (bottom == top)
+            continue;   // nothing of this band survives the scaling; the reader skips its rows
+
+        const QImage band = reader.readRows(y, rows);
+        if (band.isNull()) {
+            *error = reader.errorString();
+            return QImage();
+        }
+        bandBytes = qMax(bandBytes, band.sizeInBytes());
+
+        const QImage scaled = ImageResampler::scaled(band.convertToFormat(QImage::Format_ARGB32_Premultiplied),
+                                                     QSize(outputSize.width(), bottom - top), ImageResampler::Filter_Area,
+                                                     parallel);
+        for (int row = 0; row < scaled.height(); ++row)
+            std::memcpy(image.scanLine(top + row), scaled.constScanLine(row), size_t(image.bytesPerLine()));
+    }
+
+    *peakBytes = image.sizeInBytes() + bandBytes;
+    return image;
+}
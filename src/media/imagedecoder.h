@@ -0,0 +1,75 @@
+#ifndef IMAGEDECODER_H
+#define IMAGEDECODER_H
+
+#include <QObject>
+#include <QFutureWatcher>
+#include <QImage>
+#include <QPromise>
+#include <QSize>
+#include <QString>
+
+class QImageReader;
+
+namespace mApp {
+const int IMAGE_PREVIEW_DIVISOR = 4;      // preview edge = target edge / divisor
+const int IMAGE_PREVIEW_MIN_SOURCE_FACTOR = 2; // no preview unless the source is this much larger
+const int IMAGE_STREAM_DECODE_MB = 256;   // larger PNG and TIFF sources are decoded in bands (QImageReader's default limit)
+const qint64 IMAGE_STREAM_BAND_BYTES = 64 * 1024 * 1024;
+}
+
+/*
+ * Decodes images for display on the Qt Concurrent pool.
+ *
+ * QImageReader decodes straight to the display size (setScaledSize), so
+ * codecs with their own scaling - JPEG's DCT scaling - never build the
+ * full-resolution image. For large JPEGs a quarter-size preview is
+ * delivered first and the display-size image follows. Only the latest
+ * request is delivered; older ones are cancelled between stages. PNG and
+ * TIFF have no reduced decode (Qt's PNG scaling decodes the whole image
+ * first); above IMAGE_STREAM_DECODE_MB they are read in bands through
+ * BandReader and downscaled band by band.
+ * Images come out upright, turned by their EXIF orientation.
+ */
+class ImageDecoder : public QObject
+{
+    Q_OBJECT
+public:
+    struct Result {
+        QString filePath;
+        QImage image;
+        QSize sourceSize;
+        bool preview = false;
+        qint64 decodeUs = 0;
+        qint64 peakBytes = 0;   // estimated pixel memory held while decoding
+        QString error;
+    };
+
+    explicit ImageDecoder(QObject* parent = nullptr);
+    ~ImageDecoder();
+
+    void decode(const QString& filePath, const QSize& targetSize);
+    void cancel();
+
+    // Blocking, display-size decode without preview; for callers already off the GUI thread.
+    // parallel: false keeps the resampling on the calling thread, off the global pool.
+    static Result decodeToFit(const QString& filePath, const QSize& targetSize, bool parallel = true);
+
+signals:
+    void previewReady(const QString& filePath, const QImage& image);
+    void imageReady(const QString& filePath, const QImage& image, const QSize& sourceSize);
+    void decodeFailed(const QString& filePath, const QString& error);
+
+private:
+    static void run(QPromise<Result>& promise, const QString& filePath, const QSize& targetSize);
+    static Result readScaled(const QString& filePath, const QSize& scaledSize, bool preview, bool parallel = true);
+    static QImage readStreamed(const QString& filePath, const QSize& scaledSize, bool parallel,
+                               qint64* peakBytes, QString* error);
+    static QSize fittedSize(const QSize& sourceSize, const QSize& targetSize);
+    static QSize orientedSize(QImageReader& reader);
+
+    void handleResult(QFutureWatcher<Result>* watcher, int index);
+
+    QFutureWatcher<Result>* m_watcher = nullptr;
+};
+
+#endif // IMAGEDECODER_H
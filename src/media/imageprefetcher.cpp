@@ -0,0 +1,102 @@
+#include "imageprefetcher.h"
+
+#include <QDebug>
+#include <QtConcurrent/QtConcurrentRun>
+
+ImagePrefetcher::ImagePrefetcher(QObject *parent)
+    : QObject(parent)
+{
+    m_pool.setMaxThreadCount(mApp::IMAGE_PREFETCH_THREADS);
+    setBudget(mApp::IMAGE_CACHE_DEFAULT_BUDGET);
+}
+
+ImagePrefetcher::~ImagePrefetcher()
+{
+    // Queued decodes are dropped; the pool waits for the ones already running.
+    for (auto* watcher : std::as_const(m_pending))
+        watcher->cancel();
+    m_pool.clear();
+}
+
+void ImagePrefetcher::setBudget(qint64 bytes)
+{
+    m_cache.setMaxCost(int(qMax<qint64>(0, bytes / 1024)));
+}
+
+double ImagePrefetcher::hitRate() const
+{
+    const int lookups = m_hits + m_misses;
+    return lookups > 0 ? double(m_hits) / lookups : 0.0;
+}
+
+QString ImagePrefetcher::cacheKey(const QString &filePath, const QSize &targetSize)
+{
+    return QStringLiteral("%1@%2x%3").arg(filePath).arg(targetSize.width()).arg(targetSize.height());
+}
+
+bool ImagePrefetcher::lookup(const QString &filePath, const QSize &targetSize, Entry *entry)
+{
+    const Entry* cached = m_cache.object(cacheKey(filePath, targetSize));
+    if (cached) {
+        ++m_hits;
+        *entry = *cached;
+    } else {
+        ++m_misses;
+    }
+
+    qInfo() << Q_FUNC_INFO << (cached ? "Hit" : "Miss") << filePath << "- hit rate"
+            << qRound(hitRate() * 100) << "% (" << m_hits << "/" << m_hits + m_misses << "), "
+            << usedBytes() / (1024 * 1024) << "of" << budget() / (1024 * 1024) << "MB";
+    return cached != nullptr;
+}
+
+void ImagePrefetcher::insert(const QString &filePath, const QSize &targetSize, const QPixmap &pixmap, const QSize &sourceSize)
+{
+    if (pixmap.isNull())
+        return;
+
+    const int costKb = int(qMax<qint64>(1, qint64(pixmap.width()) * pixmap.height() * pixmap.depth() / 8 / 1024));
+    m_cache.insert(cacheKey(filePath, targetSize), new Entry{pixmap, sourceSize}, costKb);
+}
+
+void ImagePrefetcher::prefetch(const QStringList &filePaths, const QSize &targetSize)
+{
+    // Only the latest neighbourhood matters; queued work for anything else is dropped.
+    QStringList wanted;
+    for (const QString& filePath : filePaths) {
+        if (!m_cache.contains(cacheKey(filePath, targetSize)))
+            wanted << cacheKey(filePath, targetSize);
+    }
+    for (auto it = m_pending.begin(); it != m_pending.end();) {
+        if (!wanted.contains(it.key())) {
+            it.value()->disconnect(this);
+            it.value()->cancel();
+            it = m_pending.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    for (const QString& filePath : filePaths) {
+        const QString key = cacheKey(filePath, targetSize);
+        if (!wanted.contains(key) || m_pending.contains(key))
+            continue;
+
+        auto* watcher = new QFutureWatcher<ImageDecoder::Result>(this);
+        m_pending.insert(key, watcher);
+        connect(watcher, &QFutureWatcher<ImageDecoder::Result>::finished, this, [this, watcher, key, targetSize]() {
+            m_pending.remove(key);
+            if (!watcher->isCanceled() && watcher->future().resultCount() > 0) {
+                ImageDecoder::Result result = watcher->result();
+                if (result.error.isEmpty()) {
+                    // Converted here, on arrival, so a hit costs no conversion when it is shown.
+                    insert(result.filePath, targetSize, QPixmap::fromImage(std::move(result.image)), result.sourceSize);
+                    qDebug() << Q_FUNC_INFO << "Prefetched" << result.filePath << "in" << result.decodeUs / 1000 << "ms";
+                }
+            }
+        });
+        connect(watcher, &QFutureWatcher<ImageDecoder::Result>::finished, watcher, &QObject::deleteLater);
+        // Resampling stays on the prefetch thread; the global pool belongs to the image being opened.
+        watcher->setFuture(QtConcurrent::run(&m_pool, &ImageDecoder::decodeToFit, filePath, targetSize, false));
+    }
+}
@@ -0,0 +1,65 @@
+#ifndef IMAGEPREFETCHER_H
+#define IMAGEPREFETCHER_H
+
+#include <QObject>
+#include <QCache>
+#include <QFutureWatcher>
+#include <QHash>
+#include <QPixmap>
+#include <QSize>
+#include <QStringList>
+#include <QThreadPool>
+
+#include "imagedecoder.h"
+
+namespace mApp {
+const qint64 IMAGE_CACHE_DEFAULT_BUDGET = 256 * 1024 * 1024;
+const int IMAGE_PREFETCH_THREADS = 2;
+const int IMAGE_PREFETCH_AHEAD = 2;
+const int IMAGE_PREFETCH_BEHIND = 1;
+}
+
+/*
+ * LRU cache of display-size images for folder browsing, bounded by a
+ * memory budget, plus background prefetch of the images the user is
+ * likely to open next. Prefetching runs on its own small pool so it
+ * never delays the image that is being opened. Entries are keyed by
+ * path and display size; a resize simply misses and refills.
+ * Hits and misses of lookup() are counted for tuning the budget and
+ * the prefetch distance.
+ */
+class ImagePrefetcher : public QObject
+{
+    Q_OBJECT
+public:
+    struct Entry {
+        QPixmap pixmap;
+        QSize sourceSize;
+    };
+
+    explicit ImagePrefetcher(QObject* parent = nullptr);
+    ~ImagePrefetcher();
+
+    void setBudget(qint64 bytes);
+    qint64 budget() const { return qint64(m_cache.maxCost()) * 1024; }
+    qint64 usedBytes() const { return qint64(m_cache.totalCost()) * 1024; }
+
+    bool lookup(const QString& filePath, const QSize& targetSize, Entry* entry);
+    void insert(const QString& filePath, const QSize& targetSize, const QPixmap& pixmap, const QSize& sourceSize);
+    void prefetch(const QStringList& filePaths, const QSize& targetSize);
+
+    int hits() const { return m_hits; }
+    int misses() const { return m_misses; }
+    double hitRate() const;
+
+private:
+    static QString cacheKey(const QString& filePath, const QSize& targetSize);
+
+    QCache<QString, Entry> m_cache;
+    QThreadPool m_pool;
+    QHash<QString, QFutureWatcher<ImageDecoder::Result>*> m_pending;
+    int m_hits = 0;
+    int m_misses = 0;
+};
+
+#endif // IMAGEPREFETCHER_H
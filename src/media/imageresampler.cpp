@@ -0,0 +1,279 @@
+#include "imageresampler.h"
+
+#include <QVarLengthArray>
+#include <QVector>
+#include <QtConcurrent/QtConcurrentMap>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "src/common/simd.h"
+
+namespace {
+const double PI = 3.14159265358979323846;
+const double LANCZOS_RADIUS = 3.0;
+// Byte of the alpha channel of a 32-bit ARGB pixel in memory.
+const int ALPHA_BYTE = Q_BYTE_ORDER == Q_LITTLE_ENDIAN ? 3 : 0;
+
+/*
+ * Filter taps along one axis: output pixel i reads count source pixels
+ * from first[i] on. Every output has the same (zero-padded) tap count and
+ * its window lies inside the source, so the inner loops need no checks.
+ */
+struct Taps
+{
+    int count = 0;
+    QVector<int> first;
+    QVector<float> weights;     // count per output pixel
+};
+
+double kernel(ImageResampler::Filter filter, double x)
+{
+    x = std::abs(x);
+    if (filter == ImageResampler::Filter_Bilinear)
+        return x < 1.0 ? 1.0 - x : 0.0;
+
+    if (x < 1e-8)
+        return 1.0;
+    if (x >= LANCZOS_RADIUS)
+        return 0.0;
+    const double px = PI * x;
+    return LANCZOS_RADIUS * std::sin(px) * std::sin(px / LANCZOS_RADIUS) / (px * px);
+}
+
+Taps computeTaps(int sourceSize, int size, ImageResampler::Filter filter)
+{
+    const double scale = double(sourceSize) / size;     // source pixels per output pixel
+    const double stretch = std::max(1.0, scale);        // kernels widen when shrinking
+    const double support = (filter == ImageResampler::Filter_Bilinear ? 1.0 : LANCZOS_RADIUS) * stretch;
+
+    // Source pixels an output pixel touches, before clamping to the image.
+    auto range = [&](int i, int* lo, int* hi) {
+        if (filter == ImageResampler::Filter_Area) {
+            *lo = int(std::floor(i * scale));
+            *hi = int(std::ceil((i + 1) * scale)) - 1;
+        } else {
+            const double center = (i + 0.5) * scale - 0.5;
+            *lo = int(std::ceil(center - support));
+            *hi = int(std::floor(center + support));
+        }
+    };
+
+    Taps taps;
+    int lo = 0, hi = 0;
+    for (int i = 0; i < size; ++i) {
+        range(i, &lo, &hi);
+        taps.count = std::max(taps.count, std::min(hi, sourceSize - 1) - std::max(lo, 0) + 1);
+    }
+    taps.first.resize(size);
+    taps.weights.fill(0.0f, qsizetype(size) * taps.count);
+
+    QVarLengthArray<double, 64> accum(taps.count);
+    for (int i = 0; i < size; ++i) {
+        range(i, &lo, &hi);
+        const int first = qBound(0, lo, sourceSize - taps.count);
+        const double center = (i + 0.5) * scale - 0.5;
+        std::fill(accum.begin(), accum.end(), 0.0);
+
+        double total = 0.0;
+        for (int j = lo; j <= hi; ++j) {
+            const double weight = filter == ImageResampler::Filter_Area
+                    ? std::max(0.0, std::min(j + 1.0, (i + 1) * scale) - std::max(double(j), i * scale))
+                    : kernel(filter, (j - center) / stretch);
+            // Edge pixels repeat past the border.
+            accum[qBound(0, j, sourceSize - 1) - first] += weight;
+            total += weight;
+        }
+
+        taps.first[i] = first;
+        float* weights = taps.weights.data() + qsizetype(i) * taps.count;
+        for (int k = 0; k < taps.count; ++k)
+            weights[k] = float(accum[k] / total);
+    }
+    return taps;
+}
+
+// One source row into width output pixels of four floats each.
+void horizontalPass(const uchar* source, float* out, const Taps& columns, int width)
+{
+    const int count = columns.count;
+    for (int x = 0; x < width; ++x) {
+        const float* weights = columns.weights.constData() + qsizetype(x) * count;
+        const uchar* pixels = source + columns.first.at(x) * 4;
+        int t = 0;
+
+#if defined(MINIMEDIA_HAVE_AVX2)
+        // Two taps per step: both pixels widened to eight floats at once.
+        __m256 acc2 = _mm256_setzero_ps();
+        for (; t + 2 <= count; t += 2) {
+            const __m128i pair = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(pixels + t * 4));
+            const __m256 values = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(pair));
+            const __m256 weight = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_set1_ps(weights[t])),
+                                                       _mm_set1_ps(weights[t + 1]), 1);
+            acc2 = _mm256_add_ps(acc2, _mm256_mul_ps(values, weight));
+        }
+        __m128 acc = _mm_add_ps(_mm256_castps256_ps128(acc2), _mm256_extractf128_ps(acc2, 1));
+        const __m128i zero = _mm_setzero_si128();
+#elif defined(MINIMEDIA_HAVE_SSE2)
+        __m128 acc = _mm_setzero_ps();
+        const __m128i zero = _mm_setzero_si128();
+        for (; t + 2 <= count; t += 2) {
+            const __m128i pair = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(pixels + t * 4)), zero);
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(pair, zero)), _mm_set1_ps(weights[t])));
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(pair, zero)), _mm_set1_ps(weights[t + 1])));
+        }
+#endif
+
+#ifdef MINIMEDIA_HAVE_SSE2
+        for (; t < count; ++t) {
+            int pixel;
+            std::memcpy(&pixel, pixels + t * 4, 4);
+            const __m128i wide = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(pixel), zero), zero);
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_cvtepi32_ps(wide), _mm_set1_ps(weights[t])));
+        }
+        _mm_storeu_ps(out + x * 4, acc);
+#else
+        float acc[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        for (; t < count; ++t) {
+            for (int c = 0; c < 4; ++c)
+                acc[c] += weights[t] * pixels[t * 4 + c];
+        }
+        std::memcpy(out + x * 4, acc, sizeof(acc));
+#endif
+    }
+}
+
+// Weighted sum of count float rows into one row of 8-bit pixels; no color ends up above its alpha.
+void verticalPass(const float* const* rows, const float* weights, int count, int floats, uchar* out)
+{
+    int i = 0;
+
+#ifdef MINIMEDIA_HAVE_AVX2
+    for (; i + 8 <= floats; i += 8) {
+        __m256 acc = _mm256_setzero_ps();
+        for (int k = 0; k < count; ++k)
+            acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_loadu_ps(rows[k] + i), _mm256_set1_ps(weights[k])));
+        acc = _mm256_min_ps(acc, _mm256_permute_ps(acc, 0xff));
+        const __m256i ints = _mm256_cvtps_epi32(acc);
+        const __m128i words = _mm_packs_epi32(_mm256_castsi256_si128(ints), _mm256_extracti128_si256(ints, 1));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(out + i), _mm_packus_epi16(words, words));
+    }
+#endif
+
+#ifdef MINIMEDIA_HAVE_SSE2
+    for (; i + 4 <= floats; i += 4) {
+        __m128 acc = _mm_setzero_ps();
+        for (int k = 0; k < count; ++k)
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(rows[k] + i), _mm_set1_ps(weights[k])));
+        acc = _mm_min_ps(acc, _mm_shuffle_ps(acc, acc, _MM_SHUFFLE(3, 3, 3, 3)));
+        const __m128i words = _mm_packs_epi32(_mm_cvtps_epi32(acc), _mm_setzero_si128());
+        const int pixel = _mm_cvtsi128_si32(_mm_packus_epi16(words, words));
+        std::memcpy(out + i, &pixel, 4);
+    }
+#endif
+
+    for (; i < floats; i += 4) {
+        float acc[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        for (int k = 0; k < count; ++k) {
+            for (int c = 0; c < 4; ++c)
+                acc[c] += weights[k] * rows[k][i + c];
+        }
+        for (int c = 0; c < 4; ++c)
+            out[i + c] = uchar(qBound(0, qRound(std::min(acc[c], acc[ALPHA_BYTE])), 255));
+    }
+}
+
+struct Planes
+{
+    const uchar* source;
+    qsizetype sourceStride;
+    uchar* result;
+    qsizetype resultStride;
+    int width;
+};
+
+// Output rows [y0, y1): the source rows they need go through the horizontal pass once.
+void resampleRows(const Planes& planes, const Taps& columns, const Taps& rows, int y0, int y1)
+{
+    const int floats = planes.width * 4;
+    const int firstRow = rows.first.at(y0);
+    const int endRow = rows.first.at(y1 - 1) + rows.count;
+
+    QVector<float> buffer(qsizetype(endRow - firstRow) * floats);
+    for (int y = firstRow; y < endRow; ++y)
+        horizontalPass(planes.source + y * planes.sourceStride, buffer.data() + qsizetype(y - firstRow) * floats,
+                       columns, planes.width);
+
+    QVarLengthArray<const float*, 64> taps(rows.count);
+    for (int y = y0; y < y1; ++y) {
+        for (int k = 0; k < rows.count; ++k)
+            taps[k] = buffer.constData() + qsizetype(rows.first.at(y) + k - firstRow) * floats;
+        verticalPass(taps.constData(), rows.weights.constData() + qsizetype(y) * rows.count, rows.count, floats,
+                     planes.result + y * planes.resultStride);
+    }
+}
+}
+
+QImage ImageResampler::scaled(const QImage &image, const QSize &size, Filter filter, bool parallel)
+{
+    if (image.isNull() || size.isEmpty())
+        return QImage();
+    if (size == image.size())
+        return image;
+
+    // Both passes work on 32-bit premultiplied pixels; opaque images stay RGB32.
+    const QImage source = image.format() == QImage::Format_RGB32 || image.format() == QImage::Format_ARGB32_Premultiplied
+            ? image
+            : image.convertToFormat(image.hasAlphaChannel() ? QImage::Format_ARGB32_Premultiplied : QImage::Format_RGB32);
+
+    QImage result(size, source.format());
+    if (result.isNull())
+        return QImage();
+    result.setColorSpace(source.colorSpace());
+
+    const Taps columns = computeTaps(source.width(), size.width(), filter);
+    const Taps rows = computeTaps(source.height(), size.height(), filter);
+    const Planes planes{source.constBits(), source.bytesPerLine(), result.bits(), result.bytesPerLine(), size.width()};
+
+    QVector<int> tiles;
+    for (int y = 0; y < size.height(); y += mApp::RESAMPLE_TILE_ROWS)
+        tiles << y;
+
+    auto runTile = [&](int y0) {
+        resampleRows(planes, columns, rows, y0, qMin(y0 + mApp::RESAMPLE_TILE_ROWS, size.height()));
+    };
+
+    if (parallel && qint64(size.width()) * size.height() >= mApp::RESAMPLE_PARALLEL_MIN_PIXELS)
+        QtConcurrent::blockingMap(tiles, runTile);
+    else
+        std::for_each(tiles.cbegin(), tiles.cend(), runTile);
+
+    return result;
+}
+
+QImage ImageResampler::scaled(const QImage &image, const QSize &size)
+{
+    return scaled(image, size, filterFor(image.size(), size));
+}
+
+QImage ImageResampler::fitted(const QImage &image, const QSize &logicalSize, qreal devicePixelRatio)
+{
+    const QSize deviceSize = image.size().scaled(logicalSize * devicePixelRatio, Qt::KeepAspectRatio);
+    QImage result = scaled(image, deviceSize);
+    result.setDevicePixelRatio(devicePixelRatio);
+    return result;
+}
+
+ImageResampler::Filter ImageResampler::filterFor(const QSize &from, const QSize &to)
+{
+    if (to.width() * 2 <= from.width() && to.height() * 2 <= from.height())
+        return Filter_Area;
+    return Filter_Lanczos3;
+}
+
+const char *ImageResampler::filterName(Filter filter)
+{
+    static const char* const names[] = {"area", "bilinear", "lanczos3"};
+    return names[filter];
+}
@@ -0,0 +1,40 @@
+#ifndef IMAGERESAMPLER_H
+#define IMAGERESAMPLER_H
+
+#include <QImage>
+#include <QSize>
+
+namespace mApp {
+const int RESAMPLE_TILE_ROWS = 32;                      // output rows per parallel job
+const int RESAMPLE_PARALLEL_MIN_PIXELS = 512 * 512;     // smaller outputs stay on the calling thread
+}
+
+/*
+ * Separable image scaler shared by the viewer, the capture preview and the
+ * cropper. Filter weights are computed once per output row and column; the
+ * horizontal and vertical passes run in float on premultiplied pixels,
+ * vectorized with SSE2 or AVX2 when the build enables them, and the output
+ * is split into row tiles that run on the Qt Concurrent pool.
+ */
+class ImageResampler
+{
+public:
+    enum Filter {
+        Filter_Area = 0,    // exact pixel coverage; the choice for shrinking
+        Filter_Bilinear,
+        Filter_Lanczos3
+    };
+
+    // parallel: false keeps all work on the calling thread.
+    static QImage scaled(const QImage& image, const QSize& size, Filter filter, bool parallel = true);
+    static QImage scaled(const QImage& image, const QSize& size);
+
+    // Fits image into logicalSize at devicePixelRatio device pixels per logical pixel; the result carries the ratio.
+    static QImage fitted(const QImage& image, const QSize& logicalSize, qreal devicePixelRatio);
+
+    // Area when shrinking to half or less, Lanczos otherwise.
+    static Filter filterFor(const QSize& from, const QSize& to);
+    static const char* filterName(Filter filter);
+};
+
+#endif // IMAGERESAMPLER_H
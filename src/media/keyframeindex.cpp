@@ -0,0 +1,537 @@
+#include "keyframeindex.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QStandardPaths>
+
+#include <algorithm>
+#include <limits>
+
+namespace mApp {
+const quint32 KEYFRAME_INDEX_MAGIC = 0x4D4D4B49; // "MMKI"
+const quint32 KEYFRAME_INDEX_VERSION = 2;   // 2: presentation instead of decode times
+const qint64 KEYFRAME_HASH_CHUNK = 64 * 1024;
+const qint64 MP4_MAX_MOOV_SIZE = 64 * 1024 * 1024;
+}
+
+// ------------------------------- helpers ---------------------------------
+static quint32 readU32(const uchar* p)
+{
+    return (quint32(p[0]) << 24) | (quint32(p[1]) << 16) | (quint32(p[2]) << 8) | quint32(p[3]);
+}
+
+static quint64 readU64(const uchar* p)
+{
+    return (quint64(readU32(p)) << 32) | readU32(p + 4);
+}
+
+// ---------------------------------- MP4 -----------------------------------
+struct Mp4Box {
+    QByteArray type;
+    int payloadBegin = 0;
+    int end = 0;
+};
+
+static QVector<Mp4Box> mp4Children(const QByteArray& data, int begin, int end)
+{
+    QVector<Mp4Box> boxes;
+    const uchar* base = reinterpret_cast<const uchar*>(data.constData());
+
+    int pos = begin;
+    while (pos + 8 <= end) {
+        quint64 size = readU32(base + pos);
+        int header = 8;
+        if (size == 1) {
+            if (pos + 16 > end)
+                break;
+            size = readU64(base + pos + 8);
+            header = 16;
+        } else if (size == 0) {
+            size = quint64(end - pos);
+        }
+        if (size < quint64(header) || size > quint64(end - pos))
+            break;
+
+        boxes.append({data.mid(pos + 4, 4), pos + header, pos + int(size)});
+        pos += int(size);
+    }
+    return boxes;
+}
+
+// mvhd and mdhd share the layout up to the timescale.
+static quint32 readMp4Timescale(const uchar* base, const Mp4Box& header)
+{
+    if (header.end - header.payloadBegin < 1)
+        return 0;
+    const int timescaleOffset = base[header.payloadBegin] == 1 ? 20 : 12;
+    if (header.end - header.payloadBegin < timescaleOffset + 4)
+        return 0;
+    return readU32(base + header.payloadBegin + timescaleOffset);
+}
+
+static bool findMp4Box(const QByteArray& data, int begin, int end, const char* type, Mp4Box* box)
+{
+    const QVector<Mp4Box> children = mp4Children(data, begin, end);
+    for (const Mp4Box& child : children) {
+        if (child.type == type) {
+            *box = child;
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+ * Presentation time shift of a track from its edit list, in media
+ * timescale ticks: leading empty edits delay the track, the first media
+ * edit skips media_time ticks. No edit list, no shift.
+ */
+static qint64 mp4EditShift(const QByteArray& moov, const Mp4Box& trak, quint32 movieTimescale, quint32 mediaTimescale)
+{
+    const uchar* base = reinterpret_cast<const uchar*>(moov.constData());
+    Mp4Box edts, elst;
+    if (!findMp4Box(moov, trak.payloadBegin, trak.end, "edts", &edts)
+        || !findMp4Box(moov, edts.payloadBegin, edts.end, "elst", &elst)
+        || elst.end - elst.payloadBegin < 8)
+        return 0;
+
+    const bool wide = base[elst.payloadBegin] == 1;
+    const int entrySize = wide ? 20 : 12;
+    const quint32 count = qMin<quint32>(readU32(base + elst.payloadBegin + 4),
+                                        quint32((elst.end - elst.payloadBegin - 8) / entrySize));
+    qint64 delayTicks = 0;   // movie timescale
+    for (quint32 i = 0; i < count; ++i) {
+        const uchar* entry = base + elst.payloadBegin + 8 + i * entrySize;
+        const quint64 duration = wide ? readU64(entry) : readU32(entry);
+        const qint64 mediaTime = wide ? qint64(readU64(entry + 8)) : qint64(qint32(readU32(entry + 4)));
+        if (mediaTime == -1) {
+            delayTicks += qint64(duration);
+            continue;
+        }
+        const qint64 delay = movieTimescale > 0 ? delayTicks * mediaTimescale / movieTimescale : 0;
+        return delay - mediaTime;
+    }
+    return 0;
+}
+
+static bool scanMp4Track(const QByteArray& moov, const Mp4Box& trak, quint32 movieTimescale, QVector<qint64>* timestamps)
+{
+    const uchar* base = reinterpret_cast<const uchar*>(moov.constData());
+
+    Mp4Box mdia, hdlr, mdhd, minf, stbl, stts, stss, ctts;
+    if (!findMp4Box(moov, trak.payloadBegin, trak.end, "mdia", &mdia)
+        || !findMp4Box(moov, mdia.payloadBegin, mdia.end, "hdlr", &hdlr)
+        || hdlr.end - hdlr.payloadBegin < 12
+        || moov.mid(hdlr.payloadBegin + 8, 4) != "vide")
+        return false;
+
+    if (!findMp4Box(moov, mdia.payloadBegin, mdia.end, "mdhd", &mdhd)
+        || !findMp4Box(moov, mdia.payloadBegin, mdia.end, "minf", &minf)
+        || !findMp4Box(moov, minf.payloadBegin, minf.end, "stbl", &stbl)
+        || !findMp4Box(moov, stbl.payloadBegin, stbl.end, "stts", &stts))
+        return false;
+
+    const quint32 timescale = readMp4Timescale(base, mdhd);
+    if (timescale == 0)
+        return false;
+    const qint64 editShift = mp4EditShift(moov, trak, movieTimescale, timescale);
+
+    if (stts.end - stts.payloadBegin < 8)
+        return false;
+    const quint32 sttsCount = qMin<quint32>(readU32(base + stts.payloadBegin + 4),
+                                            quint32((stts.end - stts.payloadBegin - 8) / 8));
+
+    // Without an stss box every sample is a sync sample.
+    const bool allSync = !findMp4Box(moov, stbl.payloadBegin, stbl.end, "stss", &stss);
+    quint32 stssCount = 0;
+    if (!allSync && stss.end - stss.payloadBegin >= 8)
+        stssCount = qMin<quint32>(readU32(base + stss.payloadBegin + 4),
+                                  quint32((stss.end - stss.payloadBegin - 8) / 4));
+
+    // Composition offsets per run of samples; offsets are signed in practice even in version 0.
+    quint32 cttsCount = 0;
+    if (findMp4Box(moov, stbl.payloadBegin, stbl.end, "ctts", &ctts) && ctts.end - ctts.payloadBegin >= 8)
+        cttsCount = qMin<quint32>(readU32(base + ctts.payloadBegin + 4), quint32((ctts.end - ctts.payloadBegin - 8) / 8));
+    quint32 cttsIdx = 0;
+    quint64 cttsRunEnd = cttsCount > 0 ? quint64(readU32(base + ctts.payloadBegin + 8)) + 1 : 0;   // first sample past the run
+    // Samples are visited in increasing order, so the ctts run only moves forward.
+    const auto presentationMs = [&](quint64 sample, quint64 decodeTicks) {
+        while (cttsIdx < cttsCount && sample >= cttsRunEnd && ++cttsIdx < cttsCount)
+            cttsRunEnd += readU32(base + ctts.payloadBegin + 8 + cttsIdx * 8);
+        const qint64 offset = cttsIdx < cttsCount ? qint32(readU32(base + ctts.payloadBegin + 12 + cttsIdx * 8)) : 0;
+        return qMax<qint64>(0, (qint64(decodeTicks) + offset + editShift) * 1000 / qint64(timescale));
+    };
+
+    quint32 syncIdx = 0;
+    quint64 sampleNumber = 1; // stss sample numbers are 1-based
+    quint64 decodeTime = 0;
+    for (quint32 i = 0; i < sttsCount; ++i) {
+        const uchar* entry = base + stts.payloadBegin + 8 + i * 8;
+        const quint32 sampleCount = readU32(entry);
+        const quint32 sampleDelta = readU32(entry + 4);
+
+        if (allSync) {
+            for (quint32 s = 0; s < sampleCount; ++s)
+                timestamps->append(presentationMs(sampleNumber + s, decodeTime + quint64(s) * sampleDelta));
+        } else {
+            while (syncIdx < stssCount) {
+                const quint64 syncSample = readU32(base + stss.payloadBegin + 8 + syncIdx * 4);
+                if (syncSample >= sampleNumber + sampleCount)
+                    break;
+                if (syncSample >= sampleNumber)
+                    timestamps->append(presentationMs(syncSample, decodeTime + (syncSample - sampleNumber) * sampleDelta));
+                ++syncIdx;
+            }
+        }
+
+        sampleNumber += sampleCount;
+        decodeTime += quint64(sampleCount) * sampleDelta;
+    }
+    return true;
+}
+
+static bool scanMp4(QFile& file, QVector<qint64>* timestamps)
+{
+    const qint64 fileSize = file.size();
+    qint64 pos = 0;
+
+    // Walk the top-level boxes without touching mdat, only moov is read.
+    while (pos + 8 <= fileSize) {
+        if (!file.seek(pos))
+            return false;
+        const QByteArray header = file.read(16);
+        if (header.size() < 8)
+            return false;
+
+        const uchar* p = reinterpret_cast<const uchar*>(header.constData());
+        quint64 size = readU32(p);
+        if (size == 1 && header.size() == 16)
+            size = readU64(p + 8);
+        else if (size == 0)
+            size = quint64(fileSize - pos);
+        if (size < 8)
+            return false;
+
+        if (header.mid(4, 4) == "moov") {
+            if (qint64(size) > mApp::MP4_MAX_MOOV_SIZE)
+                return false;
+            file.seek(pos);
+            const QByteArray moov = file.read(qint64(size));
+            const int moovHeader = readU32(p) == 1 ? 16 : 8;
+
+            Mp4Box mvhd;
+            const quint32 movieTimescale = findMp4Box(moov, moovHeader, moov.size(), "mvhd", &mvhd)
+                                               ? readMp4Timescale(reinterpret_cast<const uchar*>(moov.constData()), mvhd)
+                                               : 0;
+            const QVector<Mp4Box> children = mp4Children(moov, moovHeader, moov.size());
+            for (const Mp4Box& child : children) {
+                if (child.type == "trak" && scanMp4Track(moov, child, movieTimescale, timestamps))
+                    return true;
+            }
+            return false;
+        }
+        pos += qint64(size);
+    }
+    return false;
+}
+
+// -------------------------------- Matroska --------------------------------
+namespace mApp {
+const quint32 EBML_ID_HEADER = 0x1A45DFA3;
+const quint32 EBML_ID_SEGMENT = 0x18538067;
+const quint32 EBML_ID_SEEKHEAD = 0x114D9B74;
+const quint32 EBML_ID_SEEK = 0x4DBB;
+const quint32 EBML_ID_SEEKID = 0x53AB;
+const quint32 EBML_ID_SEEKPOSITION = 0x53AC;
+const quint32 EBML_ID_INFO = 0x1549A966;
+const quint32 EBML_ID_TIMECODESCALE = 0x2AD7B1;
+const quint32 EBML_ID_CLUSTER = 0x1F43B675;
+const quint32 EBML_ID_CUES = 0x1C53BB6B;
+const quint32 EBML_ID_CUEPOINT = 0xBB;
+const quint32 EBML_ID_CUETIME = 0xB3;
+const quint64 EBML_UNKNOWN_SIZE = std::numeric_limits<quint64>::max();
+}
+
+static bool readEbmlVint(QFile& file, quint64* value, bool keepMarker, bool* unknown = nullptr)
+{
+    char c;
+    if (!file.getChar(&c))
+        return false;
+
+    const uchar first = uchar(c);
+    int length = 1;
+    uchar mask = 0x80;
+    while (length <= 8 && !(first & mask)) {
+        mask >>= 1;
+        ++length;
+    }
+    if (length > 8)
+        return false;
+
+    quint64 v = keepMarker ? first : (first & (mask - 1));
+    bool allOnes = (first & (mask - 1)) == (mask - 1);
+    for (int i = 1; i < length; ++i) {
+        if (!file.getChar(&c))
+            return false;
+        v = (v << 8) | uchar(c);
+        allOnes = allOnes && uchar(c) == 0xFF;
+    }
+
+    if (unknown)
+        *unknown = allOnes;
+    *value = v;
+    return true;
+}
+
+static bool readEbmlHeader(QFile& file, quint32* id, quint64* size)
+{
+    quint64 rawId = 0;
+    bool unknown = false;
+    if (!readEbmlVint(file, &rawId, true) || !readEbmlVint(file, size, false, &unknown))
+        return false;
+    *id = quint32(rawId);
+    if (unknown)
+        *size = mApp::EBML_UNKNOWN_SIZE;
+    return true;
+}
+
+static quint64 readEbmlUInt(QFile& file, quint64 size)
+{
+    const QByteArray bytes = file.read(qint64(qMin<quint64>(size, 8)));
+    quint64 v = 0;
+    for (char c : bytes)
+        v = (v << 8) | uchar(c);
+    return v;
+}
+
+static void scanMatroskaCues(QFile& file, qint64 end, QVector<qint64>* cueTimes)
+{
+    quint32 id;
+    quint64 size;
+    while (file.pos() < end && readEbmlHeader(file, &id, &size)) {
+        if (size == mApp::EBML_UNKNOWN_SIZE)
+            return;
+        const qint64 elementEnd = file.pos() + qint64(size);
+
+        if (id == mApp::EBML_ID_CUEPOINT) {
+            while (file.pos() < elementEnd && readEbmlHeader(file, &id, &size)) {
+                const qint64 childEnd = file.pos() + qint64(size);
+                if (id == mApp::EBML_ID_CUETIME) {
+                    cueTimes->append(qint64(readEbmlUInt(file, size)));
+                    break;
+                }
+                file.seek(childEnd);
+            }
+        }
+        file.seek(elementEnd);
+    }
+}
+
+static qint64 scanMatroskaSeekHead(QFile& file, qint64 end, qint64 segmentStart)
+{
+    quint32 id;
+    quint64 size;
+    while (file.pos() < end && readEbmlHeader(file, &id, &size)) {
+        const qint64 seekEnd = file.pos() + qint64(size);
+        if (id == mApp::EBML_ID_SEEK) {
+            quint64 seekId = 0, seekPos = 0;
+            while (file.pos() < seekEnd && readEbmlHeader(file, &id, &size)) {
+                if (id == mApp::EBML_ID_SEEKID)
+                    seekId = readEbmlUInt(file, size);
+                else if (id == mApp::EBML_ID_SEEKPOSITION)
+                    seekPos = readEbmlUInt(file, size);
+                else
+                    file.seek(file.pos() + qint64(size));
+            }
+            if (seekId == mApp::EBML_ID_CUES)
+                return segmentStart + qint64(seekPos);
+        }
+        file.seek(seekEnd);
+    }
+    return -1;
+}
+
+static bool scanMatroska(QFile& file, QVector<qint64>* timestamps)
+{
+    quint32 id;
+    quint64 size;
+
+    file.seek(0);
+    if (!readEbmlHeader(file, &id, &size) || id != mApp::EBML_ID_HEADER)
+        return false;
+    file.seek(file.pos() + qint64(size));
+
+    if (!readEbmlHeader(file, &id, &size) || id != mApp::EBML_ID_SEGMENT)
+        return false;
+
+    const qint64 segmentStart = file.pos();
+    const qint64 segmentEnd = size == mApp::EBML_UNKNOWN_SIZE ? file.size() : segmentStart + qint64(size);
+
+    quint64 timecodeScale = 1000000; // ns per tick
+    qint64 cuesPosition = -1;
+    QVector<qint64> cueTimes;
+
+    while (file.pos() < segmentEnd && readEbmlHeader(file, &id, &size)) {
+        const qint64 dataStart = file.pos();
+
+        if (id == mApp::EBML_ID_CUES) {
+            scanMatroskaCues(file, dataStart + qint64(size), &cueTimes);
+            break;
+        }
+        // Cues usually live after the clusters: jump there instead of walking them.
+        if (id == mApp::EBML_ID_CLUSTER) {
+            if (cuesPosition < 0 || !file.seek(cuesPosition) || !readEbmlHeader(file, &id, &size)
+                || id != mApp::EBML_ID_CUES)
+                break;
+            scanMatroskaCues(file, file.pos() + qint64(size), &cueTimes);
+            break;
+        }
+        if (size == mApp::EBML_UNKNOWN_SIZE)
+            break;
+
+        const qint64 dataEnd = dataStart + qint64(size);
+        if (id == mApp::EBML_ID_SEEKHEAD) {
+            cuesPosition = scanMatroskaSeekHead(file, dataEnd, segmentStart);
+        } else if (id == mApp::EBML_ID_INFO) {
+            while (file.pos() < dataEnd && readEbmlHeader(file, &id, &size)) {
+                if (id == mApp::EBML_ID_TIMECODESCALE)
+                    timecodeScale = readEbmlUInt(file, size);
+                else
+                    file.seek(file.pos() + qint64(size));
+            }
+        }
+        file.seek(dataEnd);
+    }
+
+    for (qint64 cueTime : std::as_const(cueTimes))
+        timestamps->append(qint64(quint64(cueTime) * timecodeScale / 1000000));
+
+    return !cueTimes.isEmpty();
+}
+
+// ------------------------------ KeyframeIndex -----------------------------
+qint64 KeyframeIndex::nearestKeyframe(qint64 positionMs) const
+{
+    if (m_timestampsMs.isEmpty())
+        return positionMs;
+
+    auto it = std::lower_bound(m_timestampsMs.cbegin(), m_timestampsMs.cend(), positionMs);
+    if (it == m_timestampsMs.cend())
+        return m_timestampsMs.last();
+    if (it == m_timestampsMs.cbegin())
+        return *it;
+
+    const qint64 after = *it;
+    const qint64 before = *(it - 1);
+    return (positionMs - before) <= (after - positionMs) ? before : after;
+}
+
+qint64 KeyframeIndex::keyframeAtOrBefore(qint64 positionMs) const
+{
+    if (m_timestampsMs.isEmpty())
+        return positionMs;
+
+    // Before the first keyframe there is none to snap back to; the position itself is at or before.
+    auto it = std::upper_bound(m_timestampsMs.cbegin(), m_timestampsMs.cend(), positionMs);
+    return it == m_timestampsMs.cbegin() ? positionMs : *(it - 1);
+}
+
+KeyframeIndex KeyframeIndex::scan(const QString &filePath)
+{
+    KeyframeIndex index;
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << Q_FUNC_INFO << "Cannot open" << filePath;
+        return index;
+    }
+
+    const QByteArray magic = file.peek(12);
+    bool scanned = false;
+    if (magic.mid(4, 4) == "ftyp" || magic.mid(4, 4) == "moov")
+        scanned = scanMp4(file, &index.m_timestampsMs);
+    else if (magic.startsWith(QByteArray::fromHex("1A45DFA3")))
+        scanned = scanMatroska(file, &index.m_timestampsMs);
+
+    if (!scanned) {
+        qDebug() << Q_FUNC_INFO << "No keyframe table found in" << filePath;
+        index.m_timestampsMs.clear();
+        return index;
+    }
+
+    std::sort(index.m_timestampsMs.begin(), index.m_timestampsMs.end());
+    index.m_timestampsMs.erase(std::unique(index.m_timestampsMs.begin(), index.m_timestampsMs.end()),
+                               index.m_timestampsMs.end());
+    index.m_timestampsMs.squeeze();
+    return index;
+}
+
+QString KeyframeIndex::contentHash(const QString &filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly))
+        return QString();
+
+    // Size plus head and tail is enough to tell files apart without reading them.
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(QByteArray::number(file.size()));
+    hash.addData(file.read(mApp::KEYFRAME_HASH_CHUNK));
+    if (file.size() > 2 * mApp::KEYFRAME_HASH_CHUNK) {
+        file.seek(file.size() - mApp::KEYFRAME_HASH_CHUNK);
+        hash.addData(file.read(mApp::KEYFRAME_HASH_CHUNK));
+    }
+    return QString::fromLatin1(hash.result().toHex());
+}
+
+QString KeyframeIndex::cacheFilePath(const QString &hash)
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation)
+           + "/keyframes/" + hash + ".idx";
+}
+
+bool KeyframeIndex::loadCached(const QString &hash, KeyframeIndex *index)
+{
+    if (hash.isEmpty())
+        return false;
+
+    QFile file(cacheFilePath(hash));
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream in(&file);
+    quint32 magic = 0, version = 0;
+    in >> magic >> version;
+    if (magic != mApp::KEYFRAME_INDEX_MAGIC || version != mApp::KEYFRAME_INDEX_VERSION)
+        return false;
+
+    QVector<qint64> timestamps;
+    in >> timestamps;
+    if (in.status() != QDataStream::Ok)
+        return false;
+
+    index->m_timestampsMs = timestamps;
+    return true;
+}
+
+bool KeyframeIndex::saveCached(const QString &hash) const
+{
+    if (hash.isEmpty())
+        return false;
+
+    const QString path = cacheFilePath(hash);
+    QDir().mkpath(QFileInfo(path).absolutePath());
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << Q_FUNC_INFO << "Cannot write keyframe cache" << path;
+        return false;
+    }
+
+    QDataStream out(&file);
+    out << mApp::KEYFRAME_INDEX_MAGIC << mApp::KEYFRAME_INDEX_VERSION << m_timestampsMs;
+    return out.status() == QDataStream::Ok;
+}
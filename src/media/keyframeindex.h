@@ -0,0 +1,39 @@
+#ifndef KEYFRAMEINDEX_H
+#define KEYFRAMEINDEX_H
+
+#include <QString>
+#include <QVector>
+
+/*
+ * Sorted presentation timestamps (ms) of the keyframes of a media file.
+ * Built once by scanning the container's own index (MP4 sample tables
+ * with composition offsets and edit list, Matroska cues) and cached on
+ * disk under a hash of the file content.
+ */
+class KeyframeIndex
+{
+public:
+    KeyframeIndex() = default;
+
+    bool isEmpty() const { return m_timestampsMs.isEmpty(); }
+    int size() const { return m_timestampsMs.size(); }
+    const QVector<qint64>& timestamps() const { return m_timestampsMs; }
+
+    // O(log n) lookups; return positionMs unchanged when the index is empty,
+    // keyframeAtOrBefore() also when no keyframe is at or before it.
+    qint64 nearestKeyframe(qint64 positionMs) const;
+    qint64 keyframeAtOrBefore(qint64 positionMs) const;
+
+    static KeyframeIndex scan(const QString& filePath);
+
+    static QString contentHash(const QString& filePath);
+    static bool loadCached(const QString& hash, KeyframeIndex* index);
+    bool saveCached(const QString& hash) const;
+
+private:
+    static QString cacheFilePath(const QString& hash);
+
+    QVector<qint64> m_timestampsMs;
+};
+
+#endif // KEYFRAMEINDEX_H
@@ -0,0 +1,58 @@
+#include "keyframeindexer.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QtConcurrent/QtConcurrentRun>
+
+KeyframeIndexer::KeyframeIndexer(QObject* parent)
+    : QObject(parent)
+    , m_watcher(new QFutureWatcher<KeyframeIndex>(this))
+{
+    connect(m_watcher, &QFutureWatcher<KeyframeIndex>::finished, this, [this]() {
+        const QString path = m_watcher->property("filePath").toString();
+        if (path != m_currentPath || m_watcher->isCanceled())
+            return; // a newer file was requested meanwhile
+
+        emit indexReady(path, m_watcher->result());
+    });
+}
+
+KeyframeIndexer::~KeyframeIndexer()
+{
+    m_watcher->waitForFinished();
+}
+
+void KeyframeIndexer::indexFile(const QString &filePath)
+{
+    m_currentPath = filePath;
+
+    m_watcher->setProperty("filePath", filePath);
+    m_watcher->setFuture(QtConcurrent::run(&KeyframeIndexer::loadOrScan, filePath));
+}
+
+void KeyframeIndexer::cancel()
+{
+    m_currentPath.clear();
+}
+
+KeyframeIndex KeyframeIndexer::loadOrScan(const QString &filePath)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    const QString hash = KeyframeIndex::contentHash(filePath);
+
+    KeyframeIndex index;
+    if (KeyframeIndex::loadCached(hash, &index)) {
+        qDebug() << Q_FUNC_INFO << "Loaded cached keyframe index for" << filePath
+                 << "(" << index.size() << "keyframes," << timer.elapsed() << "ms)";
+        return index;
+    }
+
+    index = KeyframeIndex::scan(filePath);
+    index.saveCached(hash); // empty indexes are cached too, so unsupported files aren't rescanned
+
+    qDebug() << Q_FUNC_INFO << "Indexed" << filePath
+             << "(" << index.size() << "keyframes," << timer.elapsed() << "ms)";
+    return index;
+}
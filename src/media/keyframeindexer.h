@@ -0,0 +1,35 @@
+#ifndef KEYFRAMEINDEXER_H
+#define KEYFRAMEINDEXER_H
+
+#include <QObject>
+#include <QFutureWatcher>
+#include <QString>
+
+#include "keyframeindex.h"
+
+/*
+ * Builds KeyframeIndex objects off the GUI thread.
+ * A file whose content hash is already cached is never rescanned.
+ * Only the result for the most recently requested file is reported.
+ */
+class KeyframeIndexer : public QObject
+{
+    Q_OBJECT
+public:
+    explicit KeyframeIndexer(QObject* parent = nullptr);
+    ~KeyframeIndexer();
+
+    void indexFile(const QString& filePath);
+    void cancel();
+
+signals:
+    void indexReady(const QString& filePath, const KeyframeIndex& index);
+
+private:
+    static KeyframeIndex loadOrScan(const QString& filePath);
+
+    QFutureWatcher<KeyframeIndex>* m_watcher = nullptr;
+    QString m_currentPath;
+};
+
+#endif // KEYFRAMEINDEXER_H
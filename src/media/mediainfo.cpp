@@ -0,0 +1,19 @@
+#include "mediainfo.h"
+
+QDataStream& operator<<(QDataStream& out, const MediaInfo& info)
+{
+    out << info.filePath << info.size << info.modifiedMs
+        << info.probed << info.probeFailed << info.hasVideo << info.durationMs << info.resolution
+        << info.videoCodec << info.audioCodec << info.audioLanguages
+        << info.title << info.artist << info.album;
+    return out;
+}
+
+QDataStream& operator>>(QDataStream& in, MediaInfo& info)
+{
+    in >> info.filePath >> info.size >> info.modifiedMs
+       >> info.probed >> info.probeFailed >> info.hasVideo >> info.durationMs >> info.resolution
+       >> info.videoCodec >> info.audioCodec >> info.audioLanguages
+       >> info.title >> info.artist >> info.album;
+    return in;
+}
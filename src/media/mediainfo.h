@@ -0,0 +1,38 @@
+#ifndef MEDIAINFO_H
+#define MEDIAINFO_H
+
+#include <QDataStream>
+#include <QSize>
+#include <QString>
+#include <QStringList>
+
+/*
+ * Probed description of one media file, as stored in the library index.
+ * size/modifiedMs identify the file version the probe belongs to.
+ */
+struct MediaInfo
+{
+    QString filePath;
+    qint64 size = 0;
+    qint64 modifiedMs = 0;
+
+    bool probed = false;        // false: probe failed or still pending
+    bool probeFailed = false;   // not playable as this size/modifiedMs; not probed again until it changes
+    bool hasVideo = false;
+    qint64 durationMs = 0;
+    QSize resolution;
+    QString videoCodec;
+    QString audioCodec;
+    QStringList audioLanguages;
+
+    QString title;
+    QString artist;
+    QString album;
+
+    bool isValid() const { return !filePath.isEmpty(); }
+};
+
+QDataStream& operator<<(QDataStream& out, const MediaInfo& info);
+QDataStream& operator>>(QDataStream& in, MediaInfo& info);
+
+#endif // MEDIAINFO_H
@@ -0,0 +1,249 @@
+#include "medialibrary.h"
+#include "mediaprober.h"
+#include "mediasniffer.h"
+
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QTimer>
+#include <QtConcurrent/QtConcurrentRun>
+
+namespace mApp {
+const quint32 LIBRARY_INDEX_MAGIC = 0x4D4D4C49; // "MMLI"
+const quint32 LIBRARY_INDEX_VERSION = 2;
+const int LIBRARY_SAVE_DELAY_MS = 2000;
+}
+
+MediaLibrary::MediaLibrary(QObject* parent)
+    : QObject(parent)
+    , m_prober(new MediaProber(this))
+    , m_watcher(new QFileSystemWatcher(this))
+    , m_saveTimer(new QTimer(this))
+    , m_loadWatcher(new QFutureWatcher<IndexData>(this))
+{
+    m_saveTimer->setSingleShot(true);
+    m_saveTimer->setInterval(mApp::LIBRARY_SAVE_DELAY_MS);
+    connect(m_saveTimer, &QTimer::timeout, this, &MediaLibrary::saveIndex);
+
+    connect(m_prober, &MediaProber::fileProbed, this, [this](const MediaInfo& info) {
+        const auto entryIt = m_entries.constFind(info.filePath);
+        if (entryIt == m_entries.cend() || entryIt->size != info.size || entryIt->modifiedMs != info.modifiedMs)
+            return; // removed or changed while it was being probed; a newer probe follows
+        m_entries.insert(info.filePath, info);
+        emit mediaInfoUpdated(info.filePath);
+        scheduleSave();
+    });
+
+    connect(m_watcher, &QFileSystemWatcher::directoryChanged, this, &MediaLibrary::rescanFolder);
+
+    connect(m_loadWatcher, &QFutureWatcher<IndexData>::finished, this, [this]() {
+        const IndexData data = m_loadWatcher->result();
+        const QStringList pendingFolders = m_folders;
+
+        m_entries = data.entries;
+        m_folders = data.folders;
+        m_loaded = true;
+        emit loaded();
+
+        // Catch up with whatever changed on disk while the app was closed.
+        for (const QString& folder : std::as_const(m_folders))
+            rescanFolder(folder);
+        for (const QString& folder : pendingFolders)
+            addFolder(folder);
+    });
+
+    m_loadWatcher->setFuture(QtConcurrent::run(&MediaLibrary::loadIndex, indexFilePath()));
+}
+
+MediaLibrary::~MediaLibrary()
+{
+    m_loadWatcher->waitForFinished();
+    if (m_saveTimer->isActive())
+        saveIndex();
+}
+
+void MediaLibrary::addFolder(const QString &folderPath)
+{
+    const QString folder = QDir(folderPath).absolutePath();
+
+    if (!m_loaded) {
+        if (!m_folders.contains(folder))
+            m_folders << folder; // picked up once the index is loaded
+        return;
+    }
+
+    if (!m_folders.contains(folder)) {
+        m_folders << folder;
+        scheduleSave();
+    }
+    rescanFolder(folder);
+}
+
+void MediaLibrary::rescanFolder(const QString &folderPath)
+{
+    if (!m_loaded)
+        return;
+    if (m_scansRunning.contains(folderPath)) {
+        // The running scan may have passed the change already.
+        m_rescansPending.insert(folderPath);
+        return;
+    }
+
+    m_scansRunning.insert(folderPath);
+
+    auto* watcher = new QFutureWatcher<ScanResult>(this);
+    connect(watcher, &QFutureWatcher<ScanResult>::finished, this, [this, watcher]() {
+        const ScanResult result = watcher->result();
+        m_scansRunning.remove(result.folderPath);
+        applyScanResult(result);
+        watcher->deleteLater();
+        if (m_rescansPending.remove(result.folderPath))
+            rescanFolder(result.folderPath);
+    });
+
+    // m_entries is implicitly shared, the worker reads a snapshot.
+    watcher->setFuture(QtConcurrent::run(&MediaLibrary::scanFolder, folderPath, m_entries));
+}
+
+bool MediaLibrary::isMediaFile(const QString &filePath)
+{
+    const MediaSniffer::Kind kind = MediaSniffer::sniffFile(filePath).kind;
+    return kind == MediaSniffer::Kind_Audio || kind == MediaSniffer::Kind_Video;
+}
+
+MediaLibrary::ScanResult MediaLibrary::scanFolder(const QString &folderPath, const QHash<QString, MediaInfo> &known)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    ScanResult result;
+    result.folderPath = folderPath;
+
+    QSet<QString> seen;
+    QDirIterator it(folderPath, QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        it.next();
+        const QFileInfo fileInfo = it.fileInfo();
+
+        if (fileInfo.isDir()) {
+            result.subFolders << fileInfo.absoluteFilePath();
+            continue;
+        }
+        const QString path = fileInfo.absoluteFilePath();
+        const qint64 size = fileInfo.size();
+        const qint64 modified = fileInfo.lastModified().toMSecsSinceEpoch();
+
+        // Unchanged since its probe, successful or not: no need to sniff it again. Entries whose
+        // probe is still pending are reported again; the prober does not queue them twice.
+        const auto knownIt = known.constFind(path);
+        if (knownIt != known.cend() && (knownIt->probed || knownIt->probeFailed)
+            && knownIt->size == size && knownIt->modifiedMs == modified) {
+            seen.insert(path);
+            continue;
+        }
+
+        if (!isMediaFile(path))
+            continue;
+        seen.insert(path);
+
+        MediaInfo info;
+        info.filePath = path;
+        info.size = size;
+        info.modifiedMs = modified;
+        result.changed << info;
+    }
+
+    const QString prefix = folderPath.endsWith('/') ? folderPath : folderPath + '/';
+    for (auto knownIt = known.cbegin(); knownIt != known.cend(); ++knownIt) {
+        if (knownIt.key().startsWith(prefix) && !seen.contains(knownIt.key()))
+            result.removed << knownIt.key();
+    }
+
+    qDebug() << Q_FUNC_INFO << "Scanned" << folderPath << "in" << timer.elapsed() << "ms:"
+             << result.changed.size() << "changed," << result.removed.size() << "removed";
+    return result;
+}
+
+void MediaLibrary::applyScanResult(const ScanResult &result)
+{
+    for (const QString& path : result.removed)
+        m_entries.remove(path);
+
+    for (const MediaInfo& info : result.changed) {
+        m_entries.insert(info.filePath, info);
+        m_prober->enqueue(info);
+    }
+
+    const QStringList watchedList = m_watcher->directories();
+    const QSet<QString> watched(watchedList.cbegin(), watchedList.cend());
+    QStringList toWatch = result.subFolders;
+    toWatch << result.folderPath;
+    toWatch.removeIf([&watched](const QString& dir) { return watched.contains(dir); });
+    if (!toWatch.isEmpty())
+        m_watcher->addPaths(toWatch);
+
+    if (!result.changed.isEmpty() || !result.removed.isEmpty())
+        scheduleSave();
+
+    emit scanFinished(result.folderPath, result.changed.size(), result.removed.size());
+}
+
+MediaLibrary::IndexData MediaLibrary::loadIndex(const QString &indexPath)
+{
+    IndexData data;
+
+    QFile file(indexPath);
+    if (!file.open(QIODevice::ReadOnly))
+        return data;
+
+    QDataStream in(&file);
+    quint32 magic = 0, version = 0;
+    in >> magic >> version;
+    if (magic != mApp::LIBRARY_INDEX_MAGIC || version != mApp::LIBRARY_INDEX_VERSION) {
+        qWarning() << Q_FUNC_INFO << "Ignoring incompatible library index" << indexPath;
+        return data;
+    }
+
+    in >> data.folders >> data.entries;
+    if (in.status() != QDataStream::Ok) {
+        qWarning() << Q_FUNC_INFO << "Corrupt library index" << indexPath;
+        return IndexData();
+    }
+    return data;
+}
+
+QString MediaLibrary::indexFilePath()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/library.idx";
+}
+
+void MediaLibrary::scheduleSave()
+{
+    m_saveTimer->start();
+}
+
+void MediaLibrary::saveIndex()
+{
+    m_saveTimer->stop();
+
+    const QString path = indexFilePath();
+    QDir().mkpath(QFileInfo(path).absolutePath());
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << Q_FUNC_INFO << "Cannot write library index" << path;
+        return;
+    }
+
+    QDataStream out(&file);
+    out << mApp::LIBRARY_INDEX_MAGIC << mApp::LIBRARY_INDEX_VERSION << m_folders << m_entries;
+    if (!file.commit())
+        qWarning() << Q_FUNC_INFO << "Failed to save library index" << path;
+}
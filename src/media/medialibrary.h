@@ -0,0 +1,82 @@
+#ifndef MEDIALIBRARY_H
+#define MEDIALIBRARY_H
+
+#include <QObject>
+#include <QFutureWatcher>
+#include <QHash>
+#include <QSet>
+#include <QStringList>
+
+#include "mediainfo.h"
+
+class QFileSystemWatcher;
+class QTimer;
+class MediaProber;
+
+/*
+ * Persistent index of the media files below a set of library folders.
+ *
+ * Folder scans run on the Qt Concurrent pool and only compare size/mtime
+ * against the index, so rescans are incremental: unchanged files are
+ * never probed again once probed, whether the probe succeeded or failed.
+ * New or changed files, and files whose probe is still pending, go to
+ * MediaProber, which queues each file once. Folders are watched with
+ * QFileSystemWatcher and rescanned when they change; a change during a
+ * scan rescans the folder once the scan is done.
+ * The index is loaded in the background and saved shortly after changes.
+ */
+class MediaLibrary : public QObject
+{
+    Q_OBJECT
+public:
+    explicit MediaLibrary(QObject* parent = nullptr);
+    ~MediaLibrary();
+
+    void addFolder(const QString& folderPath);
+    void rescanFolder(const QString& folderPath);
+
+    QStringList folders() const { return m_folders; }
+    bool contains(const QString& filePath) const { return m_entries.contains(filePath); }
+    MediaInfo mediaInfo(const QString& filePath) const { return m_entries.value(filePath); }
+    int count() const { return m_entries.size(); }
+
+    static bool isMediaFile(const QString& filePath);
+
+signals:
+    void loaded();
+    void mediaInfoUpdated(const QString& filePath);
+    void scanFinished(const QString& folderPath, int changedFiles, int removedFiles);
+
+private:
+    struct ScanResult {
+        QString folderPath;
+        QStringList subFolders;
+        QList<MediaInfo> changed;
+        QStringList removed;
+    };
+    struct IndexData {
+        QStringList folders;
+        QHash<QString, MediaInfo> entries;
+    };
+
+    static ScanResult scanFolder(const QString& folderPath, const QHash<QString, MediaInfo>& known);
+    static IndexData loadIndex(const QString& indexPath);
+    static QString indexFilePath();
+
+    void applyScanResult(const ScanResult& result);
+    void scheduleSave();
+    void saveIndex();
+
+    QHash<QString, MediaInfo> m_entries;
+    QStringList m_folders;
+    QSet<QString> m_scansRunning;
+    QSet<QString> m_rescansPending;   // changed while their scan was running
+
+    MediaProber* m_prober = nullptr;
+    QFileSystemWatcher* m_watcher = nullptr;
+    QTimer* m_saveTimer = nullptr;
+    QFutureWatcher<IndexData>* m_loadWatcher = nullptr;
+    bool m_loaded = false;
+};
+
+#endif // MEDIALIBRARY_H
@@ -0,0 +1,121 @@
+#include "mediaprober.h"
+
+#include <QDebug>
+#include <QMediaFormat>
+#include <QMediaMetaData>
+#include <QMediaPlayer>
+#include <QThread>
+#include <QTimer>
+#include <QUrl>
+
+MediaProber::MediaProber(QObject* parent)
+    : QObject(parent)
+{
+    const int workerCount = qBound(1, QThread::idealThreadCount(), mApp::PROBE_MAX_WORKERS);
+    m_workers.resize(workerCount);
+
+    for (int i = 0; i < workerCount; ++i) {
+        Worker& worker = m_workers[i];
+        worker.player = new QMediaPlayer(this);
+        worker.timeout = new QTimer(this);
+        worker.timeout->setSingleShot(true);
+        worker.timeout->setInterval(mApp::PROBE_TIMEOUT_MS);
+
+        connect(worker.player, &QMediaPlayer::mediaStatusChanged, this, [this, i](QMediaPlayer::MediaStatus status) {
+            Worker& w = m_workers[i];
+            if (!w.busy)
+                return;
+            if (status == QMediaPlayer::LoadedMedia)
+                finishWorker(w, true);
+            else if (status == QMediaPlayer::InvalidMedia)
+                finishWorker(w, false);
+        });
+        connect(worker.timeout, &QTimer::timeout, this, [this, i]() {
+            Worker& w = m_workers[i];
+            if (w.busy) {
+                qWarning() << Q_FUNC_INFO << "Probe timed out:" << w.info.filePath;
+                finishWorker(w, false);
+            }
+        });
+    }
+}
+
+void MediaProber::enqueue(const MediaInfo &info)
+{
+    // Rescans report every file still waiting for its probe; the newest version replaces the queued one.
+    const auto pendingIt = m_pending.find(info.filePath);
+    if (pendingIt != m_pending.end()) {
+        *pendingIt = info;
+        return;
+    }
+    for (const Worker& worker : std::as_const(m_workers)) {
+        if (worker.busy && worker.info.filePath == info.filePath && worker.info.size == info.size
+            && worker.info.modifiedMs == info.modifiedMs)
+            return;
+    }
+
+    m_pending.insert(info.filePath, info);
+    m_queue.enqueue(info.filePath);
+
+    for (Worker& worker : m_workers) {
+        if (!worker.busy) {
+            startNext(worker);
+            break;
+        }
+    }
+}
+
+void MediaProber::clear()
+{
+    m_queue.clear();
+    m_pending.clear();
+}
+
+void MediaProber::startNext(Worker &worker)
+{
+    if (m_queue.isEmpty())
+        return;
+
+    worker.info = m_pending.take(m_queue.dequeue());
+    worker.busy = true;
+    ++m_busyWorkers;
+
+    worker.timeout->start();
+    worker.player->setSource(QUrl::fromLocalFile(worker.info.filePath));
+}
+
+void MediaProber::finishWorker(Worker &worker, bool success)
+{
+    worker.timeout->stop();
+
+    MediaInfo info = worker.info;
+    info.probed = success;
+    info.probeFailed = !success;
+
+    if (success) {
+        const QMediaMetaData meta = worker.player->metaData();
+        info.hasVideo = worker.player->hasVideo();
+        info.durationMs = worker.player->duration();
+        info.resolution = meta.value(QMediaMetaData::Resolution).toSize();
+        info.videoCodec = QMediaFormat::videoCodecName(meta.value(QMediaMetaData::VideoCodec).value<QMediaFormat::VideoCodec>());
+        info.audioCodec = QMediaFormat::audioCodecName(meta.value(QMediaMetaData::AudioCodec).value<QMediaFormat::AudioCodec>());
+        info.title = meta.stringValue(QMediaMetaData::Title);
+        info.artist = meta.stringValue(QMediaMetaData::ContributingArtist);
+        info.album = meta.stringValue(QMediaMetaData::AlbumTitle);
+
+        info.audioLanguages.clear();
+        const QList<QMediaMetaData> audioTracks = worker.player->audioTracks();
+        for (const QMediaMetaData& track : audioTracks)
+            info.audioLanguages << track.stringValue(QMediaMetaData::Language);
+    }
+
+    worker.busy = false;
+    --m_busyWorkers;
+    worker.player->setSource(QUrl());
+
+    emit fileProbed(info);
+
+    startNext(worker);
+    if (m_busyWorkers == 0 && m_queue.isEmpty())
+        emit idle();
+}
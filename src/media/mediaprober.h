@@ -0,0 +1,58 @@
+#ifndef MEDIAPROBER_H
+#define MEDIAPROBER_H
+
+#include <QHash>
+#include <QObject>
+#include <QQueue>
+#include <QVector>
+
+#include "mediainfo.h"
+
+class QMediaPlayer;
+class QTimer;
+
+namespace mApp {
+const int PROBE_MAX_WORKERS = 4;
+const int PROBE_TIMEOUT_MS = 5000;
+}
+
+/*
+ * Probes media files with a small pool of headless QMediaPlayer objects.
+ * The backends demux asynchronously, so several probes run concurrently
+ * without blocking the GUI thread; results arrive through fileProbed().
+ * A file is queued once: enqueueing it again while it waits only updates
+ * its size/mtime, and a file being probed is not queued again unless it
+ * changed.
+ */
+class MediaProber : public QObject
+{
+    Q_OBJECT
+public:
+    explicit MediaProber(QObject* parent = nullptr);
+
+    void enqueue(const MediaInfo& info);
+    void clear();
+    int pendingCount() const { return m_queue.size() + m_busyWorkers; }
+
+signals:
+    void fileProbed(const MediaInfo& info);
+    void idle();
+
+private:
+    struct Worker {
+        QMediaPlayer* player = nullptr;
+        QTimer* timeout = nullptr;
+        MediaInfo info;
+        bool busy = false;
+    };
+
+    void startNext(Worker& worker);
+    void finishWorker(Worker& worker, bool success);
+
+    QVector<Worker> m_workers;
+    QQueue<QString> m_queue;
+    QHash<QString, MediaInfo> m_pending;   // the queued files by path
+    int m_busyWorkers = 0;
+};
+
+#endif // MEDIAPROBER_H
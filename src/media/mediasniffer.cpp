@@ -0,0 +1,167 @@
+#include "mediasniffer.h"
+
+#include <QChar>
+
+#include <cstring>
+
+#include "src/common/fileheader.h"
+
+namespace {
+bool startsWith(const uchar* data, qint64 size, const char* magic, qint64 offset = 0)
+{
+    const qint64 length = qint64(std::strlen(magic));
+    return size >= offset + length && std::memcmp(data + offset, magic, size_t(length)) == 0;
+}
+
+bool contains(const uchar* data, qint64 size, const char* needle, qint64 length)
+{
+    if (length <= 0 || size < length)
+        return false;
+    const uchar* end = data + size - length + 1;
+    for (const uchar* p = data; p < end; ++p) {
+        p = static_cast<const uchar*>(std::memchr(p, uchar(needle[0]), size_t(end - p)));
+        if (!p)
+            return false;
+        if (std::memcmp(p, needle, size_t(length)) == 0)
+            return true;
+    }
+    return false;
+}
+
+quint32 readU32(const uchar* p)
+{
+    return (quint32(p[0]) << 24) | (quint32(p[1]) << 16) | (quint32(p[2]) << 8) | quint32(p[3]);
+}
+
+bool isMpegAudioSync(const uchar* data, qint64 size)
+{
+    // Frame sync, a valid layer and a bitrate index that is not "bad".
+    return size >= 3 && data[0] == 0xFF && (data[1] & 0xE0) == 0xE0
+           && (data[1] & 0x06) != 0 && (data[2] & 0xF0) != 0xF0;
+}
+}
+
+MediaSniffer::Result MediaSniffer::sniffFile(const QString &filePath)
+{
+    const FileHeader header(filePath, mApp::SNIFF_HEADER_BYTES);
+    return header.isEmpty() ? Result() : sniff(header.data(), header.size());
+}
+
+MediaSniffer::Result MediaSniffer::sniff(const uchar *data, qint64 size)
+{
+    // Images
+    if (startsWith(data, size, "\x89PNG\r\n\x1a\n"))
+        return {Kind_Image, "png"};
+    if (size >= 3 && data[0] == 0xFF && data[1] == 0xD8 && data[2] == 0xFF)
+        return {Kind_Image, "jpeg"};
+    if (startsWith(data, size, "GIF87a") || startsWith(data, size, "GIF89a"))
+        return {Kind_Image, "gif"};
+    if (startsWith(data, size, "BM") && size >= 14 && readU32(data + 6) == 0)
+        return {Kind_Image, "bmp"};
+    if (startsWith(data, size, "RIFF") && startsWith(data, size, "WEBP", 8))
+        return {Kind_Image, "webp"};
+    if (size >= 4 && (std::memcmp(data, "II*\0", 4) == 0 || std::memcmp(data, "MM\0*", 4) == 0))
+        return {Kind_Image, "tiff"};
+
+    // Audio streams
+    if (startsWith(data, size, "RIFF") && startsWith(data, size, "WAVE", 8))
+        return {Kind_Audio, "wav"};
+    if (startsWith(data, size, "FORM") && (startsWith(data, size, "AIFF", 8) || startsWith(data, size, "AIFC", 8)))
+        return {Kind_Audio, "aiff"};
+    if (startsWith(data, size, "fLaC"))
+        return {Kind_Audio, "flac"};
+    if (startsWith(data, size, "ID3") || isMpegAudioSync(data, size))
+        return {Kind_Audio, "mp3"};
+    if (size >= 2 && data[0] == 0xFF && (data[1] & 0xF6) == 0xF0)
+        return {Kind_Audio, "aac"};
+    if (startsWith(data, size, "#!AMR"))
+        return {Kind_Audio, "amr"};
+    if (startsWith(data, size, "MAC "))
+        return {Kind_Audio, "ape"};
+    if (startsWith(data, size, "wvpk"))
+        return {Kind_Audio, "wavpack"};
+
+    // Containers
+    if (size >= 12 && (startsWith(data, size, "ftyp", 4) || startsWith(data, size, "moov", 4)
+                       || startsWith(data, size, "mdat", 4) || startsWith(data, size, "wide", 4)
+                       || startsWith(data, size, "free", 4)))
+        return sniffIsoBmff(data, size);
+    if (size >= 4 && readU32(data) == 0x1A45DFA3)
+        return sniffMatroska(data, size);
+    if (startsWith(data, size, "OggS"))
+        return sniffOgg(data, size);
+    if (startsWith(data, size, "RIFF") && startsWith(data, size, "AVI ", 8))
+        return {Kind_Video, "avi"};
+    if (startsWith(data, size, "FLV") && size >= 5)
+        return {(data[4] & 0x01) ? Kind_Video : Kind_Audio, "flv"};
+    if (size >= 16 && std::memcmp(data, "\x30\x26\xB2\x75\x8E\x66\xCF\x11", 8) == 0) {
+        // ASF: a video stream properties GUID in the header means WMV, else WMA.
+        static const char videoMediaGuid[] = "\xC0\xEF\x19\xBC\x4D\x5B\xCF\x11";
+        return {contains(data, size, videoMediaGuid, 8) ? Kind_Video : Kind_Audio, "asf"};
+    }
+    if (size >= 4 && readU32(data) == 0x000001BA)
+        return {Kind_Video, "mpeg-ps"};
+    if (size > 376 && data[0] == 0x47 && data[188] == 0x47 && data[376] == 0x47)
+        return {Kind_Video, "mpeg-ts"};
+
+    // Weak signatures last, so they cannot shadow a container.
+    if (size >= 6 && data[0] == 0 && data[1] == 0 && data[2] == 1 && data[3] == 0 && data[4] != 0)
+        return {Kind_Image, "ico"};
+    if (size >= 3 && data[0] == 'P' && data[1] >= '1' && data[1] <= '6' && QChar::isSpace(data[2]))
+        return {Kind_Image, "pnm"};
+    if ((startsWith(data, size, "<?xml") || startsWith(data, size, "<svg")) && contains(data, size, "<svg", 4))
+        return {Kind_Image, "svg"};
+
+    return Result();
+}
+
+MediaSniffer::Result MediaSniffer::sniffIsoBmff(const uchar *data, qint64 size)
+{
+    if (startsWith(data, size, "ftyp", 4) && size >= 12) {
+        const char* brand = reinterpret_cast<const char*>(data + 8);
+        // Still-image brands share the container with video.
+        if (!std::memcmp(brand, "heic", 4) || !std::memcmp(brand, "heix", 4) || !std::memcmp(brand, "mif1", 4)
+            || !std::memcmp(brand, "avif", 4) || !std::memcmp(brand, "msf1", 4))
+            return {Kind_Image, "heif"};
+        if (!std::memcmp(brand, "M4A ", 4) || !std::memcmp(brand, "M4B ", 4) || !std::memcmp(brand, "M4P ", 4))
+            return {Kind_Audio, "m4a"};
+    }
+
+    // The handler types tell, if the moov box is in the window (fast-start files).
+    const bool hasVideo = contains(data, size, "vide\0\0\0\0", 8);
+    const bool hasSound = contains(data, size, "soun\0\0\0\0", 8);
+    if (contains(data, size, "moov", 4) && hasSound && !hasVideo)
+        return {Kind_Audio, "mp4"};
+    return {Kind_Video, "mp4"};
+}
+
+MediaSniffer::Result MediaSniffer::sniffMatroska(const uchar *data, qint64 size)
+{
+    const char* format = contains(data, size, "webm", 4) ? "webm" : "matroska";
+
+    // CodecID strings sit in the Tracks element near the start.
+    static const char* const videoCodecs[] = {"V_MPEG", "V_VP", "V_AV1", "V_MS/", "V_THEORA", "V_MJPEG",
+                                              "V_UNCOMPRESSED", "V_QUICKTIME", "V_PRORES"};
+    static const char* const audioCodecs[] = {"A_AAC", "A_OPUS", "A_VORBIS", "A_FLAC", "A_MPEG", "A_AC3",
+                                              "A_EAC3", "A_PCM", "A_DTS", "A_TRUEHD", "A_ALAC"};
+    for (const char* codec : videoCodecs) {
+        if (contains(data, size, codec, qint64(std::strlen(codec))))
+            return {Kind_Video, format};
+    }
+    for (const char* codec : audioCodecs) {
+        if (contains(data, size, codec, qint64(std::strlen(codec))))
+            return {Kind_Audio, format};
+    }
+    return {Kind_Video, format};
+}
+
+MediaSniffer::Result MediaSniffer::sniffOgg(const uchar *data, qint64 size)
+{
+    // The first packet of each logical stream carries its codec signature.
+    if (contains(data, size, "\x80theora", 7) || contains(data, size, "\x80" "daala", 6))
+        return {Kind_Video, "ogg"};
+    if (contains(data, size, "\x01vorbis", 7) || contains(data, size, "OpusHead", 8)
+        || contains(data, size, "\x7f" "FLAC", 5) || contains(data, size, "Speex   ", 8))
+        return {Kind_Audio, "ogg"};
+    return {Kind_Video, "ogg"};
+}
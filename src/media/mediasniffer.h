@@ -0,0 +1,43 @@
+#ifndef MEDIASNIFFER_H
+#define MEDIASNIFFER_H
+
+#include <QByteArray>
+#include <QString>
+
+namespace mApp {
+const qint64 SNIFF_HEADER_BYTES = 64 * 1024; // most track headers fit, the payload is never touched
+}
+
+/*
+ * Media type detection from file content.
+ * Only the first SNIFF_HEADER_BYTES of the file are mapped. Image
+ * formats, audio streams and containers are matched by their magic
+ * bytes; containers that can carry either (MP4/MOV, Matroska/WebM, Ogg,
+ * FLV, ASF) are told apart by the track or codec headers found in that
+ * window, and default to video when the header does not say.
+ */
+class MediaSniffer
+{
+public:
+    enum Kind {
+        Kind_Unknown = 0,
+        Kind_Image,
+        Kind_Audio,
+        Kind_Video
+    };
+
+    struct Result {
+        Kind kind = Kind_Unknown;
+        const char* format = "";   // short container/codec name, e.g. "mp4", "png"
+    };
+
+    static Result sniffFile(const QString& filePath);
+    static Result sniff(const uchar* data, qint64 size);
+
+private:
+    static Result sniffIsoBmff(const uchar* data, qint64 size);
+    static Result sniffMatroska(const uchar* data, qint64 size);
+    static Result sniffOgg(const uchar* data, qint64 size);
+};
+
+#endif // MEDIASNIFFER_H
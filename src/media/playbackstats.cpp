@@ -0,0 +1,232 @@
+#include "playbackstats.h"
+
+#include <QDateTime>
+#include <QFile>
+#include <QMediaPlayer>
+#include <QTextStream>
+#include <QTimer>
+#include <QVideoFrame>
+#include <QVideoSink>
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+namespace mApp {
+const qint64 STATS_DISCONTINUITY_US = 1000000; // a timestamp jump this big is a seek, not a drop
+}
+
+PlaybackStats::PlaybackStats(QObject *parent)
+    : QObject(parent)
+    , m_stallProbe(new QTimer(this))
+{
+    m_clock.start();
+
+    m_stallProbe->setInterval(mApp::STATS_STALL_PROBE_MS);
+    m_stallProbe->setTimerType(Qt::PreciseTimer);
+    connect(m_stallProbe, &QTimer::timeout, this, [this]() {
+        const qint64 now = m_clock.nsecsElapsed();
+        if (m_lastProbeNs >= 0) {
+            const double lateMs = (now - m_lastProbeNs) / 1e6 - mApp::STATS_STALL_PROBE_MS;
+            if (lateMs > 1.0)
+                m_stalls.append({now / 1000, lateMs});
+        }
+        m_lastProbeNs = now;
+    });
+
+    reset();
+}
+
+void PlaybackStats::setPlayer(QMediaPlayer *player)
+{
+    m_player = player;
+    m_lastPtsUs = -1;
+}
+
+void PlaybackStats::setVideoSink(QVideoSink *sink)
+{
+    m_sink = sink;
+    if (m_enabled) {
+        setEnabled(false);
+        setEnabled(true);
+    }
+}
+
+void PlaybackStats::setEnabled(bool enabled)
+{
+    if (m_enabled == enabled)
+        return;
+
+    m_enabled = enabled;
+    disconnect(m_sinkConnection);
+    m_sinkConnection = QMetaObject::Connection();
+
+    if (!m_enabled || !m_sink) {
+        m_stallProbe->stop();
+        return;
+    }
+
+    reset();
+    m_lastProbeNs = -1;
+    m_stallProbe->start();
+
+    // Stamp arrival in the emitting thread, do the bookkeeping on ours.
+    m_sinkConnection = connect(m_sink, &QVideoSink::videoFrameChanged, this, [this](const QVideoFrame& frame) {
+        const qint64 arrivalNs = m_clock.nsecsElapsed();
+        const qint64 ptsUs = frame.startTime();
+        qint64 durationUs = frame.endTime() > frame.startTime() ? frame.endTime() - frame.startTime() : 0;
+        const qreal frameRate = frame.surfaceFormat().streamFrameRate();
+        if (frameRate > 0.0)
+            durationUs = qint64(1e6 / frameRate);
+        QMetaObject::invokeMethod(this, [this, ptsUs, durationUs, arrivalNs]() {
+            recordFrame(ptsUs, durationUs, arrivalNs);
+        }, Qt::QueuedConnection);
+    }, Qt::DirectConnection);
+}
+
+void PlaybackStats::reset()
+{
+    m_lastPtsUs = -1;
+    m_lastWallUs = -1;
+    m_presentedFrames = 0;
+    m_droppedFrames = 0;
+    m_jitterHistogram.fill(0, mApp::STATS_JITTER_BUCKETS);
+    m_records.clear();
+    m_recordHead = 0;
+    m_window.clear();
+    m_stalls.clear();
+    m_lastQueueFrames = 0.0;
+}
+
+int PlaybackStats::jitterBucket(qint64 deviationUs)
+{
+    static const qint64 limitsUs[] = {1000, 2000, 4000, 8000, 16000, 33000};
+    int bucket = 0;
+    while (bucket < int(std::size(limitsUs)) && deviationUs >= limitsUs[bucket])
+        ++bucket;
+    return bucket;
+}
+
+QStringList PlaybackStats::jitterBucketLabels()
+{
+    return {"<1", "<2", "<4", "<8", "<16", "<33", ">=33"};
+}
+
+void PlaybackStats::recordFrame(qint64 ptsUs, qint64 frameDurationUs, qint64 arrivalNs)
+{
+    if (!m_enabled || ptsUs < 0)
+        return;
+
+    FrameRecord record;
+    record.wallUs = arrivalNs / 1000;
+    record.ptsUs = ptsUs;
+    record.deliveryLagUs = (m_clock.nsecsElapsed() - arrivalNs) / 1000;
+
+    const double rate = m_player && m_player->playbackRate() > 0.0 ? m_player->playbackRate() : 1.0;
+
+    if (m_player) {
+        // The position moved on while the frame waited for us; take that back out.
+        const double positionUs = m_player->position() * 1000.0 - record.deliveryLagUs * rate;
+        record.avOffsetUs = qint64(ptsUs - positionUs);
+        if (frameDurationUs > 0)
+            m_lastQueueFrames = double(record.avOffsetUs) / frameDurationUs;
+    }
+
+    const qint64 ptsDelta = m_lastPtsUs >= 0 ? ptsUs - m_lastPtsUs : -1;
+    if (ptsDelta > 0 && ptsDelta < mApp::STATS_DISCONTINUITY_US) {
+        if (frameDurationUs > 0 && ptsDelta > frameDurationUs * 3 / 2)
+            record.droppedBefore = int(std::llround(double(ptsDelta) / frameDurationUs)) - 1;
+
+        record.intervalUs = record.wallUs - m_lastWallUs;
+        record.expectedUs = qint64(ptsDelta / rate);
+        ++m_jitterHistogram[jitterBucket(std::abs(record.intervalUs - record.expectedUs))];
+    }
+
+    m_lastPtsUs = ptsUs;
+    m_lastWallUs = record.wallUs;
+    ++m_presentedFrames;
+    m_droppedFrames += record.droppedBefore;
+
+    if (m_records.size() < mApp::STATS_MAX_RECORDS) {
+        m_records.append(record);
+    } else {
+        m_records[m_recordHead] = record;
+        m_recordHead = (m_recordHead + 1) % mApp::STATS_MAX_RECORDS;
+    }
+
+    m_window.append({record.wallUs, record.droppedBefore, record.avOffsetUs / 1000.0, record.deliveryLagUs / 1000.0});
+    pruneWindow(record.wallUs);
+}
+
+void PlaybackStats::pruneWindow(qint64 nowUs)
+{
+    const qint64 fromUs = nowUs - mApp::STATS_WINDOW_MS * 1000;
+    m_window.erase(m_window.begin(), std::find_if(m_window.begin(), m_window.end(), [fromUs](const WindowSample& sample) {
+        return sample.wallUs >= fromUs;
+    }));
+    m_stalls.erase(m_stalls.begin(), std::find_if(m_stalls.begin(), m_stalls.end(), [fromUs](const QPair<qint64, double>& stall) {
+        return stall.first >= fromUs;
+    }));
+}
+
+PlaybackStatsSnapshot PlaybackStats::snapshot()
+{
+    PlaybackStatsSnapshot snapshot;
+    snapshot.presentedFrames = m_presentedFrames;
+    snapshot.droppedFrames = m_droppedFrames;
+    snapshot.jitterHistogram = m_jitterHistogram;
+    snapshot.queueFrames = m_lastQueueFrames;
+
+    // Per-second figures come from the samples of the last window.
+    pruneWindow(m_clock.nsecsElapsed() / 1000);
+
+    int dropped = 0;
+    double offsetSum = 0.0, lagSum = 0.0;
+    for (const WindowSample& sample : std::as_const(m_window)) {
+        dropped += sample.dropped;
+        offsetSum += sample.avOffsetMs;
+        lagSum += sample.lagMs;
+        snapshot.avOffsetMaxMs = std::max(snapshot.avOffsetMaxMs, std::abs(sample.avOffsetMs));
+        snapshot.deliveryLagMaxMs = std::max(snapshot.deliveryLagMaxMs, sample.lagMs);
+    }
+    const double seconds = mApp::STATS_WINDOW_MS / 1000.0;
+    snapshot.presentedFps = m_window.size() / seconds;
+    snapshot.decodedFps = (m_window.size() + dropped) / seconds;
+    if (!m_window.isEmpty()) {
+        snapshot.avOffsetMs = offsetSum / m_window.size();
+        snapshot.deliveryLagMs = lagSum / m_window.size();
+    }
+    for (const QPair<qint64, double>& stall : std::as_const(m_stalls))
+        snapshot.guiStallMaxMs = std::max(snapshot.guiStallMaxMs, stall.second);
+
+    return snapshot;
+}
+
+bool PlaybackStats::exportTo(const QString &filePath) const
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        qWarning() << Q_FUNC_INFO << "Cannot write" << filePath;
+        return false;
+    }
+
+    QTextStream out(&file);
+    const QStringList labels = jitterBucketLabels();
+    out << "# miniMedia playback stats " << QDateTime::currentDateTime().toString(Qt::ISODate) << '\n';
+    out << "# presented_frames " << m_presentedFrames << " dropped_frames " << m_droppedFrames << '\n';
+    out << "# jitter_ms";
+    for (int i = 0; i < m_jitterHistogram.size(); ++i)
+        out << ' ' << labels.value(i) << ':' << m_jitterHistogram.at(i);
+    out << '\n';
+    out << "wall_us,pts_us,interval_us,expected_us,delivery_lag_us,av_offset_us,dropped_before\n";
+
+    // Oldest first: the ring starts at the head once it has wrapped.
+    for (int i = 0; i < m_records.size(); ++i) {
+        const FrameRecord& r = m_records.at((m_recordHead + i) % m_records.size());
+        out << r.wallUs << ',' << r.ptsUs << ',' << r.intervalUs << ',' << r.expectedUs << ','
+            << r.deliveryLagUs << ',' << r.avOffsetUs << ',' << r.droppedBefore << '\n';
+    }
+
+    qInfo() << Q_FUNC_INFO << "Exported" << m_records.size() << "frame records to" << filePath;
+    return true;
+}
@@ -0,0 +1,103 @@
+#ifndef PLAYBACKSTATS_H
+#define PLAYBACKSTATS_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QPointer>
+#include <QVector>
+
+class QMediaPlayer;
+class QTimer;
+class QVideoSink;
+
+namespace mApp {
+const int STATS_MAX_RECORDS = 36000;      // per-frame log kept for export (~10 min at 60 fps)
+const int STATS_WINDOW_MS = 1000;         // fps and maxima are over the last second
+const int STATS_STALL_PROBE_MS = 10;      // GUI event loop lag probe
+const int STATS_JITTER_BUCKETS = 7;       // <1, <2, <4, <8, <16, <33, >=33 ms
+}
+
+struct PlaybackStatsSnapshot
+{
+    double presentedFps = 0.0;
+    double decodedFps = 0.0;              // presented plus frames skipped in the timestamps
+    qint64 presentedFrames = 0;
+    qint64 droppedFrames = 0;
+    QVector<qint64> jitterHistogram;      // |actual - expected| frame interval
+    double avOffsetMs = 0.0;              // video timestamp minus the player clock
+    double avOffsetMaxMs = 0.0;
+    double queueFrames = 0.0;             // frames the video runs ahead of the clock
+    double deliveryLagMs = 0.0;           // sink signal to GUI thread
+    double deliveryLagMaxMs = 0.0;
+    double guiStallMaxMs = 0.0;
+};
+
+/*
+ * Frame timing counters taken at a QVideoSink.
+ * Arrival time is stamped in whatever thread the sink emits from; the
+ * rest is computed on the GUI thread, so the difference is the GUI
+ * delivery lag. Gaps in the frame timestamps count as dropped frames,
+ * the wall-clock interval against the timestamp interval (scaled by
+ * rate) gives the jitter, and the timestamp against the player
+ * position gives the A/V offset.
+ * Nothing is collected while disabled.
+ */
+class PlaybackStats : public QObject
+{
+    Q_OBJECT
+public:
+    explicit PlaybackStats(QObject* parent = nullptr);
+
+    void setPlayer(QMediaPlayer* player);
+    void setVideoSink(QVideoSink* sink);
+
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return m_enabled; }
+    void reset();
+
+    PlaybackStatsSnapshot snapshot();
+    bool exportTo(const QString& filePath) const;
+
+    static QStringList jitterBucketLabels();
+
+private:
+    struct FrameRecord {
+        qint64 wallUs = 0;
+        qint64 ptsUs = 0;
+        qint64 intervalUs = 0;
+        qint64 expectedUs = 0;
+        qint64 deliveryLagUs = 0;
+        qint64 avOffsetUs = 0;
+        int droppedBefore = 0;
+    };
+
+    void recordFrame(qint64 ptsUs, qint64 frameDurationUs, qint64 arrivalNs);
+    void pruneWindow(qint64 nowUs);
+    static int jitterBucket(qint64 deviationUs);
+
+    QPointer<QMediaPlayer> m_player;
+    QPointer<QVideoSink> m_sink;
+    QMetaObject::Connection m_sinkConnection;
+    QTimer* m_stallProbe = nullptr;
+
+    bool m_enabled = false;
+    QElapsedTimer m_clock;          // shared time base for arrival stamps
+    qint64 m_lastProbeNs = -1;
+
+    qint64 m_lastPtsUs = -1;
+    qint64 m_lastWallUs = -1;
+
+    qint64 m_presentedFrames = 0;
+    qint64 m_droppedFrames = 0;
+    QVector<qint64> m_jitterHistogram;
+
+    QVector<FrameRecord> m_records; // ring buffer
+    int m_recordHead = 0;
+
+    struct WindowSample { qint64 wallUs; int dropped; double avOffsetMs; double lagMs; };
+    QVector<WindowSample> m_window;
+    QVector<QPair<qint64, double>> m_stalls;
+    double m_lastQueueFrames = 0.0;
+};
+
+#endif // PLAYBACKSTATS_H
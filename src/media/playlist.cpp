@@ -0,0 +1,57 @@
+#include "playlist.h"
+
+void Playlist::setItems(const QStringList &filePaths)
+{
+    m_items = filePaths;
+    m_currentIndex = m_items.isEmpty() ? -1 : 0;
+}
+
+void Playlist::clear()
+{
+    m_items.clear();
+    m_currentIndex = -1;
+}
+
+QString Playlist::currentItem() const
+{
+    return m_currentIndex >= 0 ? m_items.at(m_currentIndex) : QString();
+}
+
+bool Playlist::setCurrentIndex(int index)
+{
+    if (index < 0 || index >= m_items.size())
+        return false;
+    m_currentIndex = index;
+    return true;
+}
+
+bool Playlist::hasNext() const
+{
+    return m_currentIndex >= 0 && m_currentIndex + 1 < m_items.size();
+}
+
+QString Playlist::nextItem() const
+{
+    return hasNext() ? m_items.at(m_currentIndex + 1) : QString();
+}
+
+bool Playlist::hasPrevious() const
+{
+    return m_currentIndex > 0;
+}
+
+bool Playlist::advance()
+{
+    if (!hasNext())
+        return false;
+    ++m_currentIndex;
+    return true;
+}
+
+bool Playlist::goBack()
+{
+    if (!hasPrevious())
+        return false;
+    --m_currentIndex;
+    return true;
+}
@@ -0,0 +1,38 @@
+#ifndef PLAYLIST_H
+#define PLAYLIST_H
+
+#include <QString>
+#include <QStringList>
+
+/*
+ * Ordered queue of media files with a cursor on the item being played.
+ */
+class Playlist
+{
+public:
+    Playlist() = default;
+
+    void setItems(const QStringList& filePaths);
+    void clear();
+
+    bool isEmpty() const { return m_items.isEmpty(); }
+    int count() const { return m_items.size(); }
+    int currentIndex() const { return m_currentIndex; }
+
+    QString currentItem() const;
+    QString itemAt(int index) const { return m_items.value(index); }
+    int indexOf(const QString& filePath) const { return m_items.indexOf(filePath); }
+    bool setCurrentIndex(int index);
+    bool hasNext() const;
+    QString nextItem() const;
+    bool hasPrevious() const;
+
+    bool advance();
+    bool goBack();
+
+private:
+    QStringList m_items;
+    int m_currentIndex = -1;
+};
+
+#endif // PLAYLIST_H
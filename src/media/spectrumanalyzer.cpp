@@ -0,0 +1,242 @@
+#include "spectrumanalyzer.h"
+
+#include <QAudioFormat>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "src/common/simd.h"
+
+namespace mApp {
+const float SPECTRUM_MIN_FREQUENCY = 40.0f;
+const float SPECTRUM_MAX_FREQUENCY = 16000.0f;
+const float SPECTRUM_PI = 3.14159265358979f;
+}
+
+static float toDb(float amplitude)
+{
+    return std::max(mApp::SPECTRUM_FLOOR_DB, 20.0f * std::log10(std::max(amplitude, 1e-9f)));
+}
+
+SpectrumAnalyzer::SpectrumAnalyzer(QObject* parent)
+    : QObject(parent)
+{
+    const int n = mApp::SPECTRUM_FFT_SIZE;
+
+    m_window.resize(n);
+    for (int i = 0; i < n; ++i)
+        m_window[i] = 0.5f * (1.0f - std::cos(2.0f * mApp::SPECTRUM_PI * i / (n - 1)));
+
+    m_input.resize(n);
+    m_re.resize(n);
+    m_im.resize(n);
+
+    int bits = 0;
+    while ((1 << bits) < n)
+        ++bits;
+    m_bitReverse.resize(n);
+    for (int i = 0; i < n; ++i) {
+        int r = 0;
+        for (int b = 0; b < bits; ++b)
+            r |= ((i >> b) & 1) << (bits - 1 - b);
+        m_bitReverse[i] = r;
+    }
+
+    // One contiguous table per stage: the stage of half size h reads h entries from offset h - 1.
+    m_twiddleCos.resize(n - 1);
+    m_twiddleSin.resize(n - 1);
+    for (int half = 1; half < n; half <<= 1) {
+        for (int k = 0; k < half; ++k) {
+            m_twiddleCos[half - 1 + k] = std::cos(mApp::SPECTRUM_PI * k / half);
+            m_twiddleSin[half - 1 + k] = -std::sin(mApp::SPECTRUM_PI * k / half);
+        }
+    }
+
+    m_bandMagnitude.fill(0.0f, mApp::SPECTRUM_BAND_COUNT);
+}
+
+bool SpectrumAnalyzer::reserveSlot()
+{
+    if (m_backlog.load(std::memory_order_relaxed) >= mApp::SPECTRUM_MAX_BACKLOG)
+        return false;
+    m_backlog.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void SpectrumAnalyzer::reset()
+{
+    m_inputFill = 0;
+    m_bandMagnitude.fill(0.0f);
+    m_peak[0] = m_peak[1] = 0.0f;
+    m_sumSquares[0] = m_sumSquares[1] = 0.0;
+    m_meterFrames = 0;
+    m_busyNs = m_audioNs = 0;
+}
+
+void SpectrumAnalyzer::processBuffer(const QAudioBuffer &buffer)
+{
+    m_backlog.fetch_sub(1, std::memory_order_relaxed);
+
+    const QAudioFormat format = buffer.format();
+    if (!buffer.isValid() || format.sampleFormat() != QAudioFormat::Float || format.sampleRate() <= 0)
+        return;
+
+    QElapsedTimer busy;
+    busy.start();
+
+    const int channels = format.channelCount();
+    const int frames = static_cast<int>(buffer.frameCount());
+    const float* samples = buffer.constData<float>();
+
+    // Meters: the first two channels, mono is shown on both.
+    for (int f = 0; f < frames; ++f) {
+        for (int c = 0; c < 2; ++c) {
+            const float v = samples[f * channels + std::min(c, channels - 1)];
+            m_peak[c] = std::max(m_peak[c], std::fabs(v));
+            m_sumSquares[c] += double(v) * v;
+        }
+    }
+    m_meterFrames += frames;
+
+    // Mono mix into the FFT input, one transform every hop.
+    const float scale = 1.0f / channels;
+    for (int f = 0; f < frames; ++f) {
+        float acc = 0.0f;
+        for (int c = 0; c < channels; ++c)
+            acc += samples[f * channels + c];
+        m_input[m_inputFill++] = acc * scale;
+
+        if (m_inputFill == mApp::SPECTRUM_FFT_SIZE) {
+            runFft(format.sampleRate());
+            const int keep = mApp::SPECTRUM_FFT_SIZE - mApp::SPECTRUM_HOP_SIZE;
+            std::memmove(m_input.data(), m_input.constData() + mApp::SPECTRUM_HOP_SIZE, keep * sizeof(float));
+            m_inputFill = keep;
+        }
+    }
+
+    m_busyNs += busy.nsecsElapsed();
+    m_audioNs += qint64(frames) * 1000000000LL / format.sampleRate();
+
+    if (m_publishClock.isValid() && m_publishClock.elapsed() < m_publishIntervalMs)
+        return;
+    m_publishClock.start();
+
+    SpectrumFrame frame;
+    frame.bandsDb.resize(mApp::SPECTRUM_BAND_COUNT);
+    for (int b = 0; b < mApp::SPECTRUM_BAND_COUNT; ++b)
+        frame.bandsDb[b] = toDb(m_bandMagnitude[b]);
+    for (int c = 0; c < 2; ++c) {
+        frame.peakDb[c] = toDb(m_peak[c]);
+        frame.rmsDb[c] = m_meterFrames > 0 ? toDb(float(std::sqrt(m_sumSquares[c] / m_meterFrames))) : mApp::SPECTRUM_FLOOR_DB;
+    }
+    frame.dspLoad = m_audioNs > 0 ? float(double(m_busyNs) / m_audioNs) : 0.0f;
+
+    m_bandMagnitude.fill(0.0f);
+    m_peak[0] = m_peak[1] = 0.0f;
+    m_sumSquares[0] = m_sumSquares[1] = 0.0;
+    m_meterFrames = 0;
+
+    emit frameReady(frame);
+}
+
+void SpectrumAnalyzer::runFft(int sampleRate)
+{
+    const int n = mApp::SPECTRUM_FFT_SIZE;
+    float* re = m_re.data();
+    float* im = m_im.data();
+    const float* in = m_input.constData();
+    const float* window = m_window.constData();
+
+    // Windowing into bit-reversed order.
+    for (int i = 0; i < n; ++i) {
+        re[m_bitReverse[i]] = in[i] * window[i];
+        im[i] = 0.0f;
+    }
+
+    // Iterative radix-2 butterflies on split real/imag arrays, four at a time
+    // from the stage's own twiddle table once a half block has four of them.
+    for (int size = 2; size <= n; size <<= 1) {
+        const int half = size / 2;
+        const float* twCos = m_twiddleCos.constData() + half - 1;
+        const float* twSin = m_twiddleSin.constData() + half - 1;
+        for (int start = 0; start < n; start += size) {
+            float* reA = re + start;
+            float* imA = im + start;
+            float* reB = re + start + half;
+            float* imB = im + start + half;
+            int k = 0;
+#ifdef MINIMEDIA_HAVE_SSE2
+            for (; k + 4 <= half; k += 4) {
+                const __m128 wr = _mm_loadu_ps(twCos + k);
+                const __m128 wi = _mm_loadu_ps(twSin + k);
+                const __m128 br = _mm_loadu_ps(reB + k);
+                const __m128 bi = _mm_loadu_ps(imB + k);
+                const __m128 ar = _mm_loadu_ps(reA + k);
+                const __m128 ai = _mm_loadu_ps(imA + k);
+                const __m128 tr = _mm_sub_ps(_mm_mul_ps(br, wr), _mm_mul_ps(bi, wi));
+                const __m128 ti = _mm_add_ps(_mm_mul_ps(br, wi), _mm_mul_ps(bi, wr));
+                _mm_storeu_ps(reB + k, _mm_sub_ps(ar, tr));
+                _mm_storeu_ps(imB + k, _mm_sub_ps(ai, ti));
+                _mm_storeu_ps(reA + k, _mm_add_ps(ar, tr));
+                _mm_storeu_ps(imA + k, _mm_add_ps(ai, ti));
+            }
+#endif
+            for (; k < half; ++k) {
+                const float wr = twCos[k];
+                const float wi = twSin[k];
+                const float tr = reB[k] * wr - imB[k] * wi;
+                const float ti = reB[k] * wi + imB[k] * wr;
+                reB[k] = reA[k] - tr;
+                imB[k] = imA[k] - ti;
+                reA[k] += tr;
+                imA[k] += ti;
+            }
+        }
+    }
+
+    // Squared magnitudes of the positive half, in place in re[].
+    const int bins = n / 2;
+    int i = 0;
+#ifdef MINIMEDIA_HAVE_SSE2
+    for (; i + 4 <= bins; i += 4) {
+        const __m128 r = _mm_loadu_ps(re + i);
+        const __m128 m = _mm_loadu_ps(im + i);
+        _mm_storeu_ps(re + i, _mm_add_ps(_mm_mul_ps(r, r), _mm_mul_ps(m, m)));
+    }
+#endif
+    for (; i < bins; ++i)
+        re[i] = re[i] * re[i] + im[i] * im[i];
+
+    updateBandLayout(sampleRate);
+
+    // Hann window has a coherent gain of 0.5; scale so a full-scale sine reads 0 dB.
+    const float norm = 2.0f / (n * 0.5f);
+    for (int b = 0; b < mApp::SPECTRUM_BAND_COUNT; ++b) {
+        float peak = 0.0f;
+        for (int k = m_bandEdges[b]; k < m_bandEdges[b + 1]; ++k)
+            peak = std::max(peak, re[k]);
+        m_bandMagnitude[b] = std::max(m_bandMagnitude[b], std::sqrt(peak) * norm);
+    }
+}
+
+void SpectrumAnalyzer::updateBandLayout(int sampleRate)
+{
+    if (m_bandSampleRate == sampleRate)
+        return;
+    m_bandSampleRate = sampleRate;
+
+    const int bins = mApp::SPECTRUM_FFT_SIZE / 2;
+    const float binHz = float(sampleRate) / mApp::SPECTRUM_FFT_SIZE;
+    const float maxHz = std::min(mApp::SPECTRUM_MAX_FREQUENCY, sampleRate / 2.0f);
+    const float ratio = std::pow(maxHz / mApp::SPECTRUM_MIN_FREQUENCY, 1.0f / mApp::SPECTRUM_BAND_COUNT);
+
+    m_bandEdges.resize(mApp::SPECTRUM_BAND_COUNT + 1);
+    float edgeHz = mApp::SPECTRUM_MIN_FREQUENCY;
+    for (int b = 0; b <= mApp::SPECTRUM_BAND_COUNT; ++b) {
+        m_bandEdges[b] = std::clamp(int(edgeHz / binHz), 1, bins);
+        if (b > 0 && m_bandEdges[b] <= m_bandEdges[b - 1])
+            m_bandEdges[b] = std::min(m_bandEdges[b - 1] + 1, bins); // at least one bin per band
+        edgeHz *= ratio;
+    }
+}
@@ -0,0 +1,76 @@
+#ifndef SPECTRUMANALYZER_H
+#define SPECTRUMANALYZER_H
+
+#include <QObject>
+#include <QAudioBuffer>
+#include <QElapsedTimer>
+#include <QVector>
+
+#include <atomic>
+
+namespace mApp {
+const int SPECTRUM_FFT_SIZE = 2048;
+const int SPECTRUM_HOP_SIZE = 1024;        // 50% overlap
+const int SPECTRUM_BAND_COUNT = 32;
+const int SPECTRUM_MAX_BACKLOG = 4;        // buffers queued before new ones are dropped
+const float SPECTRUM_FLOOR_DB = -90.0f;
+}
+
+struct SpectrumFrame
+{
+    QVector<float> bandsDb;     // log-spaced bands, SPECTRUM_FLOOR_DB..0
+    float peakDb[2] = {mApp::SPECTRUM_FLOOR_DB, mApp::SPECTRUM_FLOOR_DB};
+    float rmsDb[2] = {mApp::SPECTRUM_FLOOR_DB, mApp::SPECTRUM_FLOOR_DB};
+    float dspLoad = 0.0f;       // processing time / audio time
+};
+
+/*
+ * Runs on a worker thread. Takes decoded PCM, computes level meters and a
+ * Hann-windowed FFT and publishes one SpectrumFrame per display frame.
+ * The producer never waits: buffers are dropped once the backlog is full.
+ */
+class SpectrumAnalyzer : public QObject
+{
+    Q_OBJECT
+public:
+    explicit SpectrumAnalyzer(QObject* parent = nullptr);
+
+    // Called from the producer thread; false means drop the buffer.
+    bool reserveSlot();
+    void processBuffer(const QAudioBuffer& buffer);
+    void reset();
+
+    void setPublishIntervalMs(int intervalMs) { m_publishIntervalMs = intervalMs; }
+
+signals:
+    void frameReady(const SpectrumFrame& frame);
+
+private:
+    void runFft(int sampleRate);
+    void updateBandLayout(int sampleRate);
+
+    std::atomic<int> m_backlog {0};
+    int m_publishIntervalMs = 16;
+
+    QVector<float> m_window;
+    QVector<float> m_input;
+    int m_inputFill = 0;
+
+    QVector<float> m_re, m_im;
+    QVector<float> m_twiddleCos, m_twiddleSin;   // per stage, contiguous: half size h at offset h - 1
+    QVector<int> m_bitReverse;
+
+    int m_bandSampleRate = 0;
+    QVector<int> m_bandEdges;       // SPECTRUM_BAND_COUNT + 1 bin indices
+    QVector<float> m_bandMagnitude; // max since the last publish
+
+    float m_peak[2] = {0.0f, 0.0f};
+    double m_sumSquares[2] = {0.0, 0.0};
+    qint64 m_meterFrames = 0;
+
+    QElapsedTimer m_publishClock;
+    qint64 m_busyNs = 0;
+    qint64 m_audioNs = 0;
+};
+
+#endif // SPECTRUMANALYZER_H
@@ -0,0 +1,201 @@
+#include "speedcontroller.h"
+
+#include <QAudioOutput>
+#include <QMediaPlayer>
+#include <QThread>
+
+#include <algorithm>
+#include <iterator>
+
+#include "audiotap.h"
+#include "stretchrenderer.h"
+
+namespace mApp {
+const double PLAYBACK_SPEED_STEPS[] = {0.25, 0.5, 0.75, 1.0, 1.25, 1.5, 2.0, 3.0, 4.0};
+}
+
+SpeedController::SpeedController(AudioTap *tap, QObject *parent)
+    : QObject(parent)
+    , m_tap(tap)
+    , m_thread(new QThread(this))
+    , m_renderer(new StretchRenderer)
+{
+    m_renderer->moveToThread(m_thread);
+    connect(m_thread, &QThread::finished, m_renderer, &QObject::deleteLater);
+
+    connect(this, &SpeedController::startRequested, m_renderer, &StretchRenderer::start);
+    connect(this, &SpeedController::stopRequested, m_renderer, &StretchRenderer::stop);
+    connect(this, &SpeedController::flushRequested, m_renderer, &StretchRenderer::flush);
+    connect(this, &SpeedController::rateRequested, m_renderer, &StretchRenderer::setRate);
+    connect(this, &SpeedController::volumeRequested, m_renderer, &StretchRenderer::setVolume);
+
+    connect(m_renderer, &StretchRenderer::statsReady, this, [this](double dspLoad, int underruns, qint64 droppedMs) {
+        m_dspLoad = dspLoad;
+        m_underruns = underruns;
+        m_droppedMs = droppedMs;
+        emit statsChanged(dspLoad, underruns);
+    });
+
+    m_thread->start();
+}
+
+SpeedController::~SpeedController()
+{
+    stopStretching();
+    m_thread->quit();
+    m_thread->wait();
+}
+
+void SpeedController::setPlayer(QMediaPlayer *player, QAudioOutput *audioOutput)
+{
+    if (m_player == player && m_audioOutput == audioOutput)
+        return;
+
+    // Hand the previous player its own output back before moving on.
+    stopStretching();
+
+    for (const QMetaObject::Connection& connection : std::as_const(m_playerConnections))
+        disconnect(connection);
+    m_playerConnections.clear();
+
+    m_player = player;
+    m_audioOutput = audioOutput;
+    connectPlayer();
+
+    updateRouting();
+}
+
+void SpeedController::handOver(QMediaPlayer *player, QAudioOutput *audioOutput)
+{
+    if (!m_stretching || m_player == player) {
+        setPlayer(player, audioOutput);
+        return;
+    }
+
+    // The renderer keeps its state and queued output; only its input moves to the new player.
+    for (const QMetaObject::Connection& connection : std::as_const(m_playerConnections))
+        disconnect(connection);
+    m_playerConnections.clear();
+    m_player->setAudioOutput(m_audioOutput);
+
+    m_player = player;
+    m_audioOutput = audioOutput;
+    m_player->setAudioOutput(nullptr);
+    m_player->setPlaybackRate(m_rate);
+    connectPlayer();
+    updateVolume();
+}
+
+void SpeedController::connectPlayer()
+{
+    if (m_player) {
+        // Stretched audio queued before a pause or seek must not be played after it.
+        m_playerConnections << connect(m_player, &QMediaPlayer::playbackStateChanged, this, [this](QMediaPlayer::PlaybackState state) {
+            if (state != QMediaPlayer::PlayingState)
+                flush();
+        });
+    }
+    if (m_audioOutput) {
+        m_playerConnections << connect(m_audioOutput, &QAudioOutput::volumeChanged, this, &SpeedController::updateVolume);
+        m_playerConnections << connect(m_audioOutput, &QAudioOutput::mutedChanged, this, &SpeedController::updateVolume);
+    }
+}
+
+void SpeedController::setRate(double rate)
+{
+    rate = std::clamp(rate, mApp::STRETCH_MIN_RATE, mApp::STRETCH_MAX_RATE);
+    if (qFuzzyCompare(m_rate, rate))
+        return;
+
+    m_rate = rate;
+    emit rateRequested(m_rate);
+    updateRouting();
+    emit rateChanged(m_rate);
+
+    qDebug() << Q_FUNC_INFO << "Playback speed" << m_rate << (m_stretching ? "(time-stretched)" : "");
+}
+
+void SpeedController::faster()
+{
+    const double* steps = std::begin(mApp::PLAYBACK_SPEED_STEPS);
+    const double* end = std::end(mApp::PLAYBACK_SPEED_STEPS);
+    const double* next = std::upper_bound(steps, end, m_rate + 1e-6);
+    if (next != end)
+        setRate(*next);
+}
+
+void SpeedController::slower()
+{
+    const double* steps = std::begin(mApp::PLAYBACK_SPEED_STEPS);
+    const double* lower = std::lower_bound(steps, std::end(mApp::PLAYBACK_SPEED_STEPS), m_rate - 1e-6);
+    if (lower != steps)
+        setRate(*(lower - 1));
+}
+
+void SpeedController::flush()
+{
+    if (m_stretching)
+        emit flushRequested();
+}
+
+void SpeedController::updateRouting()
+{
+    if (m_player)
+        m_player->setPlaybackRate(m_rate);
+
+    const bool wantStretch = m_player && AudioTap::isSupported() && !qFuzzyCompare(m_rate, 1.0);
+    if (wantStretch && !m_stretching)
+        startStretching();
+    else if (!wantStretch && m_stretching)
+        stopStretching();
+    else if (m_stretching)
+        flush();
+}
+
+void SpeedController::startStretching()
+{
+    if (!m_tap || !m_player)
+        return;
+
+    m_stretching = true;
+    m_player->setAudioOutput(nullptr);
+
+    emit rateRequested(m_rate);
+    updateVolume();
+    emit startRequested();
+
+    // Runs in the emitting thread; the renderer must see every buffer, so they are queued, not dropped.
+    StretchRenderer* renderer = m_renderer;
+    m_tapConnection = connect(m_tap, &AudioTap::bufferReceived, renderer, [renderer](const QAudioBuffer& buffer) {
+        QMetaObject::invokeMethod(renderer, [renderer, buffer]() {
+            renderer->processBuffer(buffer);
+        }, Qt::QueuedConnection);
+    }, Qt::DirectConnection);
+    m_tap->acquire();
+}
+
+void SpeedController::stopStretching()
+{
+    if (!m_stretching)
+        return;
+
+    m_stretching = false;
+    disconnect(m_tapConnection);
+    m_tapConnection = QMetaObject::Connection();
+    if (m_tap)
+        m_tap->release();
+    emit stopRequested();
+
+    if (m_player)
+        m_player->setAudioOutput(m_audioOutput);
+
+    m_dspLoad = 0.0;
+    emit statsChanged(0.0, m_underruns);
+}
+
+void SpeedController::updateVolume()
+{
+    if (!m_audioOutput)
+        return;
+    emit volumeRequested(m_audioOutput->isMuted() ? 0.0f : m_audioOutput->volume());
+}
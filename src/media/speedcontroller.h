@@ -0,0 +1,79 @@
+#ifndef SPEEDCONTROLLER_H
+#define SPEEDCONTROLLER_H
+
+#include <QObject>
+#include <QPointer>
+
+class AudioTap;
+class QAudioOutput;
+class QMediaPlayer;
+class QThread;
+class StretchRenderer;
+
+/*
+ * Playback speed for the active player, 0.25x to 4x.
+ *
+ * At 1x the player drives its own audio output. At any other speed the
+ * output is detached, the decoded PCM is taken from the AudioTap and a
+ * StretchRenderer worker time-stretches it so pitch is preserved.
+ * Volume and mute keep following the player's QAudioOutput.
+ * Without QAudioBufferOutput (Qt < 6.8) the backend's own rate change
+ * is used as is.
+ */
+class SpeedController : public QObject
+{
+    Q_OBJECT
+public:
+    explicit SpeedController(AudioTap* tap, QObject* parent = nullptr);
+    ~SpeedController();
+
+    void setPlayer(QMediaPlayer* player, QAudioOutput* audioOutput);
+    // Another player of the same stream, e.g. an A-B loop wrap; a running stretch is not restarted.
+    void handOver(QMediaPlayer* player, QAudioOutput* audioOutput);
+
+    void setRate(double rate);
+    double rate() const { return m_rate; }
+    void faster();
+    void slower();
+
+    bool isStretching() const { return m_stretching; }
+    double dspLoad() const { return m_dspLoad; }
+    int underruns() const { return m_underruns; }
+    qint64 droppedMs() const { return m_droppedMs; }   // output dropped to keep up, since stretching started
+
+    void flush();
+
+signals:
+    void rateChanged(double rate);
+    void statsChanged(double dspLoad, int underruns);
+
+    void startRequested();
+    void stopRequested();
+    void flushRequested();
+    void rateRequested(double rate);
+    void volumeRequested(float volume);
+
+private:
+    void connectPlayer();
+    void updateRouting();
+    void startStretching();
+    void stopStretching();
+    void updateVolume();
+
+    QPointer<AudioTap> m_tap;
+    QMediaPlayer* m_player = nullptr;
+    QAudioOutput* m_audioOutput = nullptr;
+    QList<QMetaObject::Connection> m_playerConnections;
+    QMetaObject::Connection m_tapConnection;
+
+    QThread* m_thread = nullptr;
+    StretchRenderer* m_renderer = nullptr;
+
+    double m_rate = 1.0;
+    bool m_stretching = false;
+    double m_dspLoad = 0.0;
+    int m_underruns = 0;
+    qint64 m_droppedMs = 0;
+};
+
+#endif // SPEEDCONTROLLER_H
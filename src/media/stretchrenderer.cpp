@@ -0,0 +1,172 @@
+#include "stretchrenderer.h"
+
+#include <QAudioSink>
+#include <QMediaDevices>
+#include <QTimer>
+
+StretchRenderer::StretchRenderer(QObject *parent)
+    : QObject(parent)
+    , m_stretcher(2)
+{
+}
+
+StretchRenderer::~StretchRenderer()
+{
+    closeSink();
+}
+
+void StretchRenderer::start()
+{
+    m_running = true;
+    m_stretcher.reset();
+    m_pending.clear();
+    m_droppedFrames = 0;
+    m_busyNs = m_audioNs = 0;
+    m_statsClock.start();
+}
+
+void StretchRenderer::stop()
+{
+    m_running = false;
+    closeSink();
+}
+
+void StretchRenderer::flush()
+{
+    // After a seek or pause the stretched tail belongs to the old position.
+    m_stretcher.reset();
+    m_pending.clear();
+    if (m_sink)
+        m_sink->reset();
+    m_device = m_sink ? m_sink->start() : nullptr;
+}
+
+void StretchRenderer::setRate(double rate)
+{
+    m_stretcher.setRate(rate);
+}
+
+void StretchRenderer::setVolume(float volume)
+{
+    m_volume = volume;
+    if (m_sink)
+        m_sink->setVolume(volume);
+}
+
+void StretchRenderer::openSink(const QAudioFormat &format)
+{
+    closeSink();
+
+    m_format = format;
+    m_sink = new QAudioSink(QMediaDevices::defaultAudioOutput(), format, this);
+    m_sink->setBufferSize(format.bytesForDuration(mApp::STRETCH_SINK_BUFFER_MS * 1000));
+    m_sink->setVolume(m_volume);
+    connect(m_sink, &QAudioSink::stateChanged, this, [this](QAudio::State state) {
+        if (state == QAudio::IdleState && m_sink->error() == QAudio::UnderrunError && m_running)
+            ++m_underruns;
+    });
+    m_device = m_sink->start();
+
+    if (!m_drainTimer) {
+        m_drainTimer = new QTimer(this);
+        m_drainTimer->setInterval(10);
+        connect(m_drainTimer, &QTimer::timeout, this, &StretchRenderer::drain);
+    }
+}
+
+void StretchRenderer::closeSink()
+{
+    if (m_drainTimer)
+        m_drainTimer->stop();
+    if (m_sink) {
+        m_sink->stop();
+        delete m_sink;
+        m_sink = nullptr;
+    }
+    m_device = nullptr;
+    m_pending.clear();
+}
+
+void StretchRenderer::processBuffer(const QAudioBuffer &buffer)
+{
+    if (!m_running || !buffer.isValid())
+        return;
+
+    const QAudioFormat format = buffer.format();
+    if (format.sampleFormat() != QAudioFormat::Float || format.channelCount() != m_stretcher.channelCount()) {
+        qWarning() << Q_FUNC_INFO << "Unexpected tap format" << format;
+        return;
+    }
+    if (!m_sink || format != m_format)
+        openSink(format);
+
+    QElapsedTimer busy;
+    busy.start();
+
+    m_output.clear();
+    const int produced = m_stretcher.process(buffer.constData<float>(), buffer.frameCount(), &m_output);
+    m_pending.append(reinterpret_cast<const char*>(m_output.constData()), produced * format.bytesPerFrame());
+
+    m_busyNs += busy.nsecsElapsed();
+    // Input arrives rate times faster than real time; load is against wall-clock time.
+    m_audioNs += qint64(buffer.duration() * 1000 / m_stretcher.rate());
+
+    // Never let the queue grow: drop output rather than drift behind the video.
+    if (m_pending.size() > format.bytesForDuration(mApp::STRETCH_MAX_PENDING_MS * 1000))
+        dropBacklog();
+
+    drain();
+
+    if (m_statsClock.elapsed() >= mApp::STRETCH_STATS_INTERVAL_MS) {
+        emit statsReady(m_audioNs > 0 ? double(m_busyNs) / m_audioNs : 0.0, m_underruns,
+                        m_format.durationForFrames(int(qMin<qint64>(m_droppedFrames, INT_MAX))) / 1000);
+        m_busyNs = m_audioNs = 0;
+        m_statsClock.restart();
+    }
+}
+
+void StretchRenderer::dropBacklog()
+{
+    // Whole synthesis hops are cut just after the head of the queue, which continues what the
+    // sink already has; the head crossfades into the audio after the cut so there is no click.
+    const int channels = m_format.channelCount();
+    const int hop = mApp::STRETCH_FRAME_SIZE / 2;
+    const int fade = m_format.framesForDuration(mApp::STRETCH_DROP_FADE_MS * 1000);
+    const int pendingFrames = m_pending.size() / m_format.bytesPerFrame();
+    const int excess = pendingFrames - m_format.framesForDuration(mApp::STRETCH_MAX_PENDING_MS * 1000);
+    const int drop = (qMax(excess, fade) + hop - 1) / hop * hop;
+    if (excess <= 0 || drop + fade > pendingFrames)
+        return;
+
+    float* head = reinterpret_cast<float*>(m_pending.data());
+    const float* tail = head + qint64(drop) * channels;
+    for (int i = 0; i < fade; ++i) {
+        const float t = (i + 0.5f) / fade;
+        for (int c = 0; c < channels; ++c)
+            head[i * channels + c] += (tail[i * channels + c] - head[i * channels + c]) * t;
+    }
+    m_pending.remove(fade * m_format.bytesPerFrame(), drop * m_format.bytesPerFrame());
+    m_droppedFrames += drop;
+}
+
+void StretchRenderer::drain()
+{
+    if (!m_device || m_pending.isEmpty()) {
+        if (m_drainTimer)
+            m_drainTimer->stop();
+        return;
+    }
+
+    const qint64 bytesFree = m_sink->bytesFree();
+    const qint64 chunk = qMin<qint64>(bytesFree - bytesFree % m_format.bytesPerFrame(), m_pending.size());
+    if (chunk > 0) {
+        const qint64 written = m_device->write(m_pending.constData(), chunk);
+        if (written > 0)
+            m_pending.remove(0, int(written));
+    }
+
+    if (m_pending.isEmpty())
+        m_drainTimer->stop();
+    else if (!m_drainTimer->isActive())
+        m_drainTimer->start();
+}
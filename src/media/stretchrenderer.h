@@ -0,0 +1,70 @@
+#ifndef STRETCHRENDERER_H
+#define STRETCHRENDERER_H
+
+#include <QObject>
+#include <QAudioBuffer>
+#include <QAudioFormat>
+#include <QElapsedTimer>
+
+#include "timestretcher.h"
+
+class QAudioSink;
+class QIODevice;
+class QTimer;
+
+namespace mApp {
+const int STRETCH_SINK_BUFFER_MS = 100;
+const int STRETCH_MAX_PENDING_MS = 300;   // older output is dropped to bound latency
+const int STRETCH_DROP_FADE_MS = 5;       // crossfade across a dropped stretch of output
+const int STRETCH_STATS_INTERVAL_MS = 500;
+}
+
+/*
+ * Runs on a worker thread. Takes tapped PCM from the player (consumed at
+ * playback rate), time-stretches it back to real time so pitch is kept
+ * and plays it through its own audio sink. Reports the stretch cost as
+ * processing time / audio time, the sink underrun count and how much
+ * output was dropped to keep up with the player.
+ */
+class StretchRenderer : public QObject
+{
+    Q_OBJECT
+public:
+    explicit StretchRenderer(QObject* parent = nullptr);
+    ~StretchRenderer();
+
+    void start();
+    void stop();
+    void flush();
+    void setRate(double rate);
+    void setVolume(float volume);
+    void processBuffer(const QAudioBuffer& buffer);
+
+signals:
+    void statsReady(double dspLoad, int underruns, qint64 droppedMs);
+
+private:
+    void openSink(const QAudioFormat& format);
+    void closeSink();
+    void drain();
+    void dropBacklog();
+
+    TimeStretcher m_stretcher;
+    QVector<float> m_output;
+
+    QAudioFormat m_format;
+    QAudioSink* m_sink = nullptr;
+    QIODevice* m_device = nullptr;
+    QTimer* m_drainTimer = nullptr;
+    QByteArray m_pending;
+    float m_volume = 1.0f;
+    bool m_running = false;
+
+    int m_underruns = 0;
+    qint64 m_droppedFrames = 0;
+    qint64 m_busyNs = 0;
+    qint64 m_audioNs = 0;
+    QElapsedTimer m_statsClock;
+};
+
+#endif // STRETCHRENDERER_H
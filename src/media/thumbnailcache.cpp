@@ -0,0 +1,191 @@
+#include "thumbnailcache.h"
+#include "thumbnailgenerator.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QPainter>
+#include <QStandardPaths>
+#include <QThread>
+
+ThumbnailCache::ThumbnailCache(QObject* parent)
+    : QObject(parent)
+    , m_thread(new QThread(this))
+    , m_generator(new ThumbnailGenerator)
+{
+    m_generator->moveToThread(m_thread);
+    connect(m_thread, &QThread::finished, m_generator, &QObject::deleteLater);
+
+    connect(this, &ThumbnailCache::generateRequested, m_generator, &ThumbnailGenerator::generate);
+    connect(this, &ThumbnailCache::stopRequested, m_generator, &ThumbnailGenerator::stop);
+
+    connect(m_generator, &ThumbnailGenerator::cachedSheetFound, this, [this](int generation, const QString& sheetPath) {
+        if (generation == m_generation)
+            mapSheet(sheetPath);
+    });
+
+    connect(m_generator, &ThumbnailGenerator::sheetStarted, this, [this](int generation, qint64 intervalMs, int count, const QSize& thumbSize) {
+        if (generation != m_generation)
+            return;
+        m_intervalMs = intervalMs;
+        m_count = count;
+        m_thumbSize = thumbSize;
+
+        const int rows = (count + mApp::THUMBNAIL_SHEET_COLUMNS - 1) / mApp::THUMBNAIL_SHEET_COLUMNS;
+        m_sheet = QImage(thumbSize.width() * mApp::THUMBNAIL_SHEET_COLUMNS, thumbSize.height() * rows,
+                         QImage::Format_ARGB32_Premultiplied);
+        m_sheet.fill(Qt::black);
+        m_available = QBitArray(count);
+    });
+
+    connect(m_generator, &ThumbnailGenerator::thumbnailReady, this, [this](int generation, int index, const QImage& thumbnail) {
+        if (generation != m_generation || index >= m_count)
+            return;
+        QPainter painter(&m_sheet);
+        painter.drawImage(tileRect(index).topLeft(), thumbnail);
+        m_available.setBit(index);
+    });
+
+    connect(m_generator, &ThumbnailGenerator::sheetSaved, this, [this](int generation, const QString& sheetPath) {
+        enforceCacheLimit(sheetPath);
+        // Swap the in-memory copy for the mapped file.
+        if (generation == m_generation)
+            mapSheet(sheetPath);
+    });
+
+    m_thread->start(QThread::LowPriority);
+}
+
+ThumbnailCache::~ThumbnailCache()
+{
+    m_thread->quit();
+    m_thread->wait();
+    unmapSheet();
+}
+
+void ThumbnailCache::open(const QString &filePath)
+{
+    close();
+    emit generateRequested(filePath, m_generation, cacheDirectory(), mApp::THUMBNAIL_SIZE);
+}
+
+void ThumbnailCache::close()
+{
+    ++m_generation; // late results of the previous file are dropped
+    emit stopRequested();
+
+    unmapSheet();
+    m_sheet = QImage();
+    m_available.clear();
+    m_count = 0;
+    m_intervalMs = 0;
+}
+
+QImage ThumbnailCache::thumbnailAt(qint64 positionMs) const
+{
+    if (m_count <= 0 || m_intervalMs <= 0 || m_sheet.isNull())
+        return QImage();
+
+    const int index = static_cast<int>(qBound<qint64>(0, positionMs / m_intervalMs, m_count - 1));
+    if (!m_available.testBit(index))
+        return QImage();
+
+    return m_sheet.copy(tileRect(index));
+}
+
+void ThumbnailCache::setCacheLimit(qint64 bytes)
+{
+    m_cacheLimit = bytes;
+    enforceCacheLimit(QString());
+}
+
+bool ThumbnailCache::mapSheet(const QString &sheetPath)
+{
+    unmapSheet();
+
+    m_mappedFile.setFileName(sheetPath);
+    if (!m_mappedFile.open(QIODevice::ReadWrite)) {
+        qWarning() << Q_FUNC_INFO << "Cannot open thumbnail sheet" << sheetPath;
+        return false;
+    }
+
+    QDataStream in(m_mappedFile.read(mApp::THUMBNAIL_SHEET_HEADER_SIZE));
+    quint32 magic = 0, version = 0;
+    qint32 thumbWidth = 0, thumbHeight = 0, columns = 0, count = 0, width = 0, height = 0, bytesPerLine = 0;
+    qint64 intervalMs = 0;
+    in >> magic >> version >> thumbWidth >> thumbHeight >> columns >> count >> intervalMs
+       >> width >> height >> bytesPerLine;
+
+    const qint64 expectedSize = mApp::THUMBNAIL_SHEET_HEADER_SIZE + qint64(bytesPerLine) * height;
+    if (magic != mApp::THUMBNAIL_SHEET_MAGIC || version != mApp::THUMBNAIL_SHEET_VERSION
+        || columns != mApp::THUMBNAIL_SHEET_COLUMNS || count <= 0 || m_mappedFile.size() < expectedSize) {
+        qWarning() << Q_FUNC_INFO << "Discarding invalid thumbnail sheet" << sheetPath;
+        m_mappedFile.remove();
+        return false;
+    }
+
+    m_mappedData = m_mappedFile.map(0, expectedSize);
+    if (!m_mappedData) {
+        m_mappedFile.close();
+        return false;
+    }
+
+    // Mark the sheet as recently used for LRU eviction.
+    m_mappedFile.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+
+    const uchar* pixels = m_mappedData + mApp::THUMBNAIL_SHEET_HEADER_SIZE;
+    m_sheet = QImage(pixels, width, height, bytesPerLine, QImage::Format_ARGB32_Premultiplied);
+    m_thumbSize = QSize(thumbWidth, thumbHeight);
+    m_count = count;
+    m_intervalMs = intervalMs;
+    m_available = QBitArray(count, true);
+    return true;
+}
+
+void ThumbnailCache::unmapSheet()
+{
+    if (!m_mappedData)
+        return;
+
+    m_sheet = QImage(); // must not outlive the mapping
+    m_mappedFile.unmap(m_mappedData);
+    m_mappedFile.close();
+    m_mappedData = nullptr;
+}
+
+void ThumbnailCache::enforceCacheLimit(const QString &keepPath)
+{
+    QDir dir(cacheDirectory());
+    // Oldest first: the head of the list is the least recently used sheet.
+    QFileInfoList sheets = dir.entryInfoList({"*.sheet"}, QDir::Files, QDir::Time | QDir::Reversed);
+
+    qint64 total = 0;
+    for (const QFileInfo& sheet : std::as_const(sheets))
+        total += sheet.size();
+
+    for (const QFileInfo& sheet : std::as_const(sheets)) {
+        if (total <= m_cacheLimit)
+            break;
+        const QString path = sheet.absoluteFilePath();
+        if (path == keepPath || path == m_mappedFile.fileName())
+            continue;
+        if (QFile::remove(path)) {
+            total -= sheet.size();
+            qDebug() << Q_FUNC_INFO << "Evicted thumbnail sheet" << path;
+        }
+    }
+}
+
+QRect ThumbnailCache::tileRect(int index) const
+{
+    const int column = index % mApp::THUMBNAIL_SHEET_COLUMNS;
+    const int row = index / mApp::THUMBNAIL_SHEET_COLUMNS;
+    return QRect(QPoint(column * m_thumbSize.width(), row * m_thumbSize.height()), m_thumbSize);
+}
+
+QString ThumbnailCache::cacheDirectory()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/thumbnails";
+}
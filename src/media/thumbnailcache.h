@@ -0,0 +1,71 @@
+#ifndef THUMBNAILCACHE_H
+#define THUMBNAILCACHE_H
+
+#include <QObject>
+#include <QBitArray>
+#include <QFile>
+#include <QImage>
+#include <QSize>
+
+class QThread;
+class ThumbnailGenerator;
+
+namespace mApp {
+const qint64 THUMBNAIL_CACHE_DEFAULT_LIMIT = 256 * 1024 * 1024;
+const QSize THUMBNAIL_SIZE(160, 90);
+}
+
+/*
+ * GUI-side access to the scrubbing thumbnails of the current file.
+ *
+ * Generation and hashing happen on a ThumbnailGenerator worker thread;
+ * thumbnails show up here as they are produced. Finished sheets are
+ * memory-mapped from the disk cache, which is trimmed to a size limit
+ * by evicting the least recently used sheets.
+ * thumbnailAt() never waits: it returns a null image if the tile is
+ * not there yet.
+ */
+class ThumbnailCache : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ThumbnailCache(QObject* parent = nullptr);
+    ~ThumbnailCache();
+
+    void open(const QString& filePath);
+    void close();
+
+    QImage thumbnailAt(qint64 positionMs) const;
+
+    void setCacheLimit(qint64 bytes);
+    qint64 cacheLimit() const { return m_cacheLimit; }
+
+signals:
+    void generateRequested(const QString& filePath, int generation, const QString& cacheDir, const QSize& thumbSize);
+    void stopRequested();
+
+private:
+    bool mapSheet(const QString& sheetPath);
+    void unmapSheet();
+    void enforceCacheLimit(const QString& keepPath);
+    QRect tileRect(int index) const;
+
+    static QString cacheDirectory();
+
+    QThread* m_thread = nullptr;
+    ThumbnailGenerator* m_generator = nullptr;
+
+    int m_generation = 0;
+    qint64 m_cacheLimit = mApp::THUMBNAIL_CACHE_DEFAULT_LIMIT;
+
+    // Either a mapped sheet from disk or the one being filled in memory.
+    QFile m_mappedFile;
+    uchar* m_mappedData = nullptr;
+    QImage m_sheet;
+    QBitArray m_available;
+    QSize m_thumbSize;
+    qint64 m_intervalMs = 0;
+    int m_count = 0;
+};
+
+#endif // THUMBNAILCACHE_H
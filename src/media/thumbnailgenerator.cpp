@@ -0,0 +1,200 @@
+#include "thumbnailgenerator.h"
+#include "keyframeindex.h"
+
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QMediaPlayer>
+#include <QPainter>
+#include <QSaveFile>
+#include <QTimer>
+#include <QVideoFrame>
+#include <QVideoSink>
+
+ThumbnailGenerator::ThumbnailGenerator(QObject* parent)
+    : QObject(parent)
+{
+}
+
+QString ThumbnailGenerator::sheetPath(const QString &cacheDir, const QString &hash)
+{
+    return cacheDir + "/" + hash + ".sheet";
+}
+
+void ThumbnailGenerator::ensurePlayer()
+{
+    if (m_player)
+        return;
+
+    // Created here so that the player and its sink belong to the worker thread.
+    m_player = new QMediaPlayer(this);
+    m_sink = new QVideoSink(this);
+    m_frameTimeout = new QTimer(this);
+    m_frameTimeout->setSingleShot(true);
+    m_frameTimeout->setInterval(mApp::THUMBNAIL_FRAME_TIMEOUT_MS);
+
+    m_player->setVideoSink(m_sink);
+
+    connect(m_sink, &QVideoSink::videoFrameChanged, this, &ThumbnailGenerator::handleFrame);
+
+    connect(m_player, &QMediaPlayer::mediaStatusChanged, this, [this](QMediaPlayer::MediaStatus status) {
+        if (status == QMediaPlayer::InvalidMedia) {
+            qWarning() << Q_FUNC_INFO << "Cannot generate thumbnails for" << m_filePath;
+            stop();
+            return;
+        }
+        if (status != QMediaPlayer::LoadedMedia || m_count > 0 || m_filePath.isEmpty())
+            return;
+
+        const qint64 duration = m_player->duration();
+        if (duration <= 0 || !m_player->hasVideo()) {
+            stop();
+            return;
+        }
+
+        m_count = static_cast<int>(qBound<qint64>(1, duration / mApp::THUMBNAIL_MIN_INTERVAL_MS, mApp::THUMBNAIL_MAX_COUNT));
+        m_intervalMs = duration / m_count;
+
+        const int rows = (m_count + mApp::THUMBNAIL_SHEET_COLUMNS - 1) / mApp::THUMBNAIL_SHEET_COLUMNS;
+        m_sheet = QImage(m_thumbSize.width() * mApp::THUMBNAIL_SHEET_COLUMNS,
+                         m_thumbSize.height() * rows, QImage::Format_ARGB32_Premultiplied);
+        m_sheet.fill(Qt::black);
+
+        emit sheetStarted(m_generation, m_intervalMs, m_count, m_thumbSize);
+
+        m_player->pause(); // paused seeks still deliver a frame to the sink
+        requestNextFrame();
+    });
+
+    connect(m_frameTimeout, &QTimer::timeout, this, [this]() {
+        // Leave the tile black and move on rather than stalling the sheet.
+        if (m_awaitingFrame)
+            acceptFrame(QImage());
+    });
+}
+
+void ThumbnailGenerator::generate(const QString &filePath, int generation, const QString &cacheDir, const QSize &thumbSize)
+{
+    stop();
+
+    m_generation = generation;
+    m_thumbSize = thumbSize;
+
+    const QString hash = KeyframeIndex::contentHash(filePath);
+    if (hash.isEmpty())
+        return;
+
+    m_sheetPath = sheetPath(cacheDir, hash);
+    if (QFile::exists(m_sheetPath)) {
+        emit cachedSheetFound(generation, m_sheetPath);
+        return;
+    }
+
+    QDir().mkpath(cacheDir);
+
+    ensurePlayer();
+    m_filePath = filePath;
+    m_player->setSource(QUrl::fromLocalFile(filePath));
+}
+
+void ThumbnailGenerator::stop()
+{
+    m_filePath.clear();
+    m_count = 0;
+    m_nextIndex = 0;
+    m_awaitingFrame = false;
+    m_sheet = QImage();
+
+    if (m_player) {
+        m_frameTimeout->stop();
+        m_player->stop();
+        m_player->setSource(QUrl());
+    }
+}
+
+void ThumbnailGenerator::requestNextFrame()
+{
+    if (m_filePath.isEmpty())
+        return;
+
+    if (m_nextIndex >= m_count) {
+        saveSheet();
+        stop();
+        return;
+    }
+
+    m_awaitingFrame = true;
+    m_frameTimeout->start();
+    m_player->setPosition(m_nextIndex * m_intervalMs);
+}
+
+void ThumbnailGenerator::handleFrame(const QVideoFrame &frame)
+{
+    if (!m_awaitingFrame || !frame.isValid())
+        return;
+
+    // Ignore frames from before the seek took effect.
+    const qint64 target = m_nextIndex * m_intervalMs;
+    const qint64 frameMs = frame.startTime() / 1000;
+    if (frame.startTime() >= 0 && qAbs(frameMs - target) > m_intervalMs)
+        return;
+
+    acceptFrame(frame.toImage());
+}
+
+void ThumbnailGenerator::acceptFrame(const QImage &image)
+{
+    m_awaitingFrame = false;
+    m_frameTimeout->stop();
+
+    QImage thumbnail(m_thumbSize, QImage::Format_ARGB32_Premultiplied);
+    thumbnail.fill(Qt::black);
+    if (!image.isNull()) {
+        const QImage scaled = image.scaled(m_thumbSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+        QPainter painter(&thumbnail);
+        painter.drawImage((m_thumbSize.width() - scaled.width()) / 2,
+                          (m_thumbSize.height() - scaled.height()) / 2, scaled);
+    }
+
+    const int column = m_nextIndex % mApp::THUMBNAIL_SHEET_COLUMNS;
+    const int row = m_nextIndex / mApp::THUMBNAIL_SHEET_COLUMNS;
+    {
+        QPainter painter(&m_sheet);
+        painter.drawImage(column * m_thumbSize.width(), row * m_thumbSize.height(), thumbnail);
+    }
+
+    emit thumbnailReady(m_generation, m_nextIndex, thumbnail);
+    ++m_nextIndex;
+
+    // Yield to the event loop so a newer request can take over.
+    QTimer::singleShot(0, this, &ThumbnailGenerator::requestNextFrame);
+}
+
+void ThumbnailGenerator::saveSheet()
+{
+    QSaveFile file(m_sheetPath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << Q_FUNC_INFO << "Cannot write thumbnail sheet" << m_sheetPath;
+        return;
+    }
+
+    // Fixed-size header, then raw pixels so the sheet can be mapped as is.
+    QByteArray header;
+    QDataStream out(&header, QIODevice::WriteOnly);
+    out << mApp::THUMBNAIL_SHEET_MAGIC << mApp::THUMBNAIL_SHEET_VERSION
+        << qint32(m_thumbSize.width()) << qint32(m_thumbSize.height())
+        << qint32(mApp::THUMBNAIL_SHEET_COLUMNS) << qint32(m_count) << m_intervalMs
+        << qint32(m_sheet.width()) << qint32(m_sheet.height()) << qint32(m_sheet.bytesPerLine());
+    header.resize(mApp::THUMBNAIL_SHEET_HEADER_SIZE, '\0');
+
+    file.write(header);
+    file.write(reinterpret_cast<const char*>(m_sheet.constBits()), m_sheet.sizeInBytes());
+
+    if (!file.commit()) {
+        qWarning() << Q_FUNC_INFO << "Failed to save thumbnail sheet" << m_sheetPath;
+        return;
+    }
+
+    emit sheetSaved(m_generation, m_sheetPath);
+}
@@ -0,0 +1,71 @@
+#ifndef THUMBNAILGENERATOR_H
+#define THUMBNAILGENERATOR_H
+
+#include <QObject>
+#include <QImage>
+#include <QSize>
+#include <QString>
+
+class QMediaPlayer;
+class QTimer;
+class QVideoFrame;
+class QVideoSink;
+
+namespace mApp {
+const quint32 THUMBNAIL_SHEET_MAGIC = 0x4D4D5453; // "MMTS"
+const quint32 THUMBNAIL_SHEET_VERSION = 1;
+const int THUMBNAIL_SHEET_HEADER_SIZE = 64;       // pixel data starts here
+const int THUMBNAIL_SHEET_COLUMNS = 10;
+const int THUMBNAIL_MAX_COUNT = 120;
+const qint64 THUMBNAIL_MIN_INTERVAL_MS = 2000;
+const int THUMBNAIL_FRAME_TIMEOUT_MS = 1500;
+}
+
+/*
+ * Lives on a worker thread and fills a sprite sheet of evenly spaced
+ * thumbnails with its own headless QMediaPlayer + QVideoSink.
+ * The finished sheet is written to the cache directory so it can be
+ * memory-mapped the next time the file is opened.
+ * Requests are handled one frame per event, so a new request takes over
+ * between two frames of the previous one.
+ */
+class ThumbnailGenerator : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ThumbnailGenerator(QObject* parent = nullptr);
+
+    void generate(const QString& filePath, int generation, const QString& cacheDir, const QSize& thumbSize);
+    void stop();
+
+    static QString sheetPath(const QString& cacheDir, const QString& hash);
+
+signals:
+    void cachedSheetFound(int generation, const QString& sheetPath);
+    void sheetStarted(int generation, qint64 intervalMs, int count, const QSize& thumbSize);
+    void thumbnailReady(int generation, int index, const QImage& thumbnail);
+    void sheetSaved(int generation, const QString& sheetPath);
+
+private:
+    void ensurePlayer();
+    void requestNextFrame();
+    void handleFrame(const QVideoFrame& frame);
+    void acceptFrame(const QImage& image);
+    void saveSheet();
+
+    QMediaPlayer* m_player = nullptr;
+    QVideoSink* m_sink = nullptr;
+    QTimer* m_frameTimeout = nullptr;
+
+    QString m_filePath;
+    QString m_sheetPath;
+    int m_generation = -1;
+    QSize m_thumbSize;
+    qint64 m_intervalMs = 0;
+    int m_count = 0;
+    int m_nextIndex = 0;
+    bool m_awaitingFrame = false;
+    QImage m_sheet;
+};
+
+#endif // THUMBNAILGENERATOR_H
@@ -0,0 +1,448 @@
+#include "tilepyramid.h"
+#include "bandreader.h"
+#include "imageresampler.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QImageWriter>
+#include <QMutex>
+#include <QSet>
+#include <QStandardPaths>
+#include <QtConcurrent/QtConcurrentMap>
+#include <QWaitCondition>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+const char* const COMPLETE_MARKER = "complete";
+const int BUILD_WAIT_POLL_MS = 100;
+
+/*
+ * Directories with a build running, across all TilePyramid instances.
+ * A cancelled build keeps writing until its current band is done, so a
+ * new build of the same pyramid waits for it instead of writing the same
+ * tiles concurrently.
+ */
+QMutex buildingMutex;
+QWaitCondition buildingReleased;
+QSet<QString> buildingDirectories;
+
+class DirectoryClaim
+{
+public:
+    // Blocks until no other build owns the directory; fails if the promise is cancelled meanwhile.
+    DirectoryClaim(const QString& directory, QPromise<TilePyramid::Progress>& promise)
+        : m_directory(directory)
+    {
+        QMutexLocker locker(&buildingMutex);
+        while (buildingDirectories.contains(directory)) {
+            if (promise.isCanceled())
+                return;
+            buildingReleased.wait(&buildingMutex, BUILD_WAIT_POLL_MS);
+        }
+        buildingDirectories.insert(directory);
+        m_claimed = true;
+    }
+
+    ~DirectoryClaim()
+    {
+        if (!m_claimed)
+            return;
+        QMutexLocker locker(&buildingMutex);
+        buildingDirectories.remove(m_directory);
+        buildingReleased.wakeAll();
+    }
+
+    bool isClaimed() const { return m_claimed; }
+
+private:
+    Q_DISABLE_COPY(DirectoryClaim)
+
+    QString m_directory;
+    bool m_claimed = false;
+};
+
+bool isDirectoryBuilding(const QString& directory)
+{
+    QMutexLocker locker(&buildingMutex);
+    return buildingDirectories.contains(directory);
+}
+
+/*
+ * Per-level strips of up to one tile row. Rows are appended band by band;
+ * a full strip is written out as tiles and its half-size copy is fed into
+ * the next level.
+ */
+class PyramidWriter
+{
+public:
+    PyramidWriter(const QString& directory, const QVector<QSize>& levelSizes)
+        : m_directory(directory)
+        , m_levelSizes(levelSizes)
+        , m_strips(levelSizes.size())
+        , m_stripRows(levelSizes.size(), 0)
+        , m_tileRows(levelSizes.size(), 0)
+    {
+        for (int level = 0; level < levelSizes.size(); ++level)
+            m_strips[level] = QImage(levelSizes[level].width(), mApp::PYRAMID_TILE_SIZE,
+                                     QImage::Format_ARGB32_Premultiplied);
+    }
+
+    // Appends rows to a level; returns false if a tile could not be written.
+    bool feed(QPromise<TilePyramid::Progress>& promise, int level, const QImage& rows)
+    {
+        int copied = 0;
+        while (copied < rows.height()) {
+            QImage& strip = m_strips[level];
+            const int count = qMin(rows.height() - copied, mApp::PYRAMID_TILE_SIZE - m_stripRows[level]);
+            const qsizetype lineBytes = qMin(rows.bytesPerLine(), strip.bytesPerLine());
+            for (int y = 0; y < count; ++y)
+                std::memcpy(strip.scanLine(m_stripRows[level] + y), rows.constScanLine(copied + y), lineBytes);
+            m_stripRows[level] += count;
+            copied += count;
+
+            if (m_stripRows[level] == mApp::PYRAMID_TILE_SIZE && !flush(promise, level))
+                return false;
+        }
+        return true;
+    }
+
+    // Writes the (partial) strip of a level as one tile row and feeds its half into the next level.
+    bool flush(QPromise<TilePyramid::Progress>& promise, int level)
+    {
+        const int rows = m_stripRows[level];
+        if (rows == 0)
+            return true;
+
+        const QImage strip = m_strips[level].copy(0, 0, m_levelSizes[level].width(), rows);
+        m_stripRows[level] = 0;
+
+        const int row = m_tileRows[level];
+        const int columns = (strip.width() + mApp::PYRAMID_TILE_SIZE - 1) / mApp::PYRAMID_TILE_SIZE;
+        QList<int> columnList;
+        for (int column = 0; column < columns; ++column)
+            columnList << column;
+
+        // PNG encoding dominates the build; the tiles of a row are independent.
+        QAtomicInt failed = 0;
+        QtConcurrent::blockingMap(columnList, [&](int column) {
+            const int x = column * mApp::PYRAMID_TILE_SIZE;
+            const QImage tile = strip.copy(x, 0, qMin(mApp::PYRAMID_TILE_SIZE, strip.width() - x), rows);
+            QImageWriter writer(TilePyramid::tileFileName(m_directory, level, column, row), "png");
+            writer.setQuality(mApp::PYRAMID_TILE_QUALITY);
+            if (!writer.write(tile))
+                failed.storeRelaxed(1);
+        });
+        if (failed.loadRelaxed()) {
+            promise.addResult(TilePyramid::Progress{level, row, QStringLiteral("Unable to write tiles to %1").arg(m_directory)});
+            return false;
+        }
+
+        m_tileRows[level] = row + 1;
+        promise.addResult(TilePyramid::Progress{level, row + 1, QString()});
+
+        if (level + 1 >= m_levelSizes.size())
+            return true;
+
+        const QSize halfSize(m_levelSizes[level + 1].width(), (rows + 1) / 2);
+        return feed(promise, level + 1, ImageResampler::scaled(strip, halfSize, ImageResampler::Filter_Area));
+    }
+
+    bool finish(QPromise<TilePyramid::Progress>& promise)
+    {
+        for (int level = 0; level < m_levelSizes.size(); ++level) {
+            if (!flush(promise, level))
+                return false;
+        }
+        return true;
+    }
+
+private:
+    QString m_directory;
+    QVector<QSize> m_levelSizes;
+    QVector<QImage> m_strips;
+    QVector<int> m_stripRows;
+    QVector<int> m_tileRows;
+};
+
+quint64 tileKey(int level, int column, int row)
+{
+    return (quint64(level) << 48) | (quint64(column) << 24) | quint64(row);
+}
+
+} // namespace
+
+TilePyramid::TilePyramid(QObject *parent)
+    : QObject(parent)
+{
+    m_tiles.setMaxCost(mApp::PYRAMID_TILE_CACHE_KB);
+}
+
+TilePyramid::~TilePyramid()
+{
+    close();
+}
+
+void TilePyramid::open(const QString &filePath, const QSize &sourceSize)
+{
+    close();
+    if (filePath.isEmpty() || !sourceSize.isValid())
+        return;
+
+    m_filePath = filePath;
+    m_sourceSize = sourceSize;
+
+    QSize size = sourceSize;
+    m_levelSizes << size;
+    while (size.width() > mApp::PYRAMID_TILE_SIZE || size.height() > mApp::PYRAMID_TILE_SIZE) {
+        size = QSize((size.width() + 1) / 2, (size.height() + 1) / 2);
+        m_levelSizes << size;
+    }
+    m_readyRows.fill(0, m_levelSizes.size());
+
+    // Keyed by path, size and modification time, so an edited file gets a new pyramid.
+    const QFileInfo info(filePath);
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(info.absoluteFilePath().toUtf8());
+    hash.addData(QByteArray::number(info.size()));
+    hash.addData(QByteArray::number(info.lastModified().toMSecsSinceEpoch()));
+    m_directory = cacheDirectory() + "/" + QString::fromLatin1(hash.result().toHex());
+
+    QFile marker(m_directory + "/" + COMPLETE_MARKER);
+    if (marker.open(QIODevice::ReadWrite | QIODevice::ExistingOnly)) {
+        // Mark the pyramid as recently used for LRU eviction.
+        marker.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+        for (int level = 0; level < m_levelSizes.size(); ++level)
+            m_readyRows[level] = tileRows(level);
+    }
+}
+
+void TilePyramid::close()
+{
+    if (m_watcher) {
+        // The band in flight finishes on the pool; nothing reads its tiles any more.
+        m_watcher->disconnect(this);
+        m_watcher->cancel();
+        m_watcher = nullptr;
+    }
+    m_filePath.clear();
+    m_directory.clear();
+    m_sourceSize = QSize();
+    m_levelSizes.clear();
+    m_readyRows.clear();
+    m_tiles.clear();
+}
+
+void TilePyramid::build()
+{
+    if (!isOpen() || m_watcher || isComplete())
+        return;
+
+    QDir().mkpath(m_directory);
+
+    auto* watcher = new QFutureWatcher<Progress>(this);
+    m_watcher = watcher;
+    connect(watcher, &QFutureWatcher<Progress>::resultReadyAt, this, [this, watcher](int index) {
+        const Progress progress = watcher->resultAt(index);
+        if (!progress.error.isEmpty()) {
+            qWarning() << Q_FUNC_INFO << progress.error;
+            emit buildFailed(progress.error);
+            return;
+        }
+        m_readyRows[progress.level] = progress.readyRows;
+        emit tilesAdded();
+    });
+    connect(watcher, &QFutureWatcher<Progress>::finished, this, [this, watcher]() {
+        if (watcher == m_watcher)
+            m_watcher = nullptr;
+    });
+    connect(watcher, &QFutureWatcher<Progress>::finished, watcher, &QObject::deleteLater);
+    watcher->setFuture(QtConcurrent::run(&TilePyramid::run, m_filePath, m_directory, m_levelSizes));
+}
+
+int TilePyramid::tileRows(int level) const
+{
+    return (levelSize(level).height() + mApp::PYRAMID_TILE_SIZE - 1) / mApp::PYRAMID_TILE_SIZE;
+}
+
+int TilePyramid::tileColumns(int level) const
+{
+    return (levelSize(level).width() + mApp::PYRAMID_TILE_SIZE - 1) / mApp::PYRAMID_TILE_SIZE;
+}
+
+bool TilePyramid::isComplete() const
+{
+    for (int level = 0; level < m_levelSizes.size(); ++level) {
+        if (m_readyRows[level] < tileRows(level))
+            return false;
+    }
+    return isOpen();
+}
+
+bool TilePyramid::isTileReady(int level, int column, int row) const
+{
+    if (level < 0 || level >= m_levelSizes.size() || column < 0 || row < 0)
+        return false;
+    return row < m_readyRows[level] && column < tileColumns(level);
+}
+
+bool TilePyramid::isTileCached(int level, int column, int row) const
+{
+    return m_tiles.contains(tileKey(level, column, row));
+}
+
+QPixmap TilePyramid::tile(int level, int column, int row)
+{
+    if (!isTileReady(level, column, row))
+        return QPixmap();
+
+    const quint64 key = tileKey(level, column, row);
+    if (QPixmap* cached = m_tiles.object(key))
+        return *cached;
+
+    QPixmap* pixmap = new QPixmap(tilePath(level, column, row));
+    if (pixmap->isNull()) {
+        delete pixmap;
+        return QPixmap();
+    }
+
+    const QPixmap result = *pixmap;
+    m_tiles.insert(key, pixmap, int(qint64(pixmap->width()) * pixmap->height() * 4 / 1024));
+    return result;
+}
+
+QString TilePyramid::tilePath(int level, int column, int row) const
+{
+    return tileFileName(m_directory, level, column, row);
+}
+
+QString TilePyramid::tileFileName(const QString &directory, int level, int column, int row)
+{
+    return QStringLiteral("%1/%2_%3_%4.png").arg(directory).arg(level).arg(column).arg(row);
+}
+
+bool TilePyramid::isRegionReady(const QRect &sourceRect) const
+{
+    // Rows are written top to bottom, so the last tile row of the region decides.
+    const QRect region = sourceRect.intersected(QRect(QPoint(0, 0), m_sourceSize));
+    return !region.isEmpty() && isTileReady(0, 0, region.bottom() / mApp::PYRAMID_TILE_SIZE);
+}
+
+QString TilePyramid::cacheDirectory()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/pyramids";
+}
+
+void TilePyramid::enforceCacheLimit(const QString &keepDirectory)
+{
+    struct Entry {
+        QString path;
+        QDateTime used;
+        qint64 bytes = 0;
+    };
+
+    // A finished pyramid was last used when its marker was touched; an unfinished one when a tile was written.
+    QList<Entry> entries;
+    qint64 total = 0;
+    const QFileInfoList directories = QDir(cacheDirectory()).entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot);
+    for (const QFileInfo& directory : directories) {
+        Entry entry{directory.absoluteFilePath(), directory.lastModified(), 0};
+        const QFileInfo marker(entry.path + "/" + COMPLETE_MARKER);
+        if (marker.exists())
+            entry.used = marker.lastModified();
+        for (const QFileInfo& file : QDir(entry.path).entryInfoList(QDir::Files))
+            entry.bytes += file.size();
+        total += entry.bytes;
+        entries << entry;
+    }
+
+    // Oldest first: the head of the list is the least recently used pyramid.
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.used < b.used; });
+
+    const QString keepPath = QFileInfo(keepDirectory).absoluteFilePath();
+    for (const Entry& entry : std::as_const(entries)) {
+        if (total <= mApp::PYRAMID_DISK_CACHE_LIMIT)
+            break;
+        if (entry.path == keepPath || isDirectoryBuilding(entry.path))
+            continue;
+        if (QDir(entry.path).removeRecursively()) {
+            total -= entry.bytes;
+            qDebug() << Q_FUNC_INFO << "Evicted pyramid" << entry.path << entry.bytes / (1024 * 1024) << "MB";
+        }
+    }
+}
+
+void TilePyramid::run(QPromise<Progress> &promise, const QString &filePath, const QString &directory,
+                      const QVector<QSize> &levelSizes)
+{
+    QElapsedTimer clock;
+    clock.start();
+
+    const QSize sourceSize = levelSizes.first();
+
+    const DirectoryClaim claim(directory, promise);
+    if (!claim.isClaimed())
+        return;
+
+    // The build this one waited for may have finished the pyramid; reuse it.
+    if (QFileInfo::exists(directory + "/" + COMPLETE_MARKER)) {
+        for (int level = 0; level < levelSizes.size(); ++level) {
+            const int rows = (levelSizes[level].height() + mApp::PYRAMID_TILE_SIZE - 1) / mApp::PYRAMID_TILE_SIZE;
+            promise.addResult(TilePyramid::Progress{level, rows, QString()});
+        }
+        return;
+    }
+
+    PyramidWriter writer(directory, levelSizes);
+
+    BandReader reader(filePath);
+    if (!reader.open()) {
+        promise.addResult(TilePyramid::Progress{-1, 0, QStringLiteral("Unable to decode %1 for zooming: %2")
+                                      .arg(filePath, reader.errorString())});
+        return;
+    }
+
+    // Whole tile rows per band, as many as fit the band budget.
+    const qint64 rowBytes = qint64(sourceSize.width()) * 4;
+    const int tileRowsPerBand = int(qBound<qint64>(1, mApp::PYRAMID_BAND_BYTES / (rowBytes * mApp::PYRAMID_TILE_SIZE), 64));
+    const int bandHeight = tileRowsPerBand * mApp::PYRAMID_TILE_SIZE;
+
+    for (int y = 0; y < sourceSize.height(); y += bandHeight) {
+        if (promise.isCanceled())
+            return;
+
+        const QImage band = reader.readRows(y, bandHeight);
+        if (band.isNull()) {
+            promise.addResult(TilePyramid::Progress{-1, 0, QStringLiteral("Unable to read %1: %2")
+                                          .arg(filePath, reader.errorString())});
+            return;
+        }
+
+        if (!writer.feed(promise, 0, band.convertToFormat(QImage::Format_ARGB32_Premultiplied)))
+            return;
+    }
+
+    if (promise.isCanceled() || !writer.finish(promise))
+        return;
+
+    QFile marker(directory + "/" + COMPLETE_MARKER);
+    if (!marker.open(QIODevice::WriteOnly)) {
+        promise.addResult(TilePyramid::Progress{-1, 0, QStringLiteral("Unable to finish pyramid in %1: %2")
+                                      .arg(directory, marker.errorString())});
+        return;
+    }
+    marker.close();
+
+    enforceCacheLimit(directory);
+
+    qInfo() << Q_FUNC_INFO << "Pyramid for" << filePath << sourceSize << "with" << levelSizes.size()
+            << "levels built in" << clock.elapsed() << "ms by" << BandReader::methodName(reader.method());
+}
@@ -0,0 +1,95 @@
+#ifndef TILEPYRAMID_H
+#define TILEPYRAMID_H
+
+#include <QObject>
+#include <QCache>
+#include <QFutureWatcher>
+#include <QPixmap>
+#include <QPromise>
+#include <QSize>
+#include <QString>
+#include <QVector>
+
+namespace mApp {
+const int PYRAMID_TILE_SIZE = 256;
+const int PYRAMID_TILE_QUALITY = 90;                        // PNG: fast, lossless compression
+const qint64 PYRAMID_BAND_BYTES = 128 * 1024 * 1024;        // rows decoded per region read
+const int PYRAMID_TILE_CACHE_KB = 256 * 1024;               // decoded tiles kept in memory
+const qint64 PYRAMID_DISK_CACHE_LIMIT = qint64(4) * 1024 * 1024 * 1024; // pyramids kept on disk
+}
+
+/*
+ * Tiled multi-resolution pyramid of one image for deep zoom.
+ *
+ * Level 0 is the source resolution, every next level halves it, down to
+ * a single tile. build() streams the source in horizontal bands on the
+ * Qt Concurrent pool through BandReader, so sources larger than memory
+ * work where the codec can be streamed (JPEG, PNG, TIFF), cuts
+ * each band into tiles, downsamples it into the next level and writes
+ * the tiles to the disk cache. Tiles show up row by row while building;
+ * a finished pyramid is reused when the same file is opened again. Only
+ * one build writes a pyramid directory at a time; a build started while
+ * a cancelled one is still finishing its band waits for it and reuses
+ * its result. The disk cache is bounded by evicting the least recently
+ * used pyramids after each build, skipping those still being built.
+ * tile() never waits: it returns a null pixmap until the tile is on
+ * disk and loads it into a memory-bounded LRU cache.
+ */
+class TilePyramid : public QObject
+{
+    Q_OBJECT
+public:
+    // Reported by the build after each written tile row.
+    struct Progress {
+        int level = -1;
+        int readyRows = 0;
+        QString error;
+    };
+
+    explicit TilePyramid(QObject* parent = nullptr);
+    ~TilePyramid();
+
+    void open(const QString& filePath, const QSize& sourceSize);
+    void close();
+    void build();
+
+    bool isOpen() const { return !m_filePath.isEmpty(); }
+    bool isBuilding() const { return m_watcher != nullptr; }
+    QSize sourceSize() const { return m_sourceSize; }
+    int levelCount() const { return m_levelSizes.size(); }
+    QSize levelSize(int level) const { return m_levelSizes.value(level); }
+
+    int tileRows(int level) const;
+    int tileColumns(int level) const;
+    bool isComplete() const;
+    bool isTileReady(int level, int column, int row) const;
+    bool isTileCached(int level, int column, int row) const;
+    QPixmap tile(int level, int column, int row);
+
+    // Level 0 tiles on disk, for readers off the GUI thread (full-resolution crops).
+    QString directory() const { return m_directory; }
+    bool isRegionReady(const QRect& sourceRect) const;
+    static QString tileFileName(const QString& directory, int level, int column, int row);
+
+signals:
+    void tilesAdded();
+    void buildFailed(const QString& error);
+
+private:
+    static void run(QPromise<Progress>& promise, const QString& filePath, const QString& directory,
+                    const QVector<QSize>& levelSizes);
+    static QString cacheDirectory();
+    static void enforceCacheLimit(const QString& keepDirectory);
+    QString tilePath(int level, int column, int row) const;
+
+    QString m_filePath;
+    QString m_directory;
+    QSize m_sourceSize;
+    QVector<QSize> m_levelSizes;
+    QVector<int> m_readyRows;     // tile rows of each level on disk
+
+    QCache<quint64, QPixmap> m_tiles;
+    QFutureWatcher<Progress>* m_watcher = nullptr;
+};
+
+#endif // TILEPYRAMID_H
@@ -0,0 +1,163 @@
+#include "timestretcher.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "src/common/simd.h"
+
+namespace mApp {
+const float STRETCH_PI = 3.14159265358979f;
+}
+
+static float dotProduct(const float* a, const float* b, int count)
+{
+    int i = 0;
+    float sum = 0.0f;
+#ifdef MINIMEDIA_HAVE_SSE2
+    __m128 acc = _mm_setzero_ps();
+    for (; i + 4 <= count; i += 4)
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, acc);
+    sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#endif
+    for (; i < count; ++i)
+        sum += a[i] * b[i];
+    return sum;
+}
+
+// dst[i] += src[i] * gain[i]
+static void multiplyAdd(float* dst, const float* src, const float* gain, int count)
+{
+    int i = 0;
+#ifdef MINIMEDIA_HAVE_SSE2
+    for (; i + 4 <= count; i += 4) {
+        const __m128 v = _mm_mul_ps(_mm_loadu_ps(src + i), _mm_loadu_ps(gain + i));
+        _mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(dst + i), v));
+    }
+#endif
+    for (; i < count; ++i)
+        dst[i] += src[i] * gain[i];
+}
+
+TimeStretcher::TimeStretcher(int channelCount)
+    : m_channels(std::max(1, channelCount))
+{
+    const int n = mApp::STRETCH_FRAME_SIZE;
+
+    // Window expanded per channel so overlap-add runs on interleaved data directly.
+    m_window.resize(n * m_channels);
+    for (int i = 0; i < n; ++i) {
+        const float w = 0.5f * (1.0f - std::cos(2.0f * mApp::STRETCH_PI * i / n));
+        for (int c = 0; c < m_channels; ++c)
+            m_window[i * m_channels + c] = w;
+    }
+
+    m_templateMono.resize(n / 2);
+    m_candidateMono.resize(n / 2);
+    reset();
+}
+
+void TimeStretcher::setRate(double rate)
+{
+    m_rate = std::clamp(rate, mApp::STRETCH_MIN_RATE, mApp::STRETCH_MAX_RATE);
+}
+
+void TimeStretcher::reset()
+{
+    m_input.clear();
+    m_inputBase = 0;
+    m_analysisPos = 0.0;
+    m_previousPos = -1;
+    m_overlap.fill(0.0f, mApp::STRETCH_FRAME_SIZE * m_channels);
+}
+
+void TimeStretcher::mixDown(int frame, int count, float* out) const
+{
+    const float* in = m_input.constData() + qint64(frame - m_inputBase) * m_channels;
+    for (int i = 0; i < count; ++i) {
+        float acc = 0.0f;
+        for (int c = 0; c < m_channels; ++c)
+            acc += in[i * m_channels + c];
+        out[i] = acc;
+    }
+}
+
+int TimeStretcher::bestOffset(int nominal) const
+{
+    if (m_previousPos < 0)
+        return 0;
+
+    // Template: what naturally followed the previous frame, over the overlap region.
+    const int overlap = mApp::STRETCH_FRAME_SIZE / 2;
+    const int radius = mApp::STRETCH_SEARCH_RADIUS;
+    float* tmpl = m_templateMono.data();
+    mixDown(int(m_previousPos) + synthesisHop(), overlap, tmpl);
+
+    const int lowest = std::max(-radius, int(m_inputBase) - nominal);
+    int best = 0;
+    float bestScore = -1e30f;
+
+    // Candidates are mixed once and slid over with a stride of two frames.
+    QVector<float>& candidates = m_candidateMono;
+    candidates.resize(overlap + 2 * radius + 1);
+    mixDown(nominal + lowest, overlap + (radius - lowest) + 1, candidates.data());
+
+    for (int k = lowest; k <= radius; k += 2) {
+        const float* cand = candidates.constData() + (k - lowest);
+        const float score = dotProduct(tmpl, cand, overlap);
+        if (score > bestScore) {
+            bestScore = score;
+            best = k;
+        }
+    }
+    return best;
+}
+
+int TimeStretcher::process(const float *input, int frameCount, QVector<float> *output)
+{
+    m_input.append(input, frameCount * m_channels);
+
+    const int n = mApp::STRETCH_FRAME_SIZE;
+    const int hop = synthesisHop();
+    const int radius = mApp::STRETCH_SEARCH_RADIUS;
+    const qint64 available = m_inputBase + m_input.size() / m_channels;
+
+    int produced = 0;
+    while (true) {
+        const int nominal = int(std::llround(m_analysisPos));
+        // The template needs previous + hop + overlap, the search nominal + radius + n.
+        if (nominal + radius + n > available
+            || (m_previousPos >= 0 && m_previousPos + hop + n / 2 > available))
+            break;
+
+        const int offset = bestOffset(nominal);
+        const qint64 start = nominal + offset;
+
+        multiplyAdd(m_overlap.data(),
+                    m_input.constData() + (start - m_inputBase) * m_channels,
+                    m_window.constData(), n * m_channels);
+
+        // The first hop of the accumulator is complete.
+        output->append(m_overlap.constData(), hop * m_channels);
+        std::memmove(m_overlap.data(), m_overlap.constData() + hop * m_channels,
+                     (n - hop) * m_channels * sizeof(float));
+        std::fill(m_overlap.begin() + (n - hop) * m_channels, m_overlap.end(), 0.0f);
+        produced += hop;
+
+        m_previousPos = start;
+        m_analysisPos += hop * m_rate;
+    }
+
+    // Drop input that neither the template nor the next search can reach.
+    const qint64 keepFrom = std::min<qint64>(m_previousPos >= 0 ? m_previousPos + hop : m_inputBase,
+                                             qint64(m_analysisPos) - radius);
+    const qint64 drop = std::max<qint64>(0, keepFrom - m_inputBase);
+    if (drop > 0) {
+        m_input.remove(0, int(drop * m_channels));
+        m_inputBase += drop;
+    }
+
+    return produced;
+}
@@ -0,0 +1,53 @@
+#ifndef TIMESTRETCHER_H
+#define TIMESTRETCHER_H
+
+#include <QVector>
+
+namespace mApp {
+const int STRETCH_FRAME_SIZE = 1024;     // analysis/synthesis window, frames
+const int STRETCH_SEARCH_RADIUS = 256;   // WSOLA similarity search, frames
+const double STRETCH_MIN_RATE = 0.25;
+const double STRETCH_MAX_RATE = 4.0;
+}
+
+/*
+ * WSOLA time-stretcher for interleaved float audio.
+ * Input is consumed at rate times the speed it is produced, so pitch is
+ * kept while tempo changes. Each synthesis frame is taken from the input
+ * position (within a search radius of the nominal one) that best
+ * continues the previous frame, then overlap-added with a Hann window.
+ * Correlation and overlap-add use SSE2 when available.
+ */
+class TimeStretcher
+{
+public:
+    explicit TimeStretcher(int channelCount = 2);
+
+    void setRate(double rate);
+    double rate() const { return m_rate; }
+    int channelCount() const { return m_channels; }
+
+    void reset();
+
+    // Appends stretched output to output; returns the number of output frames.
+    int process(const float* input, int frameCount, QVector<float>* output);
+
+private:
+    int synthesisHop() const { return mApp::STRETCH_FRAME_SIZE / 2; }
+    int bestOffset(int nominal) const;
+    void mixDown(int frame, int count, float* out) const;
+
+    int m_channels = 2;
+    double m_rate = 1.0;
+
+    QVector<float> m_window;   // periodic Hann, sums to 1 at 50% overlap
+    QVector<float> m_input;    // interleaved, starts at input frame m_inputBase
+    qint64 m_inputBase = 0;
+    double m_analysisPos = 0.0;
+    qint64 m_previousPos = -1; // input frame of the last synthesis frame
+
+    QVector<float> m_overlap;  // interleaved OLA accumulator, STRETCH_FRAME_SIZE frames
+    mutable QVector<float> m_templateMono, m_candidateMono;
+};
+
+#endif // TIMESTRETCHER_H
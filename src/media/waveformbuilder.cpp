@@ -0,0 +1,126 @@
+#include "waveformbuilder.h"
+#include "keyframeindex.h"
+
+#include <QAudioBuffer>
+#include <QAudioDecoder>
+#include <QAudioFormat>
+#include <QDebug>
+#include <QUrl>
+
+WaveformBuilder::WaveformBuilder(QObject* parent)
+    : QObject(parent)
+{
+}
+
+void WaveformBuilder::ensureDecoder()
+{
+    if (m_decoder)
+        return;
+
+    // Created here so the decoder belongs to the worker thread.
+    // No output format is set: a format without rate and channels is invalid, and the
+    // backends deliver the stream's own format anyway. handleBuffer() converts to float.
+    m_decoder = new QAudioDecoder(this);
+
+    connect(m_decoder, &QAudioDecoder::bufferReady, this, &WaveformBuilder::handleBuffer);
+    connect(m_decoder, &QAudioDecoder::finished, this, &WaveformBuilder::handleFinished);
+    connect(m_decoder, QOverload<QAudioDecoder::Error>::of(&QAudioDecoder::error), this, [this](QAudioDecoder::Error error) {
+        qWarning() << Q_FUNC_INFO << "Waveform decoding failed:" << error << m_decoder->errorString();
+        handleFinished();
+    });
+}
+
+void WaveformBuilder::build(const QString &filePath, int generation, const QString &cacheDir)
+{
+    stop();
+    m_generation = generation;
+    m_buildClock.start();
+
+    const QString hash = KeyframeIndex::contentHash(filePath);
+    m_cachePath = hash.isEmpty() ? QString() : cacheDir + "/" + hash + ".peaks";
+
+    WaveformData cached;
+    if (!m_cachePath.isEmpty() && WaveformData::load(m_cachePath, &cached)) {
+        qDebug() << Q_FUNC_INFO << "Loaded cached waveform in" << m_buildClock.elapsed() << "ms";
+        emit finished(generation, cached);
+        return;
+    }
+
+    ensureDecoder();
+    m_data = WaveformData();
+    m_progressClock.start();
+    m_decoder->setSource(QUrl::fromLocalFile(filePath));
+    m_decoder->start();
+}
+
+void WaveformBuilder::stop()
+{
+    if (m_decoder && m_decoder->isDecoding())
+        m_decoder->stop();
+    m_data = WaveformData();
+}
+
+void WaveformBuilder::handleBuffer()
+{
+    const QAudioBuffer buffer = m_decoder->read();
+    if (!buffer.isValid())
+        return;
+
+    const QAudioFormat format = buffer.format();
+    const int sampleCount = static_cast<int>(buffer.sampleCount());
+    const float* samples = nullptr;
+    switch (format.sampleFormat()) {
+    case QAudioFormat::Float:
+        samples = buffer.constData<float>();
+        break;
+    case QAudioFormat::Int16:
+        samples = toFloat(buffer.constData<qint16>(), sampleCount, 1.0f / 32768.0f, 0.0f);
+        break;
+    case QAudioFormat::Int32:
+        samples = toFloat(buffer.constData<qint32>(), sampleCount, 1.0f / 2147483648.0f, 0.0f);
+        break;
+    case QAudioFormat::UInt8:
+        samples = toFloat(buffer.constData<quint8>(), sampleCount, 1.0f / 128.0f, -1.0f);
+        break;
+    default:
+        qWarning() << Q_FUNC_INFO << "Unsupported sample format" << format.sampleFormat();
+        m_decoder->stop();
+        return;
+    }
+
+    if (m_data.sampleRate() == 0)
+        m_data = WaveformData(format.sampleRate());
+
+    m_data.appendSamples(samples, static_cast<int>(buffer.frameCount()), format.channelCount());
+
+    if (m_progressClock.elapsed() >= mApp::WAVEFORM_PROGRESS_INTERVAL_MS) {
+        m_progressClock.restart();
+        emit progress(m_generation, m_data);
+    }
+}
+
+template <typename Sample>
+const float* WaveformBuilder::toFloat(const Sample* samples, int count, float scale, float offset)
+{
+    m_floatScratch.resize(count);
+    float* out = m_floatScratch.data();
+    for (int i = 0; i < count; ++i)
+        out[i] = float(samples[i]) * scale + offset;
+    return out;
+}
+
+void WaveformBuilder::handleFinished()
+{
+    if (m_data.sampleRate() == 0)
+        return;
+
+    m_data.finish();
+    if (!m_cachePath.isEmpty())
+        m_data.save(m_cachePath);
+
+    qDebug() << Q_FUNC_INFO << "Built waveform of" << m_data.durationMs() << "ms audio in"
+             << m_buildClock.elapsed() << "ms";
+
+    emit finished(m_generation, m_data);
+    m_data = WaveformData();
+}
@@ -0,0 +1,53 @@
+#ifndef WAVEFORMBUILDER_H
+#define WAVEFORMBUILDER_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QString>
+#include <QVector>
+
+#include "waveformdata.h"
+
+class QAudioDecoder;
+
+namespace mApp {
+const int WAVEFORM_PROGRESS_INTERVAL_MS = 100;
+}
+
+/*
+ * Lives on a worker thread: decodes a file with QAudioDecoder and feeds
+ * the samples, converted to float, into WaveformData. Partial peaks are published at a fixed
+ * interval so the overview can be drawn while decoding runs; the result
+ * is cached under the file's content hash.
+ */
+class WaveformBuilder : public QObject
+{
+    Q_OBJECT
+public:
+    explicit WaveformBuilder(QObject* parent = nullptr);
+
+    void build(const QString& filePath, int generation, const QString& cacheDir);
+    void stop();
+
+signals:
+    void progress(int generation, const WaveformData& partial);
+    void finished(int generation, const WaveformData& data);
+
+private:
+    void ensureDecoder();
+    void handleBuffer();
+    void handleFinished();
+    // Integer PCM to float in [-1, 1), in m_floatScratch.
+    template <typename Sample>
+    const float* toFloat(const Sample* samples, int count, float scale, float offset);
+
+    QAudioDecoder* m_decoder = nullptr;
+    WaveformData m_data;
+    QVector<float> m_floatScratch;
+    QString m_cachePath;
+    int m_generation = -1;
+    QElapsedTimer m_progressClock;
+    QElapsedTimer m_buildClock;
+};
+
+#endif // WAVEFORMBUILDER_H
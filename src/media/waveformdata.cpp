@@ -0,0 +1,248 @@
+#include "waveformdata.h"
+
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+
+#include <algorithm>
+#include <cmath>
+
+#include "src/common/simd.h"
+
+namespace mApp {
+const quint32 WAVEFORM_CACHE_MAGIC = 0x4D4D5746; // "MMWF"
+const quint32 WAVEFORM_CACHE_VERSION = 1;
+}
+
+WaveformData::WaveformData(int sampleRate)
+    : m_sampleRate(sampleRate)
+{
+    m_levels.resize(1);
+    m_levels[0].samplesPerPeak = mApp::WAVEFORM_SAMPLES_PER_PEAK;
+}
+
+qint64 WaveformData::durationMs() const
+{
+    if (isEmpty() || m_sampleRate <= 0)
+        return 0;
+    const Level& base = m_levels.first();
+    return qint64(base.size()) * base.samplesPerPeak * 1000 / m_sampleRate;
+}
+
+const WaveformData::Level &WaveformData::levelFor(int peaksWanted) const
+{
+    for (int i = m_levels.size() - 1; i > 0; --i) {
+        if (m_levels.at(i).size() >= peaksWanted)
+            return m_levels.at(i);
+    }
+    return m_levels.first();
+}
+
+void WaveformData::blockPeak(const float *samples, int count, float *minOut, float *maxOut, float *sumSquaresOut)
+{
+    int i = 0;
+    float mn = samples[0], mx = samples[0], sum = 0.0f;
+
+#ifdef MINIMEDIA_HAVE_SSE2
+    if (count >= 4) {
+        __m128 vmin = _mm_loadu_ps(samples);
+        __m128 vmax = vmin;
+        __m128 vsum = _mm_setzero_ps();
+        for (; i + 4 <= count; i += 4) {
+            const __m128 v = _mm_loadu_ps(samples + i);
+            vmin = _mm_min_ps(vmin, v);
+            vmax = _mm_max_ps(vmax, v);
+            vsum = _mm_add_ps(vsum, _mm_mul_ps(v, v));
+        }
+        alignas(16) float lanes[3][4];
+        _mm_store_ps(lanes[0], vmin);
+        _mm_store_ps(lanes[1], vmax);
+        _mm_store_ps(lanes[2], vsum);
+        mn = std::min(std::min(lanes[0][0], lanes[0][1]), std::min(lanes[0][2], lanes[0][3]));
+        mx = std::max(std::max(lanes[1][0], lanes[1][1]), std::max(lanes[1][2], lanes[1][3]));
+        sum = (lanes[2][0] + lanes[2][1]) + (lanes[2][2] + lanes[2][3]);
+    }
+#endif
+
+    for (; i < count; ++i) {
+        const float v = samples[i];
+        mn = std::min(mn, v);
+        mx = std::max(mx, v);
+        sum += v * v;
+    }
+
+    *minOut = mn;
+    *maxOut = mx;
+    *sumSquaresOut = sum;
+}
+
+void WaveformData::appendSamples(const float *interleaved, int frameCount, int channelCount)
+{
+    if (frameCount <= 0 || channelCount <= 0 || m_levels.isEmpty())
+        return;
+
+    // Mix down to mono. Stereo, the common case, averages four frames per step.
+    const float* mono = interleaved;
+    if (channelCount == 2) {
+        m_monoScratch.resize(frameCount);
+        float* out = m_monoScratch.data();
+        int f = 0;
+#ifdef MINIMEDIA_HAVE_SSE2
+        const __m128 half = _mm_set1_ps(0.5f);
+        for (; f + 4 <= frameCount; f += 4) {
+            const __m128 a = _mm_loadu_ps(interleaved + 2 * f);       // L0 R0 L1 R1
+            const __m128 b = _mm_loadu_ps(interleaved + 2 * f + 4);   // L2 R2 L3 R3
+            const __m128 left = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+            const __m128 right = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+            _mm_storeu_ps(out + f, _mm_mul_ps(_mm_add_ps(left, right), half));
+        }
+#endif
+        for (; f < frameCount; ++f)
+            out[f] = (interleaved[2 * f] + interleaved[2 * f + 1]) * 0.5f;
+        mono = out;
+    } else if (channelCount > 2) {
+        m_monoScratch.resize(frameCount);
+        float* out = m_monoScratch.data();
+        const float scale = 1.0f / channelCount;
+        for (int f = 0; f < frameCount; ++f) {
+            float acc = 0.0f;
+            for (int c = 0; c < channelCount; ++c)
+                acc += interleaved[f * channelCount + c];
+            out[f] = acc * scale;
+        }
+        mono = out;
+    }
+
+    const int bucketSize = mApp::WAVEFORM_SAMPLES_PER_PEAK;
+    int pos = 0;
+
+    // Complete a bucket left over from the previous buffer.
+    if (m_bucketCount > 0) {
+        const int take = std::min(bucketSize - m_bucketCount, frameCount);
+        float mn, mx, sumSquares;
+        blockPeak(mono, take, &mn, &mx, &sumSquares);
+        m_bucketMin = std::min(m_bucketMin, mn);
+        m_bucketMax = std::max(m_bucketMax, mx);
+        m_bucketSumSquares += sumSquares;
+        m_bucketCount += take;
+        pos = take;
+        if (m_bucketCount == bucketSize)
+            flushBucket();
+    }
+
+    Level& base = m_levels[0];
+    const int fullBuckets = (frameCount - pos) / bucketSize;
+    base.min.reserve(base.min.size() + fullBuckets);
+    base.max.reserve(base.max.size() + fullBuckets);
+    base.rms.reserve(base.rms.size() + fullBuckets);
+
+    for (int b = 0; b < fullBuckets; ++b, pos += bucketSize) {
+        float mn, mx, sumSquares;
+        blockPeak(mono + pos, bucketSize, &mn, &mx, &sumSquares);
+        base.min.append(mn);
+        base.max.append(mx);
+        base.rms.append(std::sqrt(sumSquares / bucketSize));
+    }
+
+    if (pos < frameCount) {
+        float sumSquares;
+        blockPeak(mono + pos, frameCount - pos, &m_bucketMin, &m_bucketMax, &sumSquares);
+        m_bucketSumSquares = sumSquares;
+        m_bucketCount = frameCount - pos;
+    }
+}
+
+void WaveformData::flushBucket()
+{
+    if (m_bucketCount == 0)
+        return;
+
+    Level& base = m_levels[0];
+    base.min.append(m_bucketMin);
+    base.max.append(m_bucketMax);
+    base.rms.append(float(std::sqrt(m_bucketSumSquares / m_bucketCount)));
+    m_bucketCount = 0;
+    m_bucketSumSquares = 0.0;
+}
+
+void WaveformData::finish()
+{
+    flushBucket();
+    m_monoScratch = QVector<float>();
+    buildLevels();
+}
+
+void WaveformData::buildLevels()
+{
+    if (m_levels.isEmpty())
+        return;
+    m_levels.resize(1);
+
+    while (m_levels.last().size() / 2 >= mApp::WAVEFORM_MIN_LEVEL_PEAKS) {
+        const Level& fine = m_levels.last();
+        Level coarse;
+        coarse.samplesPerPeak = fine.samplesPerPeak * 2;
+
+        const int n = fine.size() / 2;
+        coarse.min.resize(n);
+        coarse.max.resize(n);
+        coarse.rms.resize(n);
+        for (int i = 0; i < n; ++i) {
+            coarse.min[i] = std::min(fine.min[2 * i], fine.min[2 * i + 1]);
+            coarse.max[i] = std::max(fine.max[2 * i], fine.max[2 * i + 1]);
+            const float a = fine.rms[2 * i], b = fine.rms[2 * i + 1];
+            coarse.rms[i] = std::sqrt((a * a + b * b) * 0.5f);
+        }
+        m_levels.append(coarse);
+    }
+}
+
+bool WaveformData::save(const QString &filePath) const
+{
+    if (isEmpty())
+        return false;
+
+    QDir().mkpath(QFileInfo(filePath).absolutePath());
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+
+    // Only the finest level is stored; the others are rebuilt on load.
+    const Level& base = m_levels.first();
+    QDataStream out(&file);
+    out.setFloatingPointPrecision(QDataStream::SinglePrecision);
+    out << mApp::WAVEFORM_CACHE_MAGIC << mApp::WAVEFORM_CACHE_VERSION
+        << qint32(m_sampleRate) << qint32(base.samplesPerPeak)
+        << base.min << base.max << base.rms;
+
+    return out.status() == QDataStream::Ok && file.commit();
+}
+
+bool WaveformData::load(const QString &filePath, WaveformData *data)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream in(&file);
+    in.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+    quint32 magic = 0, version = 0;
+    qint32 sampleRate = 0, samplesPerPeak = 0;
+    in >> magic >> version >> sampleRate >> samplesPerPeak;
+    if (magic != mApp::WAVEFORM_CACHE_MAGIC || version != mApp::WAVEFORM_CACHE_VERSION
+        || samplesPerPeak != mApp::WAVEFORM_SAMPLES_PER_PEAK)
+        return false;
+
+    WaveformData loaded(sampleRate);
+    Level& base = loaded.m_levels[0];
+    in >> base.min >> base.max >> base.rms;
+    if (in.status() != QDataStream::Ok || base.min.size() != base.max.size() || base.min.size() != base.rms.size())
+        return false;
+
+    loaded.buildLevels();
+    *data = loaded;
+    return true;
+}
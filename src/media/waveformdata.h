@@ -0,0 +1,66 @@
+#ifndef WAVEFORMDATA_H
+#define WAVEFORMDATA_H
+
+#include <QString>
+#include <QVector>
+
+namespace mApp {
+const int WAVEFORM_SAMPLES_PER_PEAK = 256;  // resolution of the finest level
+const int WAVEFORM_MIN_LEVEL_PEAKS = 512;   // stop halving below this many peaks
+}
+
+/*
+ * Multi-resolution min/max/RMS peaks of a mono mix of an audio stream.
+ * Level 0 holds one peak per WAVEFORM_SAMPLES_PER_PEAK samples, every
+ * following level halves the resolution.
+ */
+class WaveformData
+{
+public:
+    struct Level {
+        int samplesPerPeak = 0;
+        QVector<float> min;
+        QVector<float> max;
+        QVector<float> rms;
+
+        int size() const { return min.size(); }
+    };
+
+    WaveformData() = default;
+    explicit WaveformData(int sampleRate);
+
+    bool isEmpty() const { return m_levels.isEmpty() || m_levels.first().size() == 0; }
+    int sampleRate() const { return m_sampleRate; }
+    qint64 durationMs() const;
+
+    int levelCount() const { return m_levels.size(); }
+    const Level& level(int index) const { return m_levels.at(index); }
+    // Coarsest level that still has at least peaksWanted peaks.
+    const Level& levelFor(int peaksWanted) const;
+
+    // Feeds interleaved float samples; channels are mixed down on the fly.
+    void appendSamples(const float* interleaved, int frameCount, int channelCount);
+    void finish();
+
+    bool save(const QString& filePath) const;
+    static bool load(const QString& filePath, WaveformData* data);
+
+    // Vectorized reduction of one block of mono samples.
+    static void blockPeak(const float* samples, int count, float* minOut, float* maxOut, float* sumSquaresOut);
+
+private:
+    void flushBucket();
+    void buildLevels();
+
+    int m_sampleRate = 0;
+    QVector<Level> m_levels;
+
+    // Partial bucket carried over between decoder buffers.
+    float m_bucketMin = 0.0f;
+    float m_bucketMax = 0.0f;
+    double m_bucketSumSquares = 0.0;
+    int m_bucketCount = 0;
+    QVector<float> m_monoScratch;
+};
+
+#endif // WAVEFORMDATA_H
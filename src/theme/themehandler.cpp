@@ -17,10 +17,15 @@ ThemeHandler::ThemeHandler(MainWindow* mainWindow, QObject* parent)
     mainUi = m_mainWindow->getMainUi();
 
     setupUiComponents();
-    readAllThemeStyleSheets();
+    listThemes();
     setupConnections();
 
-    m_themeComboBox->setCurrentText("WINDOWSVISTA");
+    // The platform already starts with its default style; only show it as selected
+    // instead of re-polishing every widget with the same style during startup.
+    const QString defaultTheme = "WINDOWSVISTA";
+    const bool alreadyApplied = QApplication::style()->name().compare(defaultTheme, Qt::CaseInsensitive) == 0;
+    const QSignalBlocker blocker(alreadyApplied ? m_themeComboBox : nullptr);
+    m_themeComboBox->setCurrentText(defaultTheme);
 }
 
 void ThemeHandler::setupUiComponents()
@@ -52,27 +57,18 @@ void ThemeHandler::setupUiComponents()
     hLayoutTheme->setContentsMargins(0, 0, 10, 10);
 }
 
-void ThemeHandler::readAllThemeStyleSheets()
+void ThemeHandler::listThemes()
 {
     // Directory containing the QSS files
     const QString qssDirectory = ":/resource/qss/";
     QDir dir(qssDirectory);
 
-    // Retrieve QSS files
+    // Only the names are needed to fill the combo box
     QStringList qssFiles = dir.entryList({"*.qss"}, QDir::Files);
 
     for (const QString& fileName : qssFiles) {
-        QString filePath = qssDirectory + fileName;
-        QFile qssFile(filePath);
-
-        if (qssFile.open(QFile::ReadOnly)) {
-            QString qssContent = QLatin1String(qssFile.readAll());
-            QString themeName = fileName.split('.').first().toUpper();
-            m_themesQSS.insert(themeName, qssContent);
-            qssFile.close();
-        } else {
-            qDebug() << "Failed to open QSS file:" << filePath;
-        }
+        QString themeName = fileName.split('.').first().toUpper();
+        m_themeFiles.insert(themeName, qssDirectory + fileName);
     }
 
     // built-in themes
@@ -81,10 +77,27 @@ void ThemeHandler::readAllThemeStyleSheets()
         m_themePC.insert(key.toUpper(), key);
 }
 
+QString ThemeHandler::loadStyleSheet(const QString& themeName)
+{
+    auto cached = m_themesQSS.constFind(themeName);
+    if (cached != m_themesQSS.constEnd())
+        return cached.value();
+
+    const QString filePath = m_themeFiles.value(themeName);
+    QFile qssFile(filePath);
+    if (!qssFile.open(QFile::ReadOnly)) {
+        qDebug() << "Failed to open QSS file:" << filePath;
+        return QString();
+    }
+
+    QString qssContent = QLatin1String(qssFile.readAll());
+    m_themesQSS.insert(themeName, qssContent);
+    return qssContent;
+}
 
 void ThemeHandler::setupConnections()
 {
-    QStringList sortedThemes = m_themesQSS.keys() + m_themePC.keys();
+    QStringList sortedThemes = m_themeFiles.keys() + m_themePC.keys();
     sortedThemes.sort();
 
     m_themeComboBox->addItems(sortedThemes);  // Add both default and custom themes
@@ -104,8 +117,10 @@ void ThemeHandler::setAppTheme(const QString& themeName)
             qDebug() << "Failed to apply Qt style for:" << themeName;
         }
     } // Handle custom QSS themes
-    else if (m_themesQSS.contains(themeName)) {
-        QString themeStyleSheet = m_themesQSS.value(themeName);
+    else if (m_themeFiles.contains(themeName)) {
+        QString themeStyleSheet = loadStyleSheet(themeName);
+        if (themeStyleSheet.isEmpty())
+            return;
         qApp->setStyleSheet(themeStyleSheet); // Apply custom QSS theme
         qDebug() << "Applied custom theme:" << themeName;
     }
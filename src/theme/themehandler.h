@@ -26,7 +26,8 @@ signals:
 private:
     void setupUiComponents();
     void setupConnections();
-    void readAllThemeStyleSheets();
+    void listThemes();
+    QString loadStyleSheet(const QString& themeName);
     void setAppTheme(const QString& themeName);
 
     MainWindow* m_mainWindow = nullptr;
@@ -34,7 +35,8 @@ private:
     QComboBox* m_themeComboBox = nullptr;
     QLabel *m_labelHelpText = nullptr;
     QHBoxLayout* hLayoutTheme = nullptr;
-    QMap<QString, QString> m_themesQSS, m_themePC;
+    // theme name -> QSS resource path; contents are read on first selection
+    QMap<QString, QString> m_themeFiles, m_themesQSS, m_themePC;
 };
 
 #endif // THEMEHANDLER_H
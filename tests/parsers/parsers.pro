@@ -0,0 +1,25 @@
+# Fixture tests for the binary parsers: MP4/Matroska keyframe tables and EXIF.
+# Build and run with:
+#   qmake parsers.pro && make
+#   ./tst_parsers
+
+QT       += core gui testlib
+
+CONFIG += c++17 console testcase
+CONFIG -= app_bundle
+
+TARGET = tst_parsers
+
+# Sources are shared with the application and included as "src/...".
+INCLUDEPATH += ../..
+
+HEADERS += \
+    ../../src/common/fileheader.h \
+    ../../src/media/exifreader.h \
+    ../../src/media/keyframeindex.h
+
+SOURCES += \
+    ../../src/common/fileheader.cpp \
+    ../../src/media/exifreader.cpp \
+    ../../src/media/keyframeindex.cpp \
+    tst_parsers.cpp
@@ -0,0 +1,237 @@
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTest>
+#include <QtEndian>
+
+#include "src/media/exifreader.h"
+#include "src/media/keyframeindex.h"
+
+namespace {
+
+QByteArray be16(quint16 value)
+{
+    QByteArray bytes(2, '\0');
+    qToBigEndian(value, bytes.data());
+    return bytes;
+}
+
+QByteArray be32(quint32 value)
+{
+    QByteArray bytes(4, '\0');
+    qToBigEndian(value, bytes.data());
+    return bytes;
+}
+
+QByteArray box(const char* type, const QByteArray& payload)
+{
+    return be32(quint32(8 + payload.size())) + QByteArray(type, 4) + payload;
+}
+
+// Version and flags, then the payload.
+QByteArray fullBox(const char* type, quint8 version, const QByteArray& payload)
+{
+    return box(type, QByteArray(1, char(version)) + QByteArray(3, '\0') + payload);
+}
+
+/*
+ * One video track at 12800 ticks/s: 30 samples of 512 ticks (25 fps),
+ * keyframes at samples 1, 11 and 21, every sample shown 1024 ticks
+ * (80 ms) after it is decoded. With an edit list, the first 1024 media
+ * ticks are skipped, which cancels the composition offset.
+ */
+QByteArray mp4File(bool withEditList)
+{
+    const QByteArray mvhd = fullBox("mvhd", 0, be32(0) + be32(0) + be32(1000) + be32(1200) + QByteArray(80, '\0'));
+    const QByteArray mdhd = fullBox("mdhd", 0, be32(0) + be32(0) + be32(12800) + be32(15360) + be32(0));
+    const QByteArray hdlr = fullBox("hdlr", 0, be32(0) + QByteArray("vide") + QByteArray(12, '\0') + QByteArray(1, '\0'));
+    const QByteArray stts = fullBox("stts", 0, be32(1) + be32(30) + be32(512));
+    const QByteArray stss = fullBox("stss", 0, be32(3) + be32(1) + be32(11) + be32(21));
+    const QByteArray ctts = fullBox("ctts", 0, be32(1) + be32(30) + be32(1024));
+    const QByteArray stbl = box("stbl", stts + stss + ctts);
+    const QByteArray mdia = box("mdia", mdhd + hdlr + box("minf", stbl));
+    const QByteArray edts = box("edts", fullBox("elst", 0, be32(1) + be32(1200) + be32(1024) + be32(0x00010000)));
+    const QByteArray trak = box("trak", (withEditList ? edts : QByteArray()) + mdia);
+    return box("ftyp", QByteArray("isom") + be32(0)) + box("moov", mvhd + trak) + box("mdat", QByteArray(16, '\0'));
+}
+
+QByteArray ebml(const QByteArray& id, const QByteArray& payload)
+{
+    Q_ASSERT(payload.size() < 127);
+    return id + QByteArray(1, char(0x80 | payload.size())) + payload;
+}
+
+// Matroska with a millisecond timecode scale and cues at 0 and 2000 ms.
+QByteArray matroskaFile()
+{
+    const QByteArray info = ebml(QByteArray::fromHex("1549A966"), ebml(QByteArray::fromHex("2AD7B1"), QByteArray::fromHex("0F4240")));
+    const QByteArray cue0 = ebml(QByteArray::fromHex("BB"), ebml(QByteArray::fromHex("B3"), QByteArray::fromHex("00")));
+    const QByteArray cue1 = ebml(QByteArray::fromHex("BB"), ebml(QByteArray::fromHex("B3"), QByteArray::fromHex("07D0")));
+    const QByteArray cues = ebml(QByteArray::fromHex("1C53BB6B"), cue0 + cue1);
+    return ebml(QByteArray::fromHex("1A45DFA3"), QByteArray()) + ebml(QByteArray::fromHex("18538067"), info + cues);
+}
+
+// A JPEG whose big-endian EXIF has Make "Cam" and the given orientation.
+QByteArray exifJpeg(quint16 orientation)
+{
+    QByteArray tiff = QByteArray("MM") + be16(42) + be32(8);
+    tiff += be16(2);
+    tiff += be16(0x010F) + be16(2) + be32(4) + QByteArray("Cam", 4);
+    tiff += be16(0x0112) + be16(3) + be32(1) + be16(orientation) + be16(0);
+    tiff += be32(0);
+    const QByteArray app1 = QByteArray("Exif\0\0", 6) + tiff;
+    return QByteArray::fromHex("FFD8FFE1") + be16(quint16(app1.size() + 2)) + app1 + QByteArray::fromHex("FFD9");
+}
+
+} // namespace
+
+class TestParsers : public QObject
+{
+    Q_OBJECT
+private slots:
+    void init();
+
+    void mp4PresentationTimes_data();
+    void mp4PresentationTimes();
+    void mp4TruncatedHeader();
+    void matroskaCues();
+    void keyframeLookups();
+
+    void exifOrientation();
+    void exifDamaged();
+    void exifTransformMatchesOriented();
+    void exifStoredRect();
+
+private:
+    QString writeFixture(const QString& name, const QByteArray& data);
+
+    QTemporaryDir m_dir;
+};
+
+void TestParsers::init()
+{
+    QVERIFY(m_dir.isValid());
+}
+
+QString TestParsers::writeFixture(const QString &name, const QByteArray &data)
+{
+    const QString path = m_dir.filePath(name);
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size())
+        return QString();
+    return path;
+}
+
+void TestParsers::mp4PresentationTimes_data()
+{
+    QTest::addColumn<bool>("withEditList");
+    QTest::addColumn<QVector<qint64>>("expected");
+
+    QTest::newRow("composition offset") << false << QVector<qint64>{80, 480, 880};
+    QTest::newRow("edit list") << true << QVector<qint64>{0, 400, 800};
+}
+
+void TestParsers::mp4PresentationTimes()
+{
+    QFETCH(bool, withEditList);
+    QFETCH(QVector<qint64>, expected);
+
+    const QString path = writeFixture("track.mp4", mp4File(withEditList));
+    QVERIFY(!path.isEmpty());
+    QCOMPARE(KeyframeIndex::scan(path).timestamps(), expected);
+}
+
+void TestParsers::mp4TruncatedHeader()
+{
+    // An mdhd without payload must be rejected before its version byte is read.
+    QByteArray data = mp4File(false);
+    const int mdhd = data.indexOf("mdhd") - 4;
+    data.replace(mdhd, 32, box("mdhd", QByteArray()));
+    const int shrink = 32 - 8;
+    for (const char* parent : {"moov", "trak", "mdia"}) {
+        const int at = data.indexOf(parent) - 4;
+        data.replace(at, 4, be32(qFromBigEndian<quint32>(data.constData() + at) - shrink));
+    }
+
+    const QString path = writeFixture("truncated.mp4", data);
+    QVERIFY(!path.isEmpty());
+    QVERIFY(KeyframeIndex::scan(path).isEmpty());
+}
+
+void TestParsers::matroskaCues()
+{
+    const QString path = writeFixture("cues.mkv", matroskaFile());
+    QVERIFY(!path.isEmpty());
+    QCOMPARE(KeyframeIndex::scan(path).timestamps(), (QVector<qint64>{0, 2000}));
+}
+
+void TestParsers::keyframeLookups()
+{
+    const QString path = writeFixture("lookups.mp4", mp4File(false));
+    const KeyframeIndex index = KeyframeIndex::scan(path);
+    QCOMPARE(index.size(), 3);
+
+    QCOMPARE(index.keyframeAtOrBefore(50), qint64(50));   // nothing before the first keyframe
+    QCOMPARE(index.keyframeAtOrBefore(80), qint64(80));
+    QCOMPARE(index.keyframeAtOrBefore(479), qint64(80));
+    QCOMPARE(index.keyframeAtOrBefore(5000), qint64(880));
+    QCOMPARE(index.nearestKeyframe(50), qint64(80));
+    QCOMPARE(index.nearestKeyframe(700), qint64(880));
+    QCOMPARE(KeyframeIndex().keyframeAtOrBefore(123), qint64(123));
+}
+
+void TestParsers::exifOrientation()
+{
+    const QByteArray data = exifJpeg(6);
+    const ExifData exif = ExifReader::read(reinterpret_cast<const uchar*>(data.constData()), data.size());
+    QVERIFY(exif.valid);
+    QCOMPARE(exif.orientation, 6);
+    QCOMPARE(exif.make, QStringLiteral("Cam"));
+}
+
+void TestParsers::exifDamaged()
+{
+    // Out-of-range orientation, then every truncation of the file: never a crash, never a bogus value.
+    const QByteArray bad = exifJpeg(9);
+    QCOMPARE(ExifReader::read(reinterpret_cast<const uchar*>(bad.constData()), bad.size()).orientation, 1);
+
+    const QByteArray data = exifJpeg(6);
+    for (int size = 0; size < data.size(); ++size) {
+        const QByteArray head = data.left(size);
+        const ExifData exif = ExifReader::read(reinterpret_cast<const uchar*>(head.constData()), head.size());
+        QVERIFY(exif.orientation == 1 || exif.orientation == 6);
+    }
+}
+
+void TestParsers::exifTransformMatchesOriented()
+{
+    // Every stored pixel lands where oriented() puts it.
+    QImage stored(4, 3, QImage::Format_RGB32);
+    for (int y = 0; y < stored.height(); ++y)
+        for (int x = 0; x < stored.width(); ++x)
+            stored.setPixel(x, y, qRgb(x * 40, y * 60, 0));
+
+    for (int orientation = 1; orientation <= 8; ++orientation) {
+        const QImage upright = ExifReader::oriented(stored, orientation);
+        const QTransform transform = ExifReader::transform(orientation, stored.size());
+        QCOMPARE(upright.size(), ExifReader::isTransposed(orientation) ? stored.size().transposed() : stored.size());
+        for (int y = 0; y < stored.height(); ++y) {
+            for (int x = 0; x < stored.width(); ++x) {
+                const QPointF mapped = transform.map(QPointF(x + 0.5, y + 0.5));
+                QCOMPARE(upright.pixel(int(mapped.x()), int(mapped.y())), stored.pixel(x, y));
+            }
+        }
+    }
+}
+
+void TestParsers::exifStoredRect()
+{
+    // Turned 90 degrees clockwise: the upright top-left corner is stored bottom-left.
+    const QSize stored(400, 300);
+    QCOMPARE(ExifReader::storedRect(QRect(0, 0, 10, 20), 6, stored), QRect(0, 290, 20, 10));
+    QCOMPARE(ExifReader::storedRect(QRect(0, 0, 10, 20), 1, stored), QRect(0, 0, 10, 20));
+    QCOMPARE(ExifReader::storedRect(QRect(0, 0, 10, 20), 3, stored), QRect(390, 280, 10, 20));
+}
+
+QTEST_GUILESS_MAIN(TestParsers)
+
+#include "tst_parsers.moc"